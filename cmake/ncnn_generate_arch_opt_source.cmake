@@ -0,0 +1,16 @@
+
+# must define SRC DST CLASS ARCH OPT
+
+file(READ ${SRC} source_data)
+
+string(TOUPPER ${CLASS} CLASS_UPPER)
+string(TOLOWER ${CLASS} CLASS_LOWER)
+string(TOUPPER ${ARCH} ARCH_UPPER)
+string(TOUPPER ${OPT} OPT_UPPER)
+
+# rename include guard, class name and header include for this instruction set extension
+string(REGEX REPLACE "LAYER_${CLASS_UPPER}_${ARCH_UPPER}_H" "LAYER_${CLASS_UPPER}_${ARCH_UPPER}_${OPT_UPPER}_H" source_data "${source_data}")
+string(REGEX REPLACE "${CLASS}_${ARCH}([^a-zA-Z0-9])" "${CLASS}_${ARCH}_${OPT}\\1" source_data "${source_data}")
+string(REGEX REPLACE "#include \"${CLASS_LOWER}_${ARCH}.h\"" "#include \"${CLASS_LOWER}_${ARCH}_${OPT}.h\"" source_data "${source_data}")
+
+file(WRITE ${DST} "${source_data}")
@@ -15,6 +15,7 @@
 #include "allocator.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <algorithm>
 #include "gpu.h"
 #include "pipeline.h"
@@ -23,6 +24,12 @@
 #include <android/hardware_buffer.h>
 #endif // __ANDROID_API__ >= 26
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace ncnn {
 
 Allocator::~Allocator() 
@@ -30,9 +37,31 @@ Allocator::~Allocator()
 
 }
 
+int Allocator::get_statistics(AllocatorStatistics& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    return -1;
+}
+
+static inline void statistics_malloc(AllocatorStatistics& stats, size_t size, bool hit)
+{
+    stats.current_bytes += size;
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.current_bytes);
+    stats.malloc_count++;
+    if (hit)
+        stats.hit_count++;
+}
+
+static inline void statistics_free(AllocatorStatistics& stats, size_t size)
+{
+    stats.current_bytes -= size;
+    stats.free_count++;
+}
+
 PoolAllocator::PoolAllocator()
 {
     size_compare_ratio = 192;// 0.75f * 256
+    memset(&statistics, 0, sizeof(statistics));
 }
 
 PoolAllocator::~PoolAllocator()
@@ -99,6 +128,7 @@ void* PoolAllocator::fastMalloc(size_t size)
             payouts_lock.lock();
 
             payouts.push_back(std::make_pair(bs, ptr));
+            statistics_malloc(statistics, bs, true);
 
             payouts_lock.unlock();
 
@@ -114,6 +144,7 @@ void* PoolAllocator::fastMalloc(size_t size)
     payouts_lock.lock();
 
     payouts.push_back(std::make_pair(size, ptr));
+    statistics_malloc(statistics, size, false);
 
     payouts_lock.unlock();
 
@@ -133,6 +164,7 @@ void PoolAllocator::fastFree(void* ptr)
             size_t size = it->first;
 
             payouts.erase(it);
+            statistics_free(statistics, size);
 
             payouts_lock.unlock();
 
@@ -152,9 +184,28 @@ void PoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+int PoolAllocator::get_statistics(AllocatorStatistics& stats)
+{
+    payouts_lock.lock();
+    stats = statistics;
+    payouts_lock.unlock();
+
+    budgets_lock.lock();
+    stats.cached_bytes = 0;
+    std::list< std::pair<size_t, void*> >::iterator it = budgets.begin();
+    for (; it != budgets.end(); it++)
+    {
+        stats.cached_bytes += it->first;
+    }
+    budgets_lock.unlock();
+
+    return 0;
+}
+
 UnlockedPoolAllocator::UnlockedPoolAllocator()
 {
     size_compare_ratio = 192;// 0.75f * 256
+    memset(&statistics, 0, sizeof(statistics));
 }
 
 UnlockedPoolAllocator::~UnlockedPoolAllocator()
@@ -211,6 +262,7 @@ void* UnlockedPoolAllocator::fastMalloc(size_t size)
             budgets.erase(it);
 
             payouts.push_back(std::make_pair(bs, ptr));
+            statistics_malloc(statistics, bs, true);
 
             return ptr;
         }
@@ -220,6 +272,7 @@ void* UnlockedPoolAllocator::fastMalloc(size_t size)
     void* ptr = ncnn::fastMalloc(size);
 
     payouts.push_back(std::make_pair(size, ptr));
+    statistics_malloc(statistics, size, false);
 
     return ptr;
 }
@@ -235,6 +288,7 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
             size_t size = it->first;
 
             payouts.erase(it);
+            statistics_free(statistics, size);
 
             budgets.push_back(std::make_pair(size, ptr));
 
@@ -246,6 +300,819 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+int UnlockedPoolAllocator::get_statistics(AllocatorStatistics& stats)
+{
+    stats = statistics;
+
+    stats.cached_bytes = 0;
+    std::list< std::pair<size_t, void*> >::iterator it = budgets.begin();
+    for (; it != budgets.end(); it++)
+    {
+        stats.cached_bytes += it->first;
+    }
+
+    return 0;
+}
+
+// every block of SizeClassAllocator starts with this header, the user pointer follows at MALLOC_ALIGN
+struct SizeClassBlock
+{
+    union
+    {
+        // free blocks of a class
+        SizeClassBlock* next;
+        // blocks larger than the biggest class
+        size_t size;
+    };
+    // -1 for blocks larger than the biggest class
+    int size_class;
+};
+
+// 64 bytes up to 2^47 bytes, four classes per power of two
+static const int size_class_count = (47 - 6) * 4 + 1;
+
+static inline int get_size_class(size_t size)
+{
+    if (size <= 64)
+        return 0;
+
+    // 2^p < size <= 2^(p+1)
+    size_t s = size - 1;
+    int p = 6;
+    while ((s >> p) > 1)
+        p++;
+
+    int k = (int)((s - ((size_t)1 << p)) >> (p - 2));
+
+    return (p - 6) * 4 + k + 1;
+}
+
+static inline size_t get_size_class_size(int size_class)
+{
+    if (size_class == 0)
+        return 64;
+
+    int p = (size_class - 1) / 4 + 6;
+    int k = (size_class - 1) % 4;
+
+    return ((size_t)1 << p) + ((size_t)(k + 1) << (p - 2));
+}
+
+static inline void* atomic_exchange_ptr(void** addr, void* value)
+{
+#if defined _MSC_VER
+    return InterlockedExchangePointer(addr, value);
+#elif defined __GNUC__ && defined __ATOMIC_ACQ_REL
+    return __atomic_exchange_n(addr, value, __ATOMIC_ACQ_REL);
+#elif defined __GNUC__
+    return __sync_lock_test_and_set(addr, value);
+#else
+    // thread-unsafe branch
+    void* old = *addr;
+    *addr = value;
+    return old;
+#endif
+}
+
+static inline bool atomic_compare_exchange_ptr(void** addr, void* expected, void* value)
+{
+#if defined _MSC_VER
+    return InterlockedCompareExchangePointer(addr, value, expected) == expected;
+#elif defined __GNUC__
+    return __sync_bool_compare_and_swap(addr, expected, value);
+#else
+    // thread-unsafe branch
+    if (*addr != expected)
+        return false;
+    *addr = value;
+    return true;
+#endif
+}
+
+static inline void* atomic_load_ptr(void** addr)
+{
+#if defined __GNUC__ && defined __ATOMIC_ACQUIRE
+    return __atomic_load_n(addr, __ATOMIC_ACQUIRE);
+#else
+    return *(void* volatile*)addr;
+#endif
+}
+
+// a counter with a single writer read from other threads, no ordering is needed
+template<typename T>
+static inline T atomic_load_relaxed(const T* addr)
+{
+#if defined __GNUC__ && defined __ATOMIC_RELAXED
+    return __atomic_load_n(addr, __ATOMIC_RELAXED);
+#else
+    return *(const volatile T*)addr;
+#endif
+}
+
+template<typename T>
+static inline void atomic_store_relaxed(T* addr, T value)
+{
+#if defined __GNUC__ && defined __ATOMIC_RELAXED
+    __atomic_store_n(addr, value, __ATOMIC_RELAXED);
+#else
+    *(volatile T*)addr = value;
+#endif
+}
+
+static inline size_t atomic_fetch_add_size(size_t* addr, size_t delta)
+{
+#if defined _MSC_VER && defined _WIN64
+    return (size_t)InterlockedExchangeAdd64((LONGLONG volatile*)addr, (LONGLONG)delta);
+#elif defined _MSC_VER
+    return (size_t)InterlockedExchangeAdd((LONG volatile*)addr, (LONG)delta);
+#elif defined __GNUC__
+    return __sync_fetch_and_add(addr, delta);
+#else
+    // thread-unsafe branch
+    size_t old = *addr;
+    *addr += delta;
+    return old;
+#endif
+}
+
+static inline bool atomic_compare_exchange_size(size_t* addr, size_t expected, size_t value)
+{
+#if defined _MSC_VER && defined _WIN64
+    return (size_t)InterlockedCompareExchange64((LONGLONG volatile*)addr, (LONGLONG)value, (LONGLONG)expected) == expected;
+#elif defined _MSC_VER
+    return (size_t)InterlockedCompareExchange((LONG volatile*)addr, (LONG)value, (LONG)expected) == expected;
+#elif defined __GNUC__
+    return __sync_bool_compare_and_swap(addr, expected, value);
+#else
+    // thread-unsafe branch
+    if (*addr != expected)
+        return false;
+    *addr = value;
+    return true;
+#endif
+}
+
+// the free blocks one thread keeps for itself
+class SizeClassAllocatorCache
+{
+public:
+    SizeClassAllocatorCache(SizeClassAllocator* _allocator)
+        : allocator(_allocator), heads(size_class_count, (SizeClassBlock*)0), tails(size_class_count, (SizeClassBlock*)0), counts(size_class_count, 0),
+          malloc_count(0), free_count(0), hit_count(0), system_bytes(0)
+    {
+    }
+
+    SizeClassAllocator* allocator;
+    std::vector<SizeClassBlock*> heads;
+    std::vector<SizeClassBlock*> tails;
+    std::vector<int> counts;
+    // only the owning thread writes the counters, with relaxed atomic stores
+    // get_statistics reads them from other threads with relaxed atomic loads
+    int malloc_count;
+    int free_count;
+    int hit_count;
+    // bytes this thread took from the system minus the ones it gave back, wraps when it frees blocks of other threads
+    size_t system_bytes;
+};
+
+// a thread keeps up to this many bytes per size class, and always at least one block
+static const size_t size_class_cache_limit = 1024 * 1024;
+
+void size_class_allocator_cache_exit(void* _cache)
+{
+    SizeClassAllocatorCache* cache = (SizeClassAllocatorCache*)_cache;
+    SizeClassAllocator* allocator = cache->allocator;
+
+    // leave the blocks to the other threads
+    for (int i = 0; i < size_class_count; i++)
+    {
+        if (cache->heads[i])
+            allocator->push_global(i, cache->heads[i], cache->tails[i]);
+    }
+
+    allocator->caches_lock.lock();
+    allocator->caches.remove(cache);
+    allocator->exited_statistics.malloc_count += cache->malloc_count;
+    allocator->exited_statistics.free_count += cache->free_count;
+    allocator->exited_statistics.hit_count += cache->hit_count;
+    allocator->exited_system_bytes += cache->system_bytes;
+    allocator->caches_lock.unlock();
+
+    delete cache;
+}
+
+SizeClassAllocator::SizeClassAllocator()
+{
+    free_lists.resize(size_class_count, (void*)0);
+    memset(&exited_statistics, 0, sizeof(exited_statistics));
+    exited_system_bytes = 0;
+    current_bytes = 0;
+    peak_bytes = 0;
+    fallback_cache = 0;
+
+#ifdef _WIN32
+    tls_index = TlsAlloc();
+    tls_valid = tls_index != TLS_OUT_OF_INDEXES;
+#else
+    tls_valid = pthread_key_create(&tls_key, size_class_allocator_cache_exit) == 0;
+#endif
+
+    if (!tls_valid)
+    {
+        fallback_cache = new SizeClassAllocatorCache(this);
+        caches.push_back(fallback_cache);
+    }
+}
+
+SizeClassAllocator::~SizeClassAllocator()
+{
+    // no more cache flushes on thread exit
+    if (tls_valid)
+    {
+#ifdef _WIN32
+        TlsFree(tls_index);
+#else
+        pthread_key_delete(tls_key);
+#endif
+    }
+
+    clear();
+
+    AllocatorStatistics stats;
+    get_statistics(stats);
+    const int payouts_count = stats.malloc_count - stats.free_count;
+
+    std::list<SizeClassAllocatorCache*>::iterator it = caches.begin();
+    for (; it != caches.end(); it++)
+    {
+        delete *it;
+    }
+    caches.clear();
+
+    if (payouts_count != 0)
+    {
+        fprintf(stderr, "FATAL ERROR! size class allocator destroyed too early, %d blocks still in use\n", payouts_count);
+    }
+}
+
+void SizeClassAllocator::clear()
+{
+    caches_lock.lock();
+
+    std::list<SizeClassAllocatorCache*>::iterator it = caches.begin();
+    for (; it != caches.end(); it++)
+    {
+        SizeClassAllocatorCache* cache = *it;
+
+        for (int i = 0; i < size_class_count; i++)
+        {
+            SizeClassBlock* block = cache->heads[i];
+            while (block)
+            {
+                SizeClassBlock* next = block->next;
+                ncnn::fastFree(block);
+                block = next;
+            }
+
+            cache->heads[i] = 0;
+            cache->tails[i] = 0;
+            cache->counts[i] = 0;
+        }
+
+        cache->system_bytes = 0;
+    }
+
+    // nothing is cached any more, what is held is what is handed out
+    exited_system_bytes = current_bytes;
+
+    caches_lock.unlock();
+
+    for (int i = 0; i < size_class_count; i++)
+    {
+        SizeClassBlock* block = (SizeClassBlock*)atomic_exchange_ptr(&free_lists[i], 0);
+        while (block)
+        {
+            SizeClassBlock* next = block->next;
+            ncnn::fastFree(block);
+            block = next;
+        }
+    }
+}
+
+int SizeClassAllocator::get_statistics(AllocatorStatistics& stats)
+{
+    caches_lock.lock();
+
+    stats = exited_statistics;
+    size_t system_bytes = exited_system_bytes;
+
+    std::list<SizeClassAllocatorCache*>::iterator it = caches.begin();
+    for (; it != caches.end(); it++)
+    {
+        const SizeClassAllocatorCache* cache = *it;
+
+        stats.malloc_count += atomic_load_relaxed(&cache->malloc_count);
+        stats.free_count += atomic_load_relaxed(&cache->free_count);
+        stats.hit_count += atomic_load_relaxed(&cache->hit_count);
+        system_bytes += atomic_load_relaxed(&cache->system_bytes);
+    }
+
+    caches_lock.unlock();
+
+    stats.current_bytes = atomic_load_relaxed(&current_bytes);
+    stats.peak_bytes = atomic_load_relaxed(&peak_bytes);
+
+    // the counters of threads in flight may lag a little behind current_bytes
+    stats.cached_bytes = system_bytes > stats.current_bytes ? system_bytes - stats.current_bytes : 0;
+
+    return 0;
+}
+
+void SizeClassAllocator::count_malloc(SizeClassAllocatorCache* cache, size_t size, bool hit, bool system)
+{
+    atomic_store_relaxed(&cache->malloc_count, cache->malloc_count + 1);
+    if (hit)
+        atomic_store_relaxed(&cache->hit_count, cache->hit_count + 1);
+    if (system)
+        atomic_store_relaxed(&cache->system_bytes, cache->system_bytes + size);
+
+    // raise the peak to the total right after this malloc
+    const size_t current = atomic_fetch_add_size(&current_bytes, size) + size;
+
+    size_t peak = atomic_load_relaxed(&peak_bytes);
+    while (peak < current && !atomic_compare_exchange_size(&peak_bytes, peak, current))
+    {
+        peak = atomic_load_relaxed(&peak_bytes);
+    }
+}
+
+void SizeClassAllocator::count_free(SizeClassAllocatorCache* cache, size_t size, bool system)
+{
+    atomic_store_relaxed(&cache->free_count, cache->free_count + 1);
+    if (system)
+        atomic_store_relaxed(&cache->system_bytes, cache->system_bytes - size);
+
+    atomic_fetch_add_size(&current_bytes, (size_t)0 - size);
+}
+
+SizeClassAllocatorCache* SizeClassAllocator::get_cache()
+{
+#ifdef _WIN32
+    SizeClassAllocatorCache* cache = (SizeClassAllocatorCache*)TlsGetValue(tls_index);
+#else
+    SizeClassAllocatorCache* cache = (SizeClassAllocatorCache*)pthread_getspecific(tls_key);
+#endif
+    if (cache)
+        return cache;
+
+    cache = new SizeClassAllocatorCache(this);
+
+    caches_lock.lock();
+    caches.push_back(cache);
+    caches_lock.unlock();
+
+#ifdef _WIN32
+    TlsSetValue(tls_index, cache);
+#else
+    pthread_setspecific(tls_key, cache);
+#endif
+
+    return cache;
+}
+
+void SizeClassAllocator::push_global(int size_class, void* head, void* tail)
+{
+    // pushing a chain is safe against aba, only the pop side has to take the whole list at once
+    for (;;)
+    {
+        void* old_head = atomic_load_ptr(&free_lists[size_class]);
+
+        ((SizeClassBlock*)tail)->next = (SizeClassBlock*)old_head;
+
+        if (atomic_compare_exchange_ptr(&free_lists[size_class], old_head, head))
+            break;
+    }
+}
+
+void* SizeClassAllocator::fastMalloc(size_t size)
+{
+    if (!tls_valid)
+    {
+        fallback_lock.lock();
+        void* ptr = cache_malloc(fallback_cache, size);
+        fallback_lock.unlock();
+        return ptr;
+    }
+
+    return cache_malloc(get_cache(), size);
+}
+
+void SizeClassAllocator::fastFree(void* ptr)
+{
+    if (!tls_valid)
+    {
+        fallback_lock.lock();
+        cache_free(fallback_cache, ptr);
+        fallback_lock.unlock();
+        return;
+    }
+
+    cache_free(get_cache(), ptr);
+}
+
+void* SizeClassAllocator::cache_malloc(SizeClassAllocatorCache* cache, size_t size)
+{
+    const int size_class = get_size_class(size);
+
+    if (size_class >= size_class_count)
+    {
+        SizeClassBlock* block = (SizeClassBlock*)ncnn::fastMalloc(MALLOC_ALIGN + size);
+        if (!block)
+            return 0;
+
+        count_malloc(cache, size, false, true);
+
+        block->size = size;
+        block->size_class = -1;
+        return (unsigned char*)block + MALLOC_ALIGN;
+    }
+
+    if (!cache->heads[size_class])
+    {
+        // take the whole global list, there is no aba-safe way to pop a single block
+        SizeClassBlock* block = (SizeClassBlock*)atomic_exchange_ptr(&free_lists[size_class], 0);
+        if (block)
+        {
+            // keep up to the cache limit and give the rest back
+            const size_t class_size = get_size_class_size(size_class);
+
+            int count = 1;
+            cache->heads[size_class] = block;
+            while (block->next && (count + 1) * class_size <= size_class_cache_limit)
+            {
+                block = block->next;
+                count++;
+            }
+            cache->tails[size_class] = block;
+            cache->counts[size_class] = count;
+
+            SizeClassBlock* rest = block->next;
+            block->next = 0;
+
+            if (rest && !atomic_compare_exchange_ptr(&free_lists[size_class], 0, rest))
+            {
+                // someone pushed meanwhile, find the tail and chain the rest in front
+                SizeClassBlock* rest_tail = rest;
+                while (rest_tail->next)
+                {
+                    rest_tail = rest_tail->next;
+                }
+
+                push_global(size_class, rest, rest_tail);
+            }
+        }
+    }
+
+    SizeClassBlock* block = cache->heads[size_class];
+    if (block)
+    {
+        cache->heads[size_class] = block->next;
+        cache->counts[size_class]--;
+        if (cache->counts[size_class] == 0)
+            cache->tails[size_class] = 0;
+
+        count_malloc(cache, get_size_class_size(size_class), true, false);
+
+        return (unsigned char*)block + MALLOC_ALIGN;
+    }
+
+    // new
+    block = (SizeClassBlock*)ncnn::fastMalloc(MALLOC_ALIGN + get_size_class_size(size_class));
+    if (!block)
+        return 0;
+
+    count_malloc(cache, get_size_class_size(size_class), false, true);
+
+    block->size_class = size_class;
+    return (unsigned char*)block + MALLOC_ALIGN;
+}
+
+void SizeClassAllocator::cache_free(SizeClassAllocatorCache* cache, void* ptr)
+{
+    SizeClassBlock* block = (SizeClassBlock*)((unsigned char*)ptr - MALLOC_ALIGN);
+
+    const int size_class = block->size_class;
+    if (size_class < 0)
+    {
+        count_free(cache, block->size, true);
+
+        ncnn::fastFree(block);
+        return;
+    }
+
+    count_free(cache, get_size_class_size(size_class), false);
+
+    block->next = cache->heads[size_class];
+    cache->heads[size_class] = block;
+    if (!cache->tails[size_class])
+        cache->tails[size_class] = block;
+    cache->counts[size_class]++;
+
+    if (cache->counts[size_class] > 1 && cache->counts[size_class] * get_size_class_size(size_class) > size_class_cache_limit)
+    {
+        push_global(size_class, cache->heads[size_class], cache->tails[size_class]);
+
+        cache->heads[size_class] = 0;
+        cache->tails[size_class] = 0;
+        cache->counts[size_class] = 0;
+    }
+}
+
+ArenaAllocator::ArenaAllocator(size_t _chunk_size) : chunk_size(_chunk_size)
+{
+    chunk_index = 0;
+    chunk_offset = 0;
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    clear();
+}
+
+void ArenaAllocator::reset()
+{
+    chunk_index = 0;
+    chunk_offset = 0;
+    statistics.current_bytes = 0;
+
+    if (chunks.size() > 1)
+    {
+        size_t size = capacity();
+
+        clear();
+
+        unsigned char* ptr = (unsigned char*)ncnn::fastMalloc(size);
+        if (ptr)
+            chunks.push_back(std::make_pair(ptr, size));
+    }
+}
+
+void ArenaAllocator::clear()
+{
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        ncnn::fastFree(chunks[i].first);
+    }
+    chunks.clear();
+
+    chunk_index = 0;
+    chunk_offset = 0;
+    statistics.current_bytes = 0;
+}
+
+size_t ArenaAllocator::capacity() const
+{
+    size_t size = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        size += chunks[i].second;
+    }
+
+    return size;
+}
+
+void* ArenaAllocator::fastMalloc(size_t size)
+{
+    size = alignSize(size, MALLOC_ALIGN);
+
+    // the following chunks are retained from the previous rounds
+    while (chunk_index < chunks.size())
+    {
+        if (chunk_offset + size <= chunks[chunk_index].second)
+        {
+            void* ptr = chunks[chunk_index].first + chunk_offset;
+            chunk_offset += size;
+            statistics_malloc(statistics, size, true);
+            return ptr;
+        }
+
+        chunk_index++;
+        chunk_offset = 0;
+    }
+
+    // new
+    size_t new_chunk_size = std::max(size, chunk_size);
+
+    unsigned char* ptr = (unsigned char*)ncnn::fastMalloc(new_chunk_size);
+    if (!ptr)
+        return 0;
+
+    chunks.push_back(std::make_pair(ptr, new_chunk_size));
+    chunk_index = chunks.size() - 1;
+    chunk_offset = size;
+    statistics_malloc(statistics, size, false);
+
+    return ptr;
+}
+
+void ArenaAllocator::fastFree(void* /*ptr*/)
+{
+    // everything goes back on reset
+    statistics.free_count++;
+}
+
+int ArenaAllocator::get_statistics(AllocatorStatistics& stats)
+{
+    stats = statistics;
+
+    // the chunk tails skipped by larger allocations count as cached
+    stats.cached_bytes = capacity() - statistics.current_bytes;
+
+    return 0;
+}
+
+// nodes HugePageAllocator can bind to, the size of the mbind node mask
+static const int numa_node_count = 1024;
+
+#if defined(__linux__)
+// not every libc exposes these
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+static const size_t huge_page_size = 2 * 1024 * 1024;
+
+static int bind_numa_node(void* addr, size_t len, int node)
+{
+#ifdef __NR_mbind
+    // the raw syscall keeps libnuma out of the dependencies
+    unsigned long nodemask[numa_node_count / (8 * sizeof(unsigned long))];
+    memset(nodemask, 0, sizeof(nodemask));
+    nodemask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+
+    return (int)syscall(__NR_mbind, addr, len, MPOL_BIND, nodemask, sizeof(nodemask) * 8, 0);
+#else
+    (void)addr;
+    (void)len;
+    (void)node;
+    return -1;
+#endif
+}
+
+// a huge page aligned anonymous mapping of len bytes, len is a multiple of huge_page_size
+static unsigned char* map_huge_pages(size_t len, bool explicit_hugetlb)
+{
+    if (explicit_hugetlb)
+    {
+        void* ptr = mmap(0, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return ptr == MAP_FAILED ? 0 : (unsigned char*)ptr;
+    }
+
+    // over-map by one huge page and trim, transparent huge pages need aligned ranges
+    void* ptr = mmap(0, len + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        return 0;
+
+    unsigned char* raw = (unsigned char*)ptr;
+    unsigned char* base = alignPtr(raw, (int)huge_page_size);
+
+    if (base > raw)
+        munmap(raw, base - raw);
+
+    size_t tail = raw + len + huge_page_size - (base + len);
+    if (tail > 0)
+        munmap(base + len, tail);
+
+    madvise(base, len, MADV_HUGEPAGE);
+
+    return base;
+}
+#endif // __linux__
+
+// every block of HugePageAllocator starts with this header, the user pointer follows at MALLOC_ALIGN
+struct HugePageBlock
+{
+    // the mapping length, 0 for blocks from fastMalloc
+    size_t mapped_size;
+    // the bytes counted in the statistics
+    size_t size;
+};
+
+HugePageAllocator::HugePageAllocator(int _numa_node, bool _explicit_hugetlb)
+    : numa_node(_numa_node), explicit_hugetlb(_explicit_hugetlb)
+{
+    hugetlb_failed = 0;
+    huge_threshold = 2 * 1024 * 1024;
+    memset(&statistics, 0, sizeof(statistics));
+
+    if (numa_node < -1 || numa_node >= numa_node_count)
+    {
+        fprintf(stderr, "numa node %d out of range, left to first touch\n", numa_node);
+        numa_node = -1;
+    }
+}
+
+HugePageAllocator::~HugePageAllocator()
+{
+}
+
+void HugePageAllocator::set_huge_threshold(size_t threshold)
+{
+    huge_threshold = threshold;
+}
+
+void* HugePageAllocator::fastMalloc(size_t size)
+{
+#if defined(__linux__)
+    if (size >= huge_threshold)
+    {
+        const size_t len = alignSize(size + MALLOC_ALIGN, (int)huge_page_size);
+
+        unsigned char* base = 0;
+        if (explicit_hugetlb && !hugetlb_failed)
+        {
+            base = map_huge_pages(len, true);
+            if (!base)
+            {
+                fprintf(stderr, "hugetlbfs pool exhausted, fall back to transparent huge pages\n");
+                hugetlb_failed = 1;
+            }
+        }
+        if (!base)
+        {
+            base = map_huge_pages(len, false);
+        }
+
+        if (base)
+        {
+            // bind before the first touch so that every page faults in on the node
+            if (numa_node >= 0 && bind_numa_node(base, len, numa_node) != 0)
+            {
+                fprintf(stderr, "mbind to numa node %d failed\n", numa_node);
+            }
+
+            HugePageBlock* block = (HugePageBlock*)base;
+            block->mapped_size = len;
+            block->size = len;
+
+            statistics_lock.lock();
+            statistics_malloc(statistics, len, false);
+            statistics_lock.unlock();
+
+            return base + MALLOC_ALIGN;
+        }
+    }
+#endif // __linux__
+
+    HugePageBlock* block = (HugePageBlock*)ncnn::fastMalloc(MALLOC_ALIGN + size);
+    if (!block)
+        return 0;
+
+    block->mapped_size = 0;
+    block->size = size;
+
+    statistics_lock.lock();
+    statistics_malloc(statistics, size, false);
+    statistics_lock.unlock();
+
+    return (unsigned char*)block + MALLOC_ALIGN;
+}
+
+void HugePageAllocator::fastFree(void* ptr)
+{
+    HugePageBlock* block = (HugePageBlock*)((unsigned char*)ptr - MALLOC_ALIGN);
+
+    statistics_lock.lock();
+    statistics_free(statistics, block->size);
+    statistics_lock.unlock();
+
+#if defined(__linux__)
+    if (block->mapped_size)
+    {
+        munmap(block, block->mapped_size);
+        return;
+    }
+#endif // __linux__
+
+    ncnn::fastFree(block);
+}
+
+int HugePageAllocator::get_statistics(AllocatorStatistics& stats)
+{
+    statistics_lock.lock();
+    stats = statistics;
+    statistics_lock.unlock();
+
+    return 0;
+}
+
 #if NCNN_VULKAN
 VkAllocator::VkAllocator(const VulkanDevice* _vkdev) : vkdev(_vkdev)
 {
@@ -121,12 +121,31 @@ static inline void fastFree(void* ptr)
 static inline int NCNN_XADD(int* addr, int delta) { int tmp = *addr; *addr += delta; return tmp; }
 #endif
 
+// counters of one allocator since it was created
+struct AllocatorStatistics
+{
+    // bytes handed out and not freed yet, pooled blocks count with their full size
+    size_t current_bytes;
+    // the highest current_bytes so far
+    size_t peak_bytes;
+    // bytes held from the system and not handed out
+    size_t cached_bytes;
+    int malloc_count;
+    int free_count;
+    // mallocs served without a system allocation, the pool hit rate is hit_count / malloc_count
+    int hit_count;
+};
+
 class Allocator
 {
 public:
     virtual ~Allocator();
     virtual void* fastMalloc(size_t size) = 0;
     virtual void fastFree(void* ptr) = 0;
+
+    // return 0 if success
+    // return -1 if the allocator keeps no statistics, stats is zeroed then
+    virtual int get_statistics(AllocatorStatistics& stats);
 };
 
 class PoolAllocator : public Allocator
@@ -145,12 +164,16 @@ public:
     virtual void* fastMalloc(size_t size);
     virtual void fastFree(void* ptr);
 
+    virtual int get_statistics(AllocatorStatistics& stats);
+
 private:
     Mutex budgets_lock;
     Mutex payouts_lock;
     unsigned int size_compare_ratio;// 0~256
     std::list< std::pair<size_t, void*> > budgets;
     std::list< std::pair<size_t, void*> > payouts;
+    // updated along with payouts
+    AllocatorStatistics statistics;
 };
 
 class UnlockedPoolAllocator : public Allocator
@@ -169,10 +192,134 @@ public:
     virtual void* fastMalloc(size_t size);
     virtual void fastFree(void* ptr);
 
+    virtual int get_statistics(AllocatorStatistics& stats);
+
 private:
     unsigned int size_compare_ratio;// 0~256
     std::list< std::pair<size_t, void*> > budgets;
     std::list< std::pair<size_t, void*> > payouts;
+    // updated along with payouts
+    AllocatorStatistics statistics;
+};
+
+class SizeClassAllocatorCache;
+class SizeClassAllocator : public Allocator
+{
+public:
+    SizeClassAllocator();
+    ~SizeClassAllocator();
+
+    // release all cached blocks immediately
+    // no malloc or free may be in flight
+    void clear();
+
+    // blocks are rounded up to four size classes per power of two
+    // free goes to a per-thread cache, a cache that grows past its limit is handed to a lock-free global list
+    // malloc takes from the per-thread cache, then refills it from the global list of the class
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+    // the counts are kept per thread and summed up here
+    // current_bytes and peak_bytes are kept for all threads at once, the peak is taken at every malloc
+    virtual int get_statistics(AllocatorStatistics& stats);
+
+private:
+    friend void size_class_allocator_cache_exit(void* cache);
+    SizeClassAllocatorCache* get_cache();
+    void* cache_malloc(SizeClassAllocatorCache* cache, size_t size);
+    void cache_free(SizeClassAllocatorCache* cache, void* ptr);
+    void push_global(int size_class, void* head, void* tail);
+    void count_malloc(SizeClassAllocatorCache* cache, size_t size, bool hit, bool system);
+    void count_free(SizeClassAllocatorCache* cache, size_t size, bool system);
+
+    // one lock-free stack per size class
+    std::vector<void*> free_lists;
+
+    // caches of all threads, touched only when a thread first allocates or exits
+    Mutex caches_lock;
+    std::list<SizeClassAllocatorCache*> caches;
+    // the counts of exited threads
+    AllocatorStatistics exited_statistics;
+    size_t exited_system_bytes;
+    // bytes handed out by all threads and their highest value, updated atomically
+    size_t current_bytes;
+    size_t peak_bytes;
+
+    // without a thread-local slot all threads share fallback_cache under fallback_lock
+    bool tls_valid;
+    Mutex fallback_lock;
+    SizeClassAllocatorCache* fallback_cache;
+#ifdef _WIN32
+    DWORD tls_index;
+#else
+    pthread_key_t tls_key;
+#endif
+};
+
+class ArenaAllocator : public Allocator
+{
+public:
+    // chunks are at least chunk_size bytes
+    ArenaAllocator(size_t chunk_size = 4 * 1024 * 1024);
+    ~ArenaAllocator();
+
+    // make all chunks available again, chunks are retained
+    // the chunks of the last round are merged into one so that the next round fits without a system allocation
+    // nothing allocated before may still be in use
+    void reset();
+
+    // release all chunks immediately
+    void clear();
+
+    // bytes held from the system
+    size_t capacity() const;
+
+    // bump allocation in the current chunk, free is a no-op
+    // not thread-safe
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+    // current_bytes counts everything allocated since the last reset
+    virtual int get_statistics(AllocatorStatistics& stats);
+
+private:
+    size_t chunk_size;
+    std::vector< std::pair<unsigned char*, size_t> > chunks;
+    // the chunk in use and the bytes taken from it
+    size_t chunk_index;
+    size_t chunk_offset;
+    AllocatorStatistics statistics;
+};
+
+class HugePageAllocator : public Allocator
+{
+public:
+    // numa_node in [0, 1024) binds the huge page mappings to that node, -1 or out of range leaves them to first touch
+    // allocations below huge_threshold come from fastMalloc and are never bound, they share heap pages with other data
+    // explicit_hugetlb takes pages from the reserved hugetlbfs pool and falls back to transparent huge pages
+    // only implemented on linux, other platforms get plain fastMalloc
+    HugePageAllocator(int numa_node = -1, bool explicit_hugetlb = false);
+    ~HugePageAllocator();
+
+    // allocations of at least huge_threshold bytes are mapped directly in whole 2MB pages
+    // smaller ones come from fastMalloc
+    // default 2MB
+    void set_huge_threshold(size_t threshold);
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+    // mapped blocks count with their whole mapping, nothing is cached
+    virtual int get_statistics(AllocatorStatistics& stats);
+
+private:
+    int numa_node;
+    bool explicit_hugetlb;
+    // set once the hugetlbfs pool ran dry
+    int hugetlb_failed;
+    size_t huge_threshold;
+    Mutex statistics_lock;
+    AllocatorStatistics statistics;
 };
 
 #if NCNN_VULKAN
@@ -28,6 +28,15 @@
 #include <stdint.h>
 #endif
 
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define NCNN_CPU_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 #if __APPLE__
 #include "TargetConditionals.h"
 #if TARGET_OS_IPHONE
@@ -191,6 +200,165 @@ int cpu_support_arm_asimdhp()
 #endif
 }
 
+#if NCNN_CPU_X86
+static void x86_cpuid(int level, int subleaf, unsigned int out[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex((int*)out, level, subleaf);
+#else
+    __cpuid_count(level, subleaf, out[0], out[1], out[2], out[3]);
+#endif
+}
+
+static unsigned long long x86_get_xcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0;
+    unsigned int edx = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+static int get_cpu_support_x86_avx()
+{
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid(0, 0, cpu_info);
+
+    int nIds = cpu_info[0];
+    if (nIds < 1)
+        return 0;
+
+    x86_cpuid(1, 0, cpu_info);
+    // check avx and osxsave
+    if (!(cpu_info[2] & (1u << 28)) || !(cpu_info[2] & (1u << 27)))
+        return 0;
+
+    // check os saves xmm and ymm state
+    if ((x86_get_xcr0() & 6) != 6)
+        return 0;
+
+    return 1;
+}
+
+static int get_cpu_support_x86_avx2()
+{
+    if (!get_cpu_support_x86_avx())
+        return 0;
+
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid(0, 0, cpu_info);
+
+    int nIds = cpu_info[0];
+    if (nIds < 7)
+        return 0;
+
+    x86_cpuid(1, 0, cpu_info);
+    // check fma and f16c
+    if (!(cpu_info[2] & (1u << 12)) || !(cpu_info[2] & (1u << 29)))
+        return 0;
+
+    x86_cpuid(7, 0, cpu_info);
+    return cpu_info[1] & (1u << 5) ? 1 : 0;
+}
+
+static int get_cpu_support_x86_avx512()
+{
+    if (!get_cpu_support_x86_avx2())
+        return 0;
+
+    // check os saves opmask and zmm state
+    if ((x86_get_xcr0() & 0xe6) != 0xe6)
+        return 0;
+
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid(7, 0, cpu_info);
+
+    // avx512f avx512dq avx512cd avx512bw avx512vl
+    const unsigned int avx512_mask = (1u << 16) | (1u << 17) | (1u << 28) | (1u << 30) | (1u << 31);
+    return (cpu_info[1] & avx512_mask) == avx512_mask ? 1 : 0;
+}
+
+static int get_cpu_support_x86_avx_vnni()
+{
+    if (!get_cpu_support_x86_avx2())
+        return 0;
+
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid(7, 0, cpu_info);
+
+    int nSubIds = cpu_info[0];
+    if (nSubIds < 1)
+        return 0;
+
+    x86_cpuid(7, 1, cpu_info);
+    return cpu_info[0] & (1u << 4) ? 1 : 0;
+}
+
+static int get_cpu_support_x86_avx512_vnni()
+{
+    if (!get_cpu_support_x86_avx512())
+        return 0;
+
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid(7, 0, cpu_info);
+    return cpu_info[2] & (1u << 11) ? 1 : 0;
+}
+
+static int g_cpu_support_x86_avx = get_cpu_support_x86_avx();
+static int g_cpu_support_x86_avx2 = get_cpu_support_x86_avx2();
+static int g_cpu_support_x86_avx512 = get_cpu_support_x86_avx512();
+static int g_cpu_support_x86_avx_vnni = get_cpu_support_x86_avx_vnni();
+static int g_cpu_support_x86_avx512_vnni = get_cpu_support_x86_avx512_vnni();
+#endif // NCNN_CPU_X86
+
+int cpu_support_x86_avx()
+{
+#if NCNN_CPU_X86
+    return g_cpu_support_x86_avx;
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_avx2()
+{
+#if NCNN_CPU_X86
+    return g_cpu_support_x86_avx2;
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_avx512()
+{
+#if NCNN_CPU_X86
+    return g_cpu_support_x86_avx512;
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_avx_vnni()
+{
+#if NCNN_CPU_X86
+    return g_cpu_support_x86_avx_vnni;
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_avx512_vnni()
+{
+#if NCNN_CPU_X86
+    return g_cpu_support_x86_avx512_vnni;
+#else
+    return 0;
+#endif
+}
+
 static int get_cpucount()
 {
 #ifdef __ANDROID__
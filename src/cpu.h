@@ -25,6 +25,17 @@ int cpu_support_arm_vfpv4();
 // asimdhp = aarch64 asimd half precision
 int cpu_support_arm_asimdhp();
 
+// avx = x86 avx
+int cpu_support_x86_avx();
+// avx2 = x86 avx2 + fma + f16c
+int cpu_support_x86_avx2();
+// avx512 = x86 avx512f + avx512cd + avx512bw + avx512dq + avx512vl
+int cpu_support_x86_avx512();
+// avx vnni = x86 avx2 + avx vnni
+int cpu_support_x86_avx_vnni();
+// avx512 vnni = x86 avx512 + avx512 vnni
+int cpu_support_x86_avx512_vnni();
+
 // cpu info
 int get_cpu_count();
 
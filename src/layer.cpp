@@ -37,6 +37,9 @@ Layer::Layer()
     support_inplace = false;
     support_vulkan = false;
     support_packing = false;
+    preferred_elempack = 4;
+    support_bf16_storage = false;
+    support_batch = false;
 
 #if NCNN_VULKAN
     vkdev = 0;
@@ -105,6 +108,19 @@ int Layer::forward_inplace(Mat& /*bottom_top_blob*/, const Option& /*opt*/) cons
     return -1;
 }
 
+int Layer::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    top_blobs.resize(bottom_blobs.size());
+    for (size_t i=0; i<bottom_blobs.size(); i++)
+    {
+        int ret = forward(bottom_blobs[i], top_blobs[i], opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 #if NCNN_VULKAN
 int Layer::upload_model(VkTransfer& /*cmd*/, const Option& /*opt*/)
 {
@@ -159,8 +175,48 @@ static const layer_registry_entry layer_registry[] =
 #include "layer_registry.h"
 };
 
+#if NCNN_RUNTIME_CPU && NCNN_AVX512
+static const layer_registry_entry layer_registry_avx512[] =
+{
+#include "layer_registry_avx512.h"
+};
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX512
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2
+static const layer_registry_entry layer_registry_avx2[] =
+{
+#include "layer_registry_avx2.h"
+};
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX2
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX
+static const layer_registry_entry layer_registry_avx[] =
+{
+#include "layer_registry_avx.h"
+};
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX
+
 static const int layer_registry_entry_count = sizeof(layer_registry) / sizeof(layer_registry_entry);
 
+// pick the layer registry built for the best instruction set extension this cpu supports
+static const layer_registry_entry* get_layer_registry()
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX512
+    if (cpu_support_x86_avx512())
+        return layer_registry_avx512;
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX512
+#if NCNN_RUNTIME_CPU && NCNN_AVX2
+    if (cpu_support_x86_avx2())
+        return layer_registry_avx2;
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX2
+#if NCNN_RUNTIME_CPU && NCNN_AVX
+    if (cpu_support_x86_avx())
+        return layer_registry_avx;
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX
+
+    return layer_registry;
+}
+
 #if NCNN_STRING
 int layer_to_index(const char* type)
 {
@@ -188,7 +244,7 @@ Layer* create_layer(int index)
     if (index < 0 || index >= layer_registry_entry_count)
         return 0;
 
-    layer_creator_func layer_creator = layer_registry[index].creator;
+    layer_creator_func layer_creator = get_layer_registry()[index].creator;
     if (!layer_creator)
         return 0;
 
@@ -70,6 +70,16 @@ public:
     // accept input blob with packed storage
     bool support_packing;
 
+    // elempack of input blobs when packing is supported
+    // blobs whose channel count it does not divide fall back to pack4, then to pack1
+    int preferred_elempack;
+
+    // accept input blob with bfloat16 storage when use_bf16_storage is enabled
+    bool support_bf16_storage;
+
+    // fold a batch of inputs into one forward_batch call
+    bool support_batch;
+
 public:
     // implement inference
     // return 0 if success
@@ -81,6 +91,12 @@ public:
     virtual int forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const;
     virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
 
+    // implement batched inference of a one_blob_only layer
+    // one top blob for every bottom blob, the items are independent
+    // default implementation forwards them one by one
+    // return 0 if success
+    virtual int forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
 #if NCNN_VULKAN
 public:
     // upload weight blob from host to device
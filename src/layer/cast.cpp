@@ -195,6 +195,11 @@ int Cast::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) cons
         // int8
         out_elemsize = elempack;
     }
+    else if (type_to == 4)
+    {
+        // bfloat16
+        out_elemsize = 2 * elempack;
+    }
 
     if (dims == 1)
     {
@@ -243,6 +248,36 @@ int Cast::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) cons
         }
     }
 
+    if (type_from == 1 && type_to == 4)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q=0; q<channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            unsigned short* outptr = top_blob.channel(q);
+
+            for (int i=0; i<size; i++)
+            {
+                outptr[i] = float32_to_bfloat16(ptr[i]);
+            }
+        }
+    }
+
+    if (type_from == 4 && type_to == 1)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q=0; q<channels; q++)
+        {
+            const unsigned short* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            for (int i=0; i<size; i++)
+            {
+                outptr[i] = bfloat16_to_float32(ptr[i]);
+            }
+        }
+    }
+
     if (type_from == 3 && type_to == 1)
     {
         #pragma omp parallel for num_threads(opt.num_threads)
@@ -19,6 +19,34 @@
 namespace ncnn
 {
 
+static inline float activation_ss(float v, int activation_type, const Mat &activation_params)
+{
+    if (activation_type == 1)
+    {
+        v = std::max(v, 0.f);
+    }
+    else if (activation_type == 2)
+    {
+        float slope = activation_params[0];
+        v = v > 0.f ? v : v * slope;
+    }
+    else if (activation_type == 3)
+    {
+        float min = activation_params[0];
+        float max = activation_params[1];
+        if (v < min)
+            v = min;
+        if (v > max)
+            v = max;
+    }
+    else if (activation_type == 4)
+    {
+        v = static_cast<float>(1.f / (1.f + exp(-v)));
+    }
+
+    return v;
+}
+
 DEFINE_LAYER_CREATOR(InnerProduct)
 
 InnerProduct::InnerProduct()
@@ -101,6 +129,42 @@ int InnerProduct::forward(const Mat &bottom_blob, Mat &top_blob, const Option &o
     size_t elemsize = bottom_blob.elemsize;
     int size = w * h;
 
+    const int num_input = weight_data_size / num_output;
+
+    if (bottom_blob.dims == 2 && w == num_input && h > 1)
+    {
+        // gemm, each row is one input vector
+        top_blob.create(num_output, h, elemsize, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+#pragma omp parallel for num_threads(opt.num_threads)
+        for (int j = 0; j < h; j++)
+        {
+            const float *m = bottom_blob.row(j);
+            float *outptr = top_blob.row(j);
+
+            for (int p = 0; p < num_output; p++)
+            {
+                const float *kptr = (const float *)weight_data + w * p;
+
+                float sum = 0.f;
+
+                if (bias_term)
+                    sum = bias_data[p];
+
+                for (int i = 0; i < w; i++)
+                {
+                    sum += m[i] * kptr[i];
+                }
+
+                outptr[p] = activation_ss(sum, activation_type, activation_params);
+            }
+        }
+
+        return 0;
+    }
+
     top_blob.create(num_output, elemsize, opt.blob_allocator);
     if (top_blob.empty())
         return -100;
@@ -126,30 +190,7 @@ int InnerProduct::forward(const Mat &bottom_blob, Mat &top_blob, const Option &o
             }
         }
 
-        if (activation_type == 1)
-        {
-            sum = std::max(sum, 0.f);
-        }
-        else if (activation_type == 2)
-        {
-            float slope = activation_params[0];
-            sum = sum > 0.f ? sum : sum * slope;
-        }
-        else if (activation_type == 3)
-        {
-            float min = activation_params[0];
-            float max = activation_params[1];
-            if (sum < min)
-                sum = min;
-            if (sum > max)
-                sum = max;
-        }
-        else if (activation_type == 4)
-        {
-            sum = static_cast<float>(1.f / (1.f + exp(-sum)));
-        }
-
-        top_blob[p] = sum;
+        top_blob[p] = activation_ss(sum, activation_type, activation_params);
     }
 
     return 0;
@@ -0,0 +1,218 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "batchnorm_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(BatchNorm_x86)
+
+BatchNorm_x86::BatchNorm_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#endif // __SSE2__
+}
+
+// ptr[i] = b * ptr[i] + a for size elements of elempack lanes
+static void batchnorm_inplace(float *ptr, const float *bdata, const float *adata, int elempack, int size)
+{
+    // lane values repeated to a full register, elempack divides 8
+    float b[8];
+    float a[8];
+    for (int k = 0; k < 8; k++)
+    {
+        b[k] = bdata[k % elempack];
+        a[k] = adata[k % elempack];
+    }
+
+    const int n = size * elempack;
+
+    int i = 0;
+#if __AVX__
+    __m256 _b_avx = _mm256_loadu_ps(b);
+    __m256 _a_avx = _mm256_loadu_ps(a);
+    for (; i + 7 < n; i += 8)
+    {
+        _mm256_storeu_ps(ptr, _mm256_comp_fmadd_ps(_b_avx, _mm256_loadu_ps(ptr), _a_avx));
+        ptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _b = _mm_loadu_ps(b);
+    __m128 _a = _mm_loadu_ps(a);
+    for (; i + 3 < n; i += 4)
+    {
+        _mm_storeu_ps(ptr, _mm_comp_fmadd_ps(_b, _mm_loadu_ps(ptr), _a));
+        ptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < n; i++)
+    {
+        *ptr = b[i % 8] * *ptr + a[i % 8];
+        ptr++;
+    }
+}
+
+namespace {
+
+// one row of a 2d BatchNorm_x86::forward_inplace
+class BatchNorm_x86_row_task : public ParallelTask
+{
+public:
+    void operator()(int i) const
+    {
+        float *ptr = bottom_top_blob->row(i);
+
+        batchnorm_inplace(ptr, (const float *)b_data + i * elempack, (const float *)a_data + i * elempack, elempack, w);
+    }
+
+    Mat* bottom_top_blob;
+    const float* b_data;
+    const float* a_data;
+    int elempack;
+    int w;
+};
+
+// one channel of a 3d BatchNorm_x86::forward_inplace
+class BatchNorm_x86_channel_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = bottom_top_blob->channel(q);
+
+        batchnorm_inplace(ptr, (const float *)b_data + q * elempack, (const float *)a_data + q * elempack, elempack, size);
+    }
+
+    Mat* bottom_top_blob;
+    const float* b_data;
+    const float* a_data;
+    int elempack;
+    int size;
+};
+
+// one register of a 1d BatchNorm_x86::forward_inplace
+class BatchNorm_x86_lanes_task : public ParallelTask
+{
+public:
+    void operator()(int ii) const
+    {
+#if __AVX__
+        int i = ii * 8;
+
+        __m256 _p = _mm256_loadu_ps(ptr + i);
+        __m256 _b = _mm256_loadu_ps((const float *)b_data + i);
+        __m256 _a = _mm256_loadu_ps((const float *)a_data + i);
+        _mm256_storeu_ps(ptr + i, _mm256_comp_fmadd_ps(_b, _p, _a));
+#elif __SSE2__
+        int i = ii * 4;
+
+        __m128 _p = _mm_loadu_ps(ptr + i);
+        __m128 _b = _mm_loadu_ps((const float *)b_data + i);
+        __m128 _a = _mm_loadu_ps((const float *)a_data + i);
+        _mm_storeu_ps(ptr + i, _mm_comp_fmadd_ps(_b, _p, _a));
+#endif // __AVX__
+    }
+
+    float* ptr;
+    const float* b_data;
+    const float* a_data;
+};
+
+} // namespace
+
+int BatchNorm_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    // value = b * value + a
+
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    if (dims == 1)
+    {
+        // one lane per channel, the whole blob is a single run
+        float *ptr = bottom_top_blob;
+
+        int nn = 0;
+#if __AVX__
+        nn = channels / 8;
+#elif __SSE2__
+        nn = channels / 4;
+#endif // __AVX__
+        BatchNorm_x86_lanes_task task;
+        task.ptr = ptr;
+        task.b_data = b_data;
+        task.a_data = a_data;
+        parallel_for(opt, nn, task);
+#if __AVX__
+        nn *= 8;
+#elif __SSE2__
+        nn *= 4;
+#endif // __AVX__
+        for (int i = nn; i < channels; i++)
+        {
+            ptr[i] = b_data[i] * ptr[i] + a_data[i];
+        }
+    }
+
+    if (dims == 2)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+
+        BatchNorm_x86_row_task task;
+        task.bottom_top_blob = &bottom_top_blob;
+        task.b_data = b_data;
+        task.a_data = a_data;
+        task.elempack = elempack;
+        task.w = w;
+        parallel_for(opt, h, task);
+    }
+
+    if (dims == 3)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int c = bottom_top_blob.c;
+        int size = w * h;
+
+        BatchNorm_x86_channel_task task;
+        task.bottom_top_blob = &bottom_top_blob;
+        task.b_data = b_data;
+        task.a_data = a_data;
+        task.elempack = elempack;
+        task.size = size;
+        parallel_for(opt, c, task);
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
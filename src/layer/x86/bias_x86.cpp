@@ -0,0 +1,111 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "bias_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(Bias_x86)
+
+Bias_x86::Bias_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#endif // __SSE2__
+}
+
+namespace {
+
+// one channel of Bias_x86::forward_inplace
+class Bias_x86_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = bottom_top_blob->channel(q);
+
+        // lane values repeated to a full register, elempack divides 8
+        float bias[8];
+        for (int k = 0; k < 8; k++)
+        {
+            bias[k] = bias_ptr[q * elempack + k % elempack];
+        }
+
+        int i = 0;
+#if __AVX__
+        __m256 _bias_avx = _mm256_loadu_ps(bias);
+        for (; i + 7 < n; i += 8)
+        {
+            _mm256_storeu_ps(ptr, _mm256_add_ps(_mm256_loadu_ps(ptr), _bias_avx));
+            ptr += 8;
+        }
+#endif // __AVX__
+#if __SSE2__
+        __m128 _bias = _mm_loadu_ps(bias);
+        for (; i + 3 < n; i += 4)
+        {
+            _mm_storeu_ps(ptr, _mm_add_ps(_mm_loadu_ps(ptr), _bias));
+            ptr += 4;
+        }
+#endif // __SSE2__
+        for (; i < n; i++)
+        {
+            *ptr += bias[i % 8];
+            ptr++;
+        }
+    }
+
+    Mat* bottom_top_blob;
+    int n;
+    int elempack;
+    const float* bias_ptr;
+};
+
+} // namespace
+
+int Bias_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int channels = bottom_top_blob.c;
+    int elempack = bottom_top_blob.elempack;
+    int n = w * h * elempack;
+
+    const float *bias_ptr = bias_data;
+
+    Bias_x86_task task;
+    task.bottom_top_blob = &bottom_top_blob;
+    task.n = n;
+    task.elempack = elempack;
+    task.bias_ptr = bias_ptr;
+    parallel_for(opt, channels, task);
+
+    return 0;
+}
+
+} // namespace ncnn
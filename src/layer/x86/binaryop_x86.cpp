@@ -0,0 +1,667 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "binaryop_x86.h"
+
+#include <math.h>
+#include <algorithm>
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(BinaryOp_x86)
+
+// outptr[i] = op(ptr[i], ptr1[i])
+template<typename Op>
+static void binary_op_vector_vector(const float *ptr, const float *ptr1, float *outptr, int size)
+{
+    Op op;
+
+    int i = 0;
+#if __AVX__
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_loadu_ps(ptr);
+        __m256 _p1 = _mm256_loadu_ps(ptr1);
+        _mm256_storeu_ps(outptr, op(_p, _p1));
+        ptr += 8;
+        ptr1 += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_loadu_ps(ptr);
+        __m128 _p1 = _mm_loadu_ps(ptr1);
+        _mm_storeu_ps(outptr, op(_p, _p1));
+        ptr += 4;
+        ptr1 += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr = op(*ptr, *ptr1);
+        ptr++;
+        ptr1++;
+        outptr++;
+    }
+}
+
+// outptr[i] = op(ptr[i], b)
+template<typename Op>
+static void binary_op_vector_scalar(const float *ptr, float b, float *outptr, int size)
+{
+    Op op;
+
+    int i = 0;
+#if __AVX__
+    __m256 _b_avx = _mm256_set1_ps(b);
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_loadu_ps(ptr);
+        _mm256_storeu_ps(outptr, op(_p, _b_avx));
+        ptr += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _b = _mm_set1_ps(b);
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_loadu_ps(ptr);
+        _mm_storeu_ps(outptr, op(_p, _b));
+        ptr += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr = op(*ptr, b);
+        ptr++;
+        outptr++;
+    }
+}
+
+// outptr[i] = op(a, ptr1[i])
+template<typename Op>
+static void binary_op_scalar_vector(float a, const float *ptr1, float *outptr, int size)
+{
+    Op op;
+
+    int i = 0;
+#if __AVX__
+    __m256 _a_avx = _mm256_set1_ps(a);
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p1 = _mm256_loadu_ps(ptr1);
+        _mm256_storeu_ps(outptr, op(_a_avx, _p1));
+        ptr1 += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _a = _mm_set1_ps(a);
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p1 = _mm_loadu_ps(ptr1);
+        _mm_storeu_ps(outptr, op(_a, _p1));
+        ptr1 += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr = op(a, *ptr1);
+        ptr1++;
+        outptr++;
+    }
+}
+
+namespace {
+
+// one channel or row of binary_op
+// an operand sits at q * step, a scalar operand is one value there, step 0 broadcasts it to every q
+template<typename Op>
+class binary_op_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *outptr = c + q * cstep;
+
+        if (a_scalar)
+            binary_op_scalar_vector<Op>(a[q * astep], b + q * bstep, outptr, size);
+        else if (b_scalar)
+            binary_op_vector_scalar<Op>(a + q * astep, b[q * bstep], outptr, size);
+        else
+            binary_op_vector_vector<Op>(a + q * astep, b + q * bstep, outptr, size);
+    }
+
+    const float *a;
+    size_t astep;
+    bool a_scalar;
+    const float *b;
+    size_t bstep;
+    bool b_scalar;
+    float *c;
+    size_t cstep;
+    int size;
+};
+
+// one channel of binary_op with a 2d b holding a scalar per row of a
+template<typename Op>
+class binary_op_row_scalar_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = a.channel(q);
+        const float *ptr1 = b.row(q);
+        float *outptr = c->channel(q);
+
+        for (int y = 0; y < h; y++)
+        {
+            binary_op_vector_scalar<Op>(ptr, ptr1[y], outptr, w);
+
+            ptr += w;
+            outptr += w;
+        }
+    }
+
+    Mat a;
+    Mat b;
+    Mat *c;
+    int w;
+    int h;
+};
+
+// one channel of binary_op with a 2d a holding a scalar per row of b
+template<typename Op>
+class binary_op_scalar_row_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = a.row(q);
+        const float *ptr1 = b.channel(q);
+        float *outptr = c->channel(q);
+
+        for (int y = 0; y < h1; y++)
+        {
+            binary_op_scalar_vector<Op>(ptr[y], ptr1, outptr, w1);
+
+            ptr1 += w1;
+            outptr += w1;
+        }
+    }
+
+    Mat a;
+    Mat b;
+    Mat *c;
+    int w1;
+    int h1;
+};
+
+} // namespace
+
+// c + q * cstep = op(a + q * astep, b + q * bstep) for q < n
+template<typename Op>
+static void binary_op_broadcast(const float *a, size_t astep, bool a_scalar, const float *b, size_t bstep, bool b_scalar, float *c, size_t cstep, int size, int n, const Option &opt)
+{
+    binary_op_task<Op> task;
+    task.a = a;
+    task.astep = astep;
+    task.a_scalar = a_scalar;
+    task.b = b;
+    task.bstep = bstep;
+    task.b_scalar = b_scalar;
+    task.c = c;
+    task.cstep = cstep;
+    task.size = size;
+    parallel_for(opt, n, task);
+}
+
+// broadcasting rule
+// https://github.com/Tencent/ncnn/wiki/binaryop-broadcasting
+
+template<typename Op>
+static int binary_op(const Mat &a, const Mat &b, Mat &c, const Option &opt)
+{
+    int w = a.w;
+    int h = a.h;
+    int channels = a.c;
+    int size = w * h;
+    size_t elemsize = a.elemsize;
+
+    int w1 = b.w;
+    int h1 = b.h;
+    int channels1 = b.c;
+    int size1 = w1 * h1;
+
+    if (a.dims == 3)
+    {
+        c.create(w, h, channels, elemsize, opt.blob_allocator);
+        if (c.empty())
+            return -100;
+
+        if (b.dims == 3)
+        {
+            if (w1 == 1 && h1 == 1 && channels1 == channels)
+            {
+                // special type 1
+                binary_op_broadcast<Op>(a, a.cstep, false, b, b.cstep, true, c, c.cstep, size, channels, opt);
+
+                return 0;
+            }
+
+            if (w1 == w && h1 == h && channels1 == 1)
+            {
+                // special type 2
+                binary_op_broadcast<Op>(a, a.cstep, false, b, 0, false, c, c.cstep, size, channels, opt);
+
+                return 0;
+            }
+
+            // type 19
+            binary_op_broadcast<Op>(a, a.cstep, false, b, b.cstep, false, c, c.cstep, size, channels, opt);
+
+            return 0;
+        }
+
+        if (b.dims == 2)
+        {
+            // type 18
+            binary_op_row_scalar_task<Op> task;
+            task.a = a;
+            task.b = b;
+            task.c = &c;
+            task.w = w;
+            task.h = h;
+            parallel_for(opt, channels, task);
+
+            return 0;
+        }
+
+        if (b.dims == 1)
+        {
+            if (b.w == 1)
+            {
+                // type 16
+                binary_op_broadcast<Op>(a, a.cstep, false, b, 0, true, c, c.cstep, size, channels, opt);
+
+                return 0;
+            }
+
+            // type 17
+            binary_op_broadcast<Op>(a, a.cstep, false, b, 1, true, c, c.cstep, size, channels, opt);
+
+            return 0;
+        }
+    }
+    else if (a.dims == 2)
+    {
+        if (b.dims == 3)
+        {
+            // type 14
+            c.create(w1, h1, channels1, elemsize, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            binary_op_scalar_row_task<Op> task;
+            task.a = a;
+            task.b = b;
+            task.c = &c;
+            task.w1 = w1;
+            task.h1 = h1;
+            parallel_for(opt, channels1, task);
+
+            return 0;
+        }
+
+        c.create(w, h, elemsize, opt.blob_allocator);
+        if (c.empty())
+            return -100;
+
+        if (b.dims == 2)
+        {
+            // type 13
+            binary_op_vector_vector<Op>(a, b, c, size);
+
+            return 0;
+        }
+
+        if (b.dims == 1)
+        {
+            if (b.w == 1)
+            {
+                // type 11
+                binary_op_vector_scalar<Op>(a, b[0], c, size);
+
+                return 0;
+            }
+
+            // type 12
+            binary_op_broadcast<Op>(a, w, false, b, 1, true, c, w, w, h, opt);
+
+            return 0;
+        }
+    }
+    else if (a.dims == 1)
+    {
+        if (a.w == 1)
+        {
+            if (b.dims == 3)
+            {
+                // type 4
+                c.create(w1, h1, channels1, elemsize, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                binary_op_broadcast<Op>(a, 0, true, b, b.cstep, false, c, c.cstep, size1, channels1, opt);
+
+                return 0;
+            }
+
+            if (b.dims == 2)
+            {
+                // type 3
+                c.create(w1, h1, elemsize, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                binary_op_scalar_vector<Op>(a[0], b, c, size1);
+
+                return 0;
+            }
+
+            if (b.dims == 1)
+            {
+                // type 2
+                c.create(w1, elemsize, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                binary_op_scalar_vector<Op>(a[0], b, c, w1);
+
+                return 0;
+            }
+        }
+
+        if (b.dims == 3)
+        {
+            // type 9
+            c.create(w1, h1, channels1, elemsize, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            binary_op_broadcast<Op>(a, 1, true, b, b.cstep, false, c, c.cstep, size1, channels1, opt);
+
+            return 0;
+        }
+
+        if (b.dims == 2)
+        {
+            // type 8
+            c.create(w1, h1, elemsize, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            binary_op_broadcast<Op>(a, 1, true, b, w1, false, c, w1, w1, h1, opt);
+
+            return 0;
+        }
+
+        if (b.dims == 1)
+        {
+            c.create(w, elemsize, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            if (b.w == 1)
+            {
+                // type 6
+                binary_op_vector_scalar<Op>(a, b[0], c, w);
+
+                return 0;
+            }
+
+            // type 7
+            binary_op_vector_vector<Op>(a, b, c, w);
+        }
+    }
+
+    return 0;
+}
+
+template<typename Op>
+static int binary_op_scalar_inplace(Mat &a, float b, const Option &opt)
+{
+    int w = a.w;
+    int h = a.h;
+    int channels = a.c;
+    int size = w * h;
+
+    binary_op_broadcast<Op>(a, a.cstep, false, &b, 0, true, a, a.cstep, size, channels, opt);
+
+    return 0;
+}
+
+namespace BinaryOp_x86_functor {
+
+struct binary_op_add
+{
+    float operator()(const float &x, const float &y) const { return x + y; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_add_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_add_ps(x, y); }
+#endif
+};
+
+struct binary_op_sub
+{
+    float operator()(const float &x, const float &y) const { return x - y; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_sub_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_sub_ps(x, y); }
+#endif
+};
+
+struct binary_op_mul
+{
+    float operator()(const float &x, const float &y) const { return x * y; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_mul_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_mul_ps(x, y); }
+#endif
+};
+
+struct binary_op_div
+{
+    float operator()(const float &x, const float &y) const { return x / y; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_div_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_div_ps(x, y); }
+#endif
+};
+
+struct binary_op_max
+{
+    float operator()(const float &x, const float &y) const { return std::max(x, y); }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_max_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_max_ps(x, y); }
+#endif
+};
+
+struct binary_op_min
+{
+    float operator()(const float &x, const float &y) const { return std::min(x, y); }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_min_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_min_ps(x, y); }
+#endif
+};
+
+struct binary_op_pow
+{
+    float operator()(const float &x, const float &y) const { return static_cast<float>(pow(x, y)); }
+#if __SSE2__
+    // lane by lane, pow keeps its exact semantics for negative bases
+    __m128 operator()(const __m128 &x, const __m128 &y) const
+    {
+        float tmpx[4];
+        float tmpy[4];
+        _mm_storeu_ps(tmpx, x);
+        _mm_storeu_ps(tmpy, y);
+        for (int i = 0; i < 4; i++)
+            tmpx[i] = static_cast<float>(pow(tmpx[i], tmpy[i]));
+        return _mm_loadu_ps(tmpx);
+    }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const
+    {
+        float tmpx[8];
+        float tmpy[8];
+        _mm256_storeu_ps(tmpx, x);
+        _mm256_storeu_ps(tmpy, y);
+        for (int i = 0; i < 8; i++)
+            tmpx[i] = static_cast<float>(pow(tmpx[i], tmpy[i]));
+        return _mm256_loadu_ps(tmpx);
+    }
+#endif
+};
+
+struct binary_op_rsub
+{
+    float operator()(const float &x, const float &y) const { return y - x; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_sub_ps(y, x); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_sub_ps(y, x); }
+#endif
+};
+
+struct binary_op_rdiv
+{
+    float operator()(const float &x, const float &y) const { return y / x; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_div_ps(y, x); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_div_ps(y, x); }
+#endif
+};
+
+} // namespace BinaryOp_x86_functor
+
+int BinaryOp_x86::forward(const std::vector<Mat> &bottom_blobs, std::vector<Mat> &top_blobs, const Option &opt) const
+{
+    const Mat &bottom_blob = bottom_blobs[0];
+    const Mat &bottom_blob1 = bottom_blobs[1];
+
+    Mat &top_blob = top_blobs[0];
+
+    using namespace BinaryOp_x86_functor;
+
+    if (op_type == Operation_ADD)
+        return binary_op<binary_op_add>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_SUB)
+        return binary_op<binary_op_sub>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_MUL)
+        return binary_op<binary_op_mul>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_DIV)
+        return binary_op<binary_op_div>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_MAX)
+        return binary_op<binary_op_max>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_MIN)
+        return binary_op<binary_op_min>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_POW)
+        return binary_op<binary_op_pow>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_RSUB)
+        return binary_op<binary_op_rsub>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    if (op_type == Operation_RDIV)
+        return binary_op<binary_op_rdiv>(bottom_blob, bottom_blob1, top_blob, opt);
+
+    return 0;
+}
+
+int BinaryOp_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    using namespace BinaryOp_x86_functor;
+
+    if (op_type == Operation_ADD)
+        return binary_op_scalar_inplace<binary_op_add>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_SUB)
+        return binary_op_scalar_inplace<binary_op_sub>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_MUL)
+        return binary_op_scalar_inplace<binary_op_mul>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_DIV)
+        return binary_op_scalar_inplace<binary_op_div>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_MAX)
+        return binary_op_scalar_inplace<binary_op_max>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_MIN)
+        return binary_op_scalar_inplace<binary_op_min>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_POW)
+        return binary_op_scalar_inplace<binary_op_pow>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_RSUB)
+        return binary_op_scalar_inplace<binary_op_rsub>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_RDIV)
+        return binary_op_scalar_inplace<binary_op_rdiv>(bottom_top_blob, b, opt);
+
+    return 0;
+}
+
+} // namespace ncnn
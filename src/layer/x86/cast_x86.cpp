@@ -14,9 +14,15 @@
 
 #include "cast_x86.h"
 
+#if __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+#include "threadpool.h"
+
 namespace ncnn {
 
-#if NCNN_AVX2
+#if __F16C__
 #include <emmintrin.h>
 #include <immintrin.h>
 
@@ -31,7 +37,7 @@ typedef union m256i
     __m256i  vec;
     uint32_t m256i_u32[8];
 } m256;
-#endif //NCNN_AVX2
+#endif // __F16C__
 
 DEFINE_LAYER_CREATOR(Cast_x86)
 
@@ -40,9 +46,87 @@ Cast_x86::Cast_x86()
 
 }
 
+namespace {
+
+#if __F16C__
+// one channel of Cast_x86::forward from fp32 to fp16
+class Cast_x86_fp32_to_fp16_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* ptr = bottom_blob.channel(q);
+        unsigned short* outptr = top_blob->channel(q);
+
+        for (int i = 0; i < nn; i++)
+        {
+            __m256 fp32 = _mm256_loadu_ps(ptr);
+            __m128i fp16 = _mm256_cvtps_ph(fp32, _MM_FROUND_TRUNC);
+            _mm_store_si128((__m128i*)outptr, fp16);
+            ptr += 8;
+            outptr += 8;
+        }
+
+        if (remain > 0)
+        {
+            __m256 fp32 = _mm256_maskload_ps(ptr, mask.vec);
+            m128i fp16 = { _mm256_cvtps_ph(fp32, _MM_FROUND_TRUNC) };
+            memcpy(outptr, fp16.m128i_u16, remain * sizeof(unsigned short));
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int nn;
+    int remain;
+    m256i mask;
+};
+
+// one channel of Cast_x86::forward from fp16 to fp32
+class Cast_x86_fp16_to_fp32_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const unsigned short* ptr = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        for (int i = 0; i < nn; i++)
+        {
+            __m128i fp16 = _mm_lddqu_si128 ((__m128i const*)ptr);
+            __m256 fp32 = _mm256_cvtph_ps(fp16);
+            _mm256_storeu_ps(outptr, fp32);
+            ptr += 8;
+            outptr += 8;
+        }
+
+        if (remain > 0)
+        {
+            m128i fp16 = { _mm_setzero_si128() };
+            memcpy(fp16.m128i_u16, ptr, remain * sizeof(unsigned short));
+            __m256 fp32 = _mm256_cvtph_ps(fp16.vec);
+            _mm256_maskstore_ps(outptr, mask.vec, fp32);
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int nn;
+    int remain;
+    m256i mask;
+};
+#endif // __F16C__
+
+} // namespace
+
 int Cast_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
-#if NCNN_AVX2
+    if ((type_from == 1 && type_to == 4) || (type_from == 4 && type_to == 1))
+    {
+        return forward_bf16_x86(bottom_blob, top_blob, opt);
+    }
+
+#if __F16C__
     if (type_from == type_to)
     {
         top_blob = bottom_blob;
@@ -61,7 +145,7 @@ int Cast_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
     {
         if (type_from == 3)
         {
-            Cast::forward(bottom_blob, top_blob, opt);
+            return Cast::forward(bottom_blob, top_blob, opt);
         }
 
         // float32
@@ -103,28 +187,13 @@ int Cast_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
         for (int i = 0; i < remain; i++)
             mask.m256i_u32[i] = 0x80000000;
 
-        #pragma omp parallel for num_threads(opt.num_threads)
-        for (int q = 0; q < channels; q++)
-        {
-            const float* ptr = bottom_blob.channel(q);
-            unsigned short* outptr = top_blob.channel(q);
-
-            for (int i = 0; i < nn; i++)
-            {
-                __m256 fp32 = _mm256_loadu_ps(ptr);
-                __m128i fp16 = _mm256_cvtps_ph(fp32, _MM_FROUND_TRUNC);
-                _mm_store_si128((__m128i*)outptr, fp16);
-                ptr += 8;
-                outptr += 8;
-            }
-
-            if (remain > 0)
-            {
-                __m256 fp32 = _mm256_maskload_ps(ptr, mask.vec);
-                m128i fp16 = { _mm256_cvtps_ph(fp32, _MM_FROUND_TRUNC) };
-                memcpy(outptr, fp16.m128i_u16, remain * sizeof(unsigned short));
-            }
-        }
+        Cast_x86_fp32_to_fp16_task task;
+        task.bottom_blob = bottom_blob;
+        task.top_blob = &top_blob;
+        task.nn = nn;
+        task.remain = remain;
+        task.mask = mask;
+        parallel_for(opt, channels, task);
     }
 
     if (type_from == 2 && type_to == 1)
@@ -135,37 +204,131 @@ int Cast_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
         for (int i = 0; i < remain; i++)
             mask.m256i_u32[i] = 0x80000000;
 
-        #pragma omp parallel for num_threads(opt.num_threads)
-        for (int q = 0; q < channels; q++)
-        {
-            const unsigned short* ptr = bottom_blob.channel(q);
-            float* outptr = top_blob.channel(q);
-
-            for (int i = 0; i < nn; i++)
-            {
-                __m128i fp16 = _mm_lddqu_si128 ((__m128i const*)ptr);
-                __m256 fp32 = _mm256_cvtph_ps(fp16);
-                _mm256_storeu_ps(outptr, fp32);
-                ptr += 8;
-                outptr += 8;
-            }
-
-            if (remain > 0)
-            {
-                m128i fp16 = { _mm_setzero_si128() };
-                memcpy(fp16.m128i_u16, ptr, remain * sizeof(unsigned short));
-                __m256 fp32 = _mm256_cvtph_ps(fp16.vec);
-                _mm256_maskstore_ps(outptr, mask.vec, fp32);
-            }
-        }
+        Cast_x86_fp16_to_fp32_task task;
+        task.bottom_blob = bottom_blob;
+        task.top_blob = &top_blob;
+        task.nn = nn;
+        task.remain = remain;
+        task.mask = mask;
+        parallel_for(opt, channels, task);
     }
 
     return 0;
-#else //NCNN_AVX2
+#else // __F16C__
 
     return Cast::forward(bottom_blob, top_blob, opt);
 
-#endif //NCNN_AVX2
+#endif // __F16C__
+}
+
+namespace {
+
+// one channel of Cast_x86::forward_bf16_x86 from fp32
+class Cast_x86_fp32_to_bf16_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* ptr = bottom_blob.channel(q);
+        unsigned short* outptr = top_blob->channel(q);
+
+        int i = 0;
+#if __SSE2__
+        for (; i + 7 < size; i += 8)
+        {
+            // the arithmetic shift keeps the upper halves in int16 range so packs does not saturate
+            __m128i _p0 = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(ptr + i)), 16);
+            __m128i _p1 = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(ptr + i + 4)), 16);
+            _mm_storeu_si128((__m128i*)(outptr + i), _mm_packs_epi32(_p0, _p1));
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            outptr[i] = float32_to_bfloat16(ptr[i]);
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+
+// one channel of Cast_x86::forward_bf16_x86 to fp32
+class Cast_x86_bf16_to_fp32_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const unsigned short* ptr = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        int i = 0;
+#if __SSE2__
+        for (; i + 7 < size; i += 8)
+        {
+            __m128i _p = _mm_loadu_si128((const __m128i*)(ptr + i));
+            _mm_storeu_si128((__m128i*)(outptr + i), _mm_unpacklo_epi16(_mm_setzero_si128(), _p));
+            _mm_storeu_si128((__m128i*)(outptr + i + 4), _mm_unpackhi_epi16(_mm_setzero_si128(), _p));
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            outptr[i] = bfloat16_to_float32(ptr[i]);
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+
+} // namespace
+
+int Cast_x86::forward_bf16_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int dims = bottom_blob.dims;
+    int elempack = bottom_blob.elempack;
+
+    size_t out_elemsize = (type_to == 4 ? 2 : 4) * elempack;
+
+    if (dims == 1)
+    {
+        top_blob.create(w, out_elemsize, elempack, opt.blob_allocator);
+    }
+    else if (dims == 2)
+    {
+        top_blob.create(w, h, out_elemsize, elempack, opt.blob_allocator);
+    }
+    else if (dims == 3)
+    {
+        top_blob.create(w, h, channels, out_elemsize, elempack, opt.blob_allocator);
+    }
+    if (top_blob.empty())
+        return -100;
+
+    int size = w * h * elempack;
+
+    if (type_from == 1)
+    {
+        Cast_x86_fp32_to_bf16_task task;
+        task.bottom_blob = bottom_blob;
+        task.top_blob = &top_blob;
+        task.size = size;
+        parallel_for(opt, channels, task);
+    }
+    else
+    {
+        Cast_x86_bf16_to_fp32_task task;
+        task.bottom_blob = bottom_blob;
+        task.top_blob = &top_blob;
+        task.size = size;
+        parallel_for(opt, channels, task);
+    }
+
+    return 0;
 }
 
 } // namespace ncnn
@@ -0,0 +1,120 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "clip_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(Clip_x86)
+
+Clip_x86::Clip_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+#endif // __SSE2__
+}
+
+namespace {
+
+// one channel of Clip_x86::forward_inplace
+class Clip_x86_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = bottom_top_blob->channel(q);
+
+        int i = 0;
+#if __AVX__
+        __m256 _min_avx = _mm256_set1_ps(min);
+        __m256 _max_avx = _mm256_set1_ps(max);
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr);
+            _p = _mm256_max_ps(_p, _min_avx);
+            _p = _mm256_min_ps(_p, _max_avx);
+            _mm256_storeu_ps(ptr, _p);
+
+            ptr += 8;
+        }
+#endif // __AVX__
+#if __SSE2__
+        __m128 _min = _mm_set1_ps(min);
+        __m128 _max = _mm_set1_ps(max);
+        for (; i + 3 < size; i += 4)
+        {
+            __m128 _p = _mm_loadu_ps(ptr);
+            _p = _mm_max_ps(_p, _min);
+            _p = _mm_min_ps(_p, _max);
+            _mm_storeu_ps(ptr, _p);
+
+            ptr += 4;
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            if (*ptr < min)
+                *ptr = min;
+            if (*ptr > max)
+                *ptr = max;
+
+            ptr++;
+        }
+    }
+
+    Mat* bottom_top_blob;
+    int size;
+    float min;
+    float max;
+};
+
+} // namespace
+
+int Clip_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int channels = bottom_top_blob.c;
+    int elempack = bottom_top_blob.elempack;
+    int size = w * h * elempack;
+
+    Clip_x86_task task;
+    task.bottom_top_blob = &bottom_top_blob;
+    task.size = size;
+    task.min = min;
+    task.max = max;
+    parallel_for(opt, channels, task);
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -12,21 +12,15 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
-static void conv1x1s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
-{
-    int inch = bottom_blob.c;
-
-    int outw = top_blob.w;
-    int outh = top_blob.h;
-    int outch = top_blob.c;
-
-    const float* kernel = _kernel;
-    const float* bias = _bias;
+namespace {
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int p=0; p<outch; p++)
+// one output channel of conv1x1s1_sse
+class conv1x1s1_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
 
         const float bias0 = bias ? bias[p] : 0.f;
 
@@ -104,26 +98,49 @@ static void conv1x1s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _ker
         }
     }
 
-}
+    Mat bottom_blob;
+    Mat* top_blob;
+    int inch;
+    int outw;
+    int outh;
+    const float* kernel;
+    const float* bias;
+};
 
-static void conv1x1s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+} // namespace
+
+static void conv1x1s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
 {
-    int w = bottom_blob.w;
     int inch = bottom_blob.c;
 
     int outw = top_blob.w;
     int outh = top_blob.h;
     int outch = top_blob.c;
 
-    const int tailstep = w - 2*outw + w;
-
     const float* kernel = _kernel;
     const float* bias = _bias;
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int p=0; p<outch; p++)
+    conv1x1s1_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.inch = inch;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
+
+}
+
+namespace {
+
+// one output channel of conv1x1s2_sse
+class conv1x1s2_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
 
         const float bias0 = bias ? bias[p] : 0.f;
 
@@ -210,4 +227,41 @@ static void conv1x1s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _ker
         }
     }
 
+    Mat bottom_blob;
+    Mat* top_blob;
+    int inch;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void conv1x1s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    const int tailstep = w - 2*outw + w;
+
+    const float* kernel = _kernel;
+    const float* bias = _bias;
+
+    conv1x1s2_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.inch = inch;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
+
 }
@@ -12,20 +12,15 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
-static void conv1x1s1_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option& opt)
-{
-    int inch = bottom_blob.c;
-
-    int outw = top_blob.w;
-    int outh = top_blob.h;
-    int outch = top_blob.c;
+namespace {
 
-    const float *kernel = _kernel;
-
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+// one output channel of conv1x1s1_int8_sse
+class conv1x1s1_int8_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out0 = top_blob.channel(p);
+        Mat out0 = top_blob->channel(p);
 
         out0.fill(0);
 
@@ -94,24 +89,46 @@ static void conv1x1s1_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat
             }
         }
     }
-}
 
-static void conv1x1s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option& opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    int inch;
+    int outw;
+    int outh;
+    const float* kernel;
+};
+
+} // namespace
+
+static void conv1x1s1_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option& opt)
 {
-    int w = bottom_blob.w;
     int inch = bottom_blob.c;
 
     int outw = top_blob.w;
     int outh = top_blob.h;
     int outch = top_blob.c;
 
-    const int tailstep = w - 2*outw + w;
-    const signed char *kernel = _kernel;
+    const float *kernel = _kernel;
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+    conv1x1s1_int8_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.inch = inch;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    parallel_for(opt, outch, task);
+}
+
+namespace {
+
+// one output channel of conv1x1s2_int8_sse
+class conv1x1s2_int8_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out0 = top_blob.channel(p);
+        Mat out0 = top_blob->channel(p);
 
         out0.fill(0);
 
@@ -195,4 +212,37 @@ static void conv1x1s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat
             }
         }
     }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int inch;
+    int outw;
+    int outh;
+    int tailstep;
+    const signed char* kernel;
+};
+
+} // namespace
+
+static void conv1x1s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    const int tailstep = w - 2*outw + w;
+    const signed char *kernel = _kernel;
+
+    conv1x1s2_int8_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.inch = inch;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    parallel_for(opt, outch, task);
 }
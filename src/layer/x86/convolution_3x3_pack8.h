@@ -0,0 +1,622 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+static void conv3x3s1_winograd43_transform_kernel_pack8_avx(const Mat& kernel, Mat& kernel_tm_pack8, int inch, int outch, Allocator* allocator)
+{
+    // G
+    const float ktm[6][3] = {
+        {1.0f / 4, 0.0f, 0.0f},
+        {-1.0f / 6, -1.0f / 6, -1.0f / 6},
+        {-1.0f / 6, 1.0f / 6, -1.0f / 6},
+        {1.0f / 24, 1.0f / 12, 1.0f / 6},
+        {1.0f / 24, -1.0f / 12, 1.0f / 6},
+        {0.0f, 0.0f, 1.0f}
+    };
+
+    convolution_winograd_transform_kernel_x86(kernel, kernel_tm_pack8, inch, outch, ktm[0], 6, allocator);
+}
+
+static void conv3x3s1_winograd63_transform_kernel_pack8_avx(const Mat& kernel, Mat& kernel_tm_pack8, int inch, int outch, Allocator* allocator)
+{
+    // G
+    const float ktm[8][3] = {
+        {1.0f, 0.0f, 0.0f},
+        {-2.0f / 9, -2.0f / 9, -2.0f / 9},
+        {-2.0f / 9, 2.0f / 9, -2.0f / 9},
+        {1.0f / 90, 1.0f / 45, 2.0f / 45},
+        {1.0f / 90, -1.0f / 45, 2.0f / 45},
+        {1.0f / 45, 1.0f / 90, 1.0f / 180},
+        {1.0f / 45, -1.0f / 90, 1.0f / 180},
+        {0.0f, 0.0f, 1.0f}
+    };
+
+    convolution_winograd_transform_kernel_x86(kernel, kernel_tm_pack8, inch, outch, ktm[0], 8, allocator);
+}
+
+namespace {
+
+// one output channel of conv3x3s1_winograd43_pack8_avx
+class conv3x3s1_winograd43_pack8_avx_task_0 : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat img = bottom_blob_bordered->channel(q);
+        Mat img_tm = bottom_blob_tm->channel(q);
+
+        const __m256 _4 = _mm256_set1_ps(4.f);
+        const __m256 _n5 = _mm256_set1_ps(-5.f);
+        const __m256 _n4 = _mm256_set1_ps(-4.f);
+        const __m256 _2 = _mm256_set1_ps(2.f);
+
+        for (int i=0; i<tiles_h; i++)
+        {
+            for (int j=0; j<tiles_w; j++)
+            {
+                __m256 _tmp[6][6];
+
+                for (int m=0; m<6; m++)
+                {
+                    const float* r0 = img.row(i * 4 + m) + j * 4 * 8;
+
+                    __m256 _r00 = _mm256_loadu_ps(r0);
+                    __m256 _r01 = _mm256_loadu_ps(r0 + 8);
+                    __m256 _r02 = _mm256_loadu_ps(r0 + 16);
+                    __m256 _r03 = _mm256_loadu_ps(r0 + 24);
+                    __m256 _r04 = _mm256_loadu_ps(r0 + 32);
+                    __m256 _r05 = _mm256_loadu_ps(r0 + 40);
+
+                    __m256 _tmp12a = _mm256_comp_fmadd_ps(_n4, _r01, _r03);
+                    __m256 _tmp12b = _mm256_comp_fmadd_ps(_n4, _r02, _r04);
+                    __m256 _tmp34a = _mm256_mul_ps(_2, _mm256_sub_ps(_r03, _r01));
+                    __m256 _tmp34b = _mm256_sub_ps(_r04, _r02);
+
+                    _tmp[0][m] = _mm256_comp_fmadd_ps(_n5, _r02, _mm256_comp_fmadd_ps(_4, _r00, _r04));
+                    _tmp[1][m] = _mm256_add_ps(_tmp12b, _tmp12a);
+                    _tmp[2][m] = _mm256_sub_ps(_tmp12b, _tmp12a);
+                    _tmp[3][m] = _mm256_add_ps(_tmp34b, _tmp34a);
+                    _tmp[4][m] = _mm256_sub_ps(_tmp34b, _tmp34a);
+                    _tmp[5][m] = _mm256_comp_fmadd_ps(_n5, _r03, _mm256_comp_fmadd_ps(_4, _r01, _r05));
+                }
+
+                const int tile = i * tiles_w + j;
+
+                for (int m=0; m<6; m++)
+                {
+                    __m256 _tmp00 = _tmp[m][0];
+                    __m256 _tmp01 = _tmp[m][1];
+                    __m256 _tmp02 = _tmp[m][2];
+                    __m256 _tmp03 = _tmp[m][3];
+                    __m256 _tmp04 = _tmp[m][4];
+                    __m256 _tmp05 = _tmp[m][5];
+
+                    __m256 _tmp12a = _mm256_comp_fmadd_ps(_n4, _tmp01, _tmp03);
+                    __m256 _tmp12b = _mm256_comp_fmadd_ps(_n4, _tmp02, _tmp04);
+                    __m256 _tmp34a = _mm256_mul_ps(_2, _mm256_sub_ps(_tmp03, _tmp01));
+                    __m256 _tmp34b = _mm256_sub_ps(_tmp04, _tmp02);
+
+                    _mm256_storeu_ps(img_tm.row(0 * 6 + m) + tile * 8, _mm256_comp_fmadd_ps(_n5, _tmp02, _mm256_comp_fmadd_ps(_4, _tmp00, _tmp04)));
+                    _mm256_storeu_ps(img_tm.row(1 * 6 + m) + tile * 8, _mm256_add_ps(_tmp12b, _tmp12a));
+                    _mm256_storeu_ps(img_tm.row(2 * 6 + m) + tile * 8, _mm256_sub_ps(_tmp12b, _tmp12a));
+                    _mm256_storeu_ps(img_tm.row(3 * 6 + m) + tile * 8, _mm256_add_ps(_tmp34b, _tmp34a));
+                    _mm256_storeu_ps(img_tm.row(4 * 6 + m) + tile * 8, _mm256_sub_ps(_tmp34b, _tmp34a));
+                    _mm256_storeu_ps(img_tm.row(5 * 6 + m) + tile * 8, _mm256_comp_fmadd_ps(_n5, _tmp03, _mm256_comp_fmadd_ps(_4, _tmp01, _tmp05)));
+                }
+            }
+        }
+    }
+
+    Mat* bottom_blob_bordered;
+    int tiles_w;
+    int tiles_h;
+    Mat* bottom_blob_tm;
+};
+
+// one output channel of conv3x3s1_winograd43_pack8_avx
+class conv3x3s1_winograd43_pack8_avx_task_1 : public ParallelTask
+{
+public:
+    void operator()(int p) const
+    {
+        const Mat out0_tm = top_blob_tm->channel(p);
+        Mat out0 = top_blob->channel(p);
+
+        __m256 _bias0 = bias ? _mm256_loadu_ps(bias + p * 8) : _mm256_setzero_ps();
+
+        const __m256 _2 = _mm256_set1_ps(2.f);
+        const __m256 _4 = _mm256_set1_ps(4.f);
+        const __m256 _8 = _mm256_set1_ps(8.f);
+
+        for (int i=0; i<tiles_h; i++)
+        {
+            for (int j=0; j<tiles_w; j++)
+            {
+                const int tile = i * tiles_w + j;
+
+                __m256 _tmp[4][6];
+
+                for (int m=0; m<6; m++)
+                {
+                    __m256 _r00 = _mm256_loadu_ps(out0_tm.row(0 * 6 + m) + tile * 8);
+                    __m256 _r01 = _mm256_loadu_ps(out0_tm.row(1 * 6 + m) + tile * 8);
+                    __m256 _r02 = _mm256_loadu_ps(out0_tm.row(2 * 6 + m) + tile * 8);
+                    __m256 _r03 = _mm256_loadu_ps(out0_tm.row(3 * 6 + m) + tile * 8);
+                    __m256 _r04 = _mm256_loadu_ps(out0_tm.row(4 * 6 + m) + tile * 8);
+                    __m256 _r05 = _mm256_loadu_ps(out0_tm.row(5 * 6 + m) + tile * 8);
+
+                    __m256 _tmp02a = _mm256_add_ps(_r01, _r02);
+                    __m256 _tmp13a = _mm256_sub_ps(_r01, _r02);
+                    __m256 _tmp02b = _mm256_add_ps(_r03, _r04);
+                    __m256 _tmp13b = _mm256_sub_ps(_r03, _r04);
+
+                    _tmp[0][m] = _mm256_add_ps(_mm256_add_ps(_r00, _tmp02a), _tmp02b);
+                    _tmp[1][m] = _mm256_comp_fmadd_ps(_2, _tmp13b, _tmp13a);
+                    _tmp[2][m] = _mm256_comp_fmadd_ps(_4, _tmp02b, _tmp02a);
+                    _tmp[3][m] = _mm256_comp_fmadd_ps(_8, _tmp13b, _mm256_add_ps(_r05, _tmp13a));
+                }
+
+                for (int m=0; m<4; m++)
+                {
+                    int y = i * 4 + m;
+                    if (y >= outh)
+                        break;
+
+                    __m256 _tmp00 = _tmp[m][0];
+                    __m256 _tmp01 = _tmp[m][1];
+                    __m256 _tmp02 = _tmp[m][2];
+                    __m256 _tmp03 = _tmp[m][3];
+                    __m256 _tmp04 = _tmp[m][4];
+                    __m256 _tmp05 = _tmp[m][5];
+
+                    __m256 _tmp02a = _mm256_add_ps(_tmp01, _tmp02);
+                    __m256 _tmp13a = _mm256_sub_ps(_tmp01, _tmp02);
+                    __m256 _tmp02b = _mm256_add_ps(_tmp03, _tmp04);
+                    __m256 _tmp13b = _mm256_sub_ps(_tmp03, _tmp04);
+
+                    __m256 _out[4];
+                    _out[0] = _mm256_add_ps(_bias0, _mm256_add_ps(_mm256_add_ps(_tmp00, _tmp02a), _tmp02b));
+                    _out[1] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_2, _tmp13b, _tmp13a));
+                    _out[2] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_4, _tmp02b, _tmp02a));
+                    _out[3] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_8, _tmp13b, _mm256_add_ps(_tmp05, _tmp13a)));
+
+                    float* outptr = out0.row(y) + j * 4 * 8;
+
+                    for (int n=0; n<4 && j * 4 + n < outw; n++)
+                    {
+                        _mm256_storeu_ps(outptr + n * 8, _out[n]);
+                    }
+                }
+            }
+        }
+    }
+
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int tiles_w;
+    int tiles_h;
+    Mat* top_blob_tm;
+    const float* bias;
+};
+
+} // namespace
+
+static int conv3x3s1_winograd43_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int inch = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    // pad to 4n+2
+    Mat bottom_blob_bordered = bottom_blob;
+
+    int outw_pad = (outw + 3) / 4 * 4;
+    int outh_pad = (outh + 3) / 4 * 4;
+
+    w = outw_pad + 2;
+    h = outh_pad + 2;
+    if (w != bottom_blob.w || h != bottom_blob.h)
+    {
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        copy_make_border(bottom_blob, bottom_blob_bordered, 0, h - bottom_blob.h, 0, w - bottom_blob.w, BORDER_CONSTANT, 0.f, opt_b);
+    }
+
+    const int tiles_w = outw_pad / 4;
+    const int tiles_h = outh_pad / 4;
+    const int tiles = tiles_w * tiles_h;
+
+    // BEGIN transform input
+    Mat bottom_blob_tm(tiles, 36, inch, elemsize, elempack, opt.workspace_allocator);
+    {
+        // BT
+        // const float itm[6][6] = {
+        //     {4.0f,  0.0f, -5.0f,  0.0f, 1.0f, 0.0f},
+        //     {0.0f, -4.0f, -4.0f,  1.0f, 1.0f, 0.0f},
+        //     {0.0f,  4.0f, -4.0f, -1.0f, 1.0f, 0.0f},
+        //     {0.0f, -2.0f, -1.0f,  2.0f, 1.0f, 0.0f},
+        //     {0.0f,  2.0f, -1.0f, -2.0f, 1.0f, 0.0f},
+        //     {0.0f,  4.0f,  0.0f, -5.0f, 0.0f, 1.0f}
+        // };
+
+        // 0 = 4 * r00 - 5 * r02 + r04
+        // 1 = -4 * (r01 + r02) + r04 + r03
+        // 2 = 4 * (r01 - r02) + r04 - r03
+        // 3 = -2 * (r01 - r03) + r04 - r02
+        // 4 = 2 * (r01 - r03) + r04 - r02
+        // 5 = 4 * r01 - 5 * r03 + r05
+
+        conv3x3s1_winograd43_pack8_avx_task_0 task;
+        task.bottom_blob_bordered = &bottom_blob_bordered;
+        task.tiles_w = tiles_w;
+        task.tiles_h = tiles_h;
+        task.bottom_blob_tm = &bottom_blob_tm;
+        parallel_for(opt, inch, task);
+    }
+    bottom_blob_bordered = Mat();
+    // END transform input
+
+    // BEGIN dot
+    Mat top_blob_tm;
+    int ret = convolution_winograd_dot_x86(bottom_blob_tm, outch * 8, kernel_tm, top_blob_tm, opt);
+    if (ret != 0)
+        return ret;
+    // END dot
+
+    // BEGIN transform output
+    {
+        // AT
+        // const float itm[4][6] = {
+        //     {1.0f, 1.0f,  1.0f, 1.0f,  1.0f, 0.0f},
+        //     {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f},
+        //     {0.0f, 1.0f,  1.0f, 4.0f,  4.0f, 0.0f},
+        //     {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f}
+        // };
+
+        // 0 = r00 + (r01 + r02) + (r03 + r04)
+        // 1 =       (r01 - r02) + (r03 - r04) * 2
+        // 2 =       (r01 + r02) + (r03 + r04) * 4
+        // 3 = r05 + (r01 - r02) + (r03 - r04) * 8
+
+        const float* bias = _bias;
+
+        conv3x3s1_winograd43_pack8_avx_task_1 task;
+        task.top_blob = &top_blob;
+        task.outw = outw;
+        task.outh = outh;
+        task.tiles_w = tiles_w;
+        task.tiles_h = tiles_h;
+        task.top_blob_tm = &top_blob_tm;
+        task.bias = bias;
+        parallel_for(opt, outch, task);
+    }
+    // END transform output
+
+    return 0;
+}
+
+namespace {
+
+// one output channel of conv3x3s1_winograd63_pack8_avx
+class conv3x3s1_winograd63_pack8_avx_task_0 : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat img = bottom_blob_bordered->channel(q);
+        Mat img_tm = bottom_blob_tm->channel(q);
+
+        const __m256 _5_25 = _mm256_set1_ps(5.25f);
+        const __m256 _n4_25 = _mm256_set1_ps(-4.25f);
+        const __m256 _n1_25 = _mm256_set1_ps(-1.25f);
+        const __m256 _0_25 = _mm256_set1_ps(0.25f);
+        const __m256 _n2_5 = _mm256_set1_ps(-2.5f);
+        const __m256 _0_5 = _mm256_set1_ps(0.5f);
+        const __m256 _2 = _mm256_set1_ps(2.f);
+        const __m256 _4 = _mm256_set1_ps(4.f);
+
+        for (int i=0; i<tiles_h; i++)
+        {
+            for (int j=0; j<tiles_w; j++)
+            {
+                __m256 _tmp[8][8];
+
+                for (int m=0; m<8; m++)
+                {
+                    const float* r0 = img.row(i * 6 + m) + j * 6 * 8;
+
+                    __m256 _r00 = _mm256_loadu_ps(r0);
+                    __m256 _r01 = _mm256_loadu_ps(r0 + 8);
+                    __m256 _r02 = _mm256_loadu_ps(r0 + 16);
+                    __m256 _r03 = _mm256_loadu_ps(r0 + 24);
+                    __m256 _r04 = _mm256_loadu_ps(r0 + 32);
+                    __m256 _r05 = _mm256_loadu_ps(r0 + 40);
+                    __m256 _r06 = _mm256_loadu_ps(r0 + 48);
+                    __m256 _r07 = _mm256_loadu_ps(r0 + 56);
+
+                    __m256 _tmp12a = _mm256_comp_fmadd_ps(_n4_25, _r04, _mm256_add_ps(_r02, _r06));
+                    __m256 _tmp12b = _mm256_comp_fmadd_ps(_n4_25, _r03, _mm256_add_ps(_r01, _r05));
+                    __m256 _tmp34a = _mm256_comp_fmadd_ps(_n1_25, _r04, _mm256_comp_fmadd_ps(_0_25, _r02, _r06));
+                    __m256 _tmp34b = _mm256_comp_fmadd_ps(_2, _r05, _mm256_comp_fmadd_ps(_n2_5, _r03, _mm256_mul_ps(_r01, _0_5)));
+                    __m256 _tmp56a = _mm256_comp_fmadd_ps(_4, _mm256_comp_fmadd_ps(_n1_25, _r04, _r02), _r06);
+                    __m256 _tmp56b = _mm256_comp_fmadd_ps(_0_5, _r05, _mm256_comp_fmadd_ps(_n2_5, _r03, _mm256_mul_ps(_r01, _2)));
+
+                    _tmp[0][m] = _mm256_comp_fmadd_ps(_5_25, _mm256_sub_ps(_r04, _r02), _mm256_sub_ps(_r00, _r06));
+                    _tmp[7][m] = _mm256_comp_fmadd_ps(_5_25, _mm256_sub_ps(_r03, _r05), _mm256_sub_ps(_r07, _r01));
+                    _tmp[1][m] = _mm256_add_ps(_tmp12a, _tmp12b);
+                    _tmp[2][m] = _mm256_sub_ps(_tmp12a, _tmp12b);
+                    _tmp[3][m] = _mm256_add_ps(_tmp34a, _tmp34b);
+                    _tmp[4][m] = _mm256_sub_ps(_tmp34a, _tmp34b);
+                    _tmp[5][m] = _mm256_add_ps(_tmp56a, _tmp56b);
+                    _tmp[6][m] = _mm256_sub_ps(_tmp56a, _tmp56b);
+                }
+
+                const int tile = i * tiles_w + j;
+
+                for (int m=0; m<8; m++)
+                {
+                    __m256 _tmp00 = _tmp[m][0];
+                    __m256 _tmp01 = _tmp[m][1];
+                    __m256 _tmp02 = _tmp[m][2];
+                    __m256 _tmp03 = _tmp[m][3];
+                    __m256 _tmp04 = _tmp[m][4];
+                    __m256 _tmp05 = _tmp[m][5];
+                    __m256 _tmp06 = _tmp[m][6];
+                    __m256 _tmp07 = _tmp[m][7];
+
+                    __m256 _tmp12a = _mm256_comp_fmadd_ps(_n4_25, _tmp04, _mm256_add_ps(_tmp02, _tmp06));
+                    __m256 _tmp12b = _mm256_comp_fmadd_ps(_n4_25, _tmp03, _mm256_add_ps(_tmp01, _tmp05));
+                    __m256 _tmp34a = _mm256_comp_fmadd_ps(_n1_25, _tmp04, _mm256_comp_fmadd_ps(_0_25, _tmp02, _tmp06));
+                    __m256 _tmp34b = _mm256_comp_fmadd_ps(_2, _tmp05, _mm256_comp_fmadd_ps(_n2_5, _tmp03, _mm256_mul_ps(_tmp01, _0_5)));
+                    __m256 _tmp56a = _mm256_comp_fmadd_ps(_4, _mm256_comp_fmadd_ps(_n1_25, _tmp04, _tmp02), _tmp06);
+                    __m256 _tmp56b = _mm256_comp_fmadd_ps(_0_5, _tmp05, _mm256_comp_fmadd_ps(_n2_5, _tmp03, _mm256_mul_ps(_tmp01, _2)));
+
+                    _mm256_storeu_ps(img_tm.row(0 * 8 + m) + tile * 8, _mm256_comp_fmadd_ps(_5_25, _mm256_sub_ps(_tmp04, _tmp02), _mm256_sub_ps(_tmp00, _tmp06)));
+                    _mm256_storeu_ps(img_tm.row(1 * 8 + m) + tile * 8, _mm256_add_ps(_tmp12a, _tmp12b));
+                    _mm256_storeu_ps(img_tm.row(2 * 8 + m) + tile * 8, _mm256_sub_ps(_tmp12a, _tmp12b));
+                    _mm256_storeu_ps(img_tm.row(3 * 8 + m) + tile * 8, _mm256_add_ps(_tmp34a, _tmp34b));
+                    _mm256_storeu_ps(img_tm.row(4 * 8 + m) + tile * 8, _mm256_sub_ps(_tmp34a, _tmp34b));
+                    _mm256_storeu_ps(img_tm.row(5 * 8 + m) + tile * 8, _mm256_add_ps(_tmp56a, _tmp56b));
+                    _mm256_storeu_ps(img_tm.row(6 * 8 + m) + tile * 8, _mm256_sub_ps(_tmp56a, _tmp56b));
+                    _mm256_storeu_ps(img_tm.row(7 * 8 + m) + tile * 8, _mm256_comp_fmadd_ps(_5_25, _mm256_sub_ps(_tmp03, _tmp05), _mm256_sub_ps(_tmp07, _tmp01)));
+                }
+            }
+        }
+    }
+
+    Mat* bottom_blob_bordered;
+    int tiles_w;
+    int tiles_h;
+    Mat* bottom_blob_tm;
+};
+
+// one output channel of conv3x3s1_winograd63_pack8_avx
+class conv3x3s1_winograd63_pack8_avx_task_1 : public ParallelTask
+{
+public:
+    void operator()(int p) const
+    {
+        const Mat out0_tm = top_blob_tm->channel(p);
+        Mat out0 = top_blob->channel(p);
+
+        __m256 _bias0 = bias ? _mm256_loadu_ps(bias + p * 8) : _mm256_setzero_ps();
+
+        const __m256 _2 = _mm256_set1_ps(2.f);
+        const __m256 _4 = _mm256_set1_ps(4.f);
+        const __m256 _8 = _mm256_set1_ps(8.f);
+        const __m256 _16 = _mm256_set1_ps(16.f);
+        const __m256 _32 = _mm256_set1_ps(32.f);
+
+        for (int i=0; i<tiles_h; i++)
+        {
+            for (int j=0; j<tiles_w; j++)
+            {
+                const int tile = i * tiles_w + j;
+
+                __m256 _tmp[6][8];
+
+                for (int m=0; m<8; m++)
+                {
+                    __m256 _r00 = _mm256_loadu_ps(out0_tm.row(0 * 8 + m) + tile * 8);
+                    __m256 _r01 = _mm256_loadu_ps(out0_tm.row(1 * 8 + m) + tile * 8);
+                    __m256 _r02 = _mm256_loadu_ps(out0_tm.row(2 * 8 + m) + tile * 8);
+                    __m256 _r03 = _mm256_loadu_ps(out0_tm.row(3 * 8 + m) + tile * 8);
+                    __m256 _r04 = _mm256_loadu_ps(out0_tm.row(4 * 8 + m) + tile * 8);
+                    __m256 _r05 = _mm256_loadu_ps(out0_tm.row(5 * 8 + m) + tile * 8);
+                    __m256 _r06 = _mm256_loadu_ps(out0_tm.row(6 * 8 + m) + tile * 8);
+                    __m256 _r07 = _mm256_loadu_ps(out0_tm.row(7 * 8 + m) + tile * 8);
+
+                    __m256 _tmp024a = _mm256_add_ps(_r01, _r02);
+                    __m256 _tmp135a = _mm256_sub_ps(_r01, _r02);
+                    __m256 _tmp024b = _mm256_add_ps(_r03, _r04);
+                    __m256 _tmp135b = _mm256_sub_ps(_r03, _r04);
+                    __m256 _tmp024c = _mm256_add_ps(_r05, _r06);
+                    __m256 _tmp135c = _mm256_sub_ps(_r05, _r06);
+
+                    _tmp[0][m] = _mm256_comp_fmadd_ps(_32, _tmp024c, _mm256_add_ps(_mm256_add_ps(_r00, _tmp024a), _tmp024b));
+                    _tmp[2][m] = _mm256_comp_fmadd_ps(_8, _tmp024c, _mm256_comp_fmadd_ps(_4, _tmp024b, _tmp024a));
+                    _tmp[4][m] = _mm256_comp_fmadd_ps(_2, _tmp024c, _mm256_comp_fmadd_ps(_16, _tmp024b, _tmp024a));
+                    _tmp[1][m] = _mm256_comp_fmadd_ps(_16, _tmp135c, _mm256_comp_fmadd_ps(_2, _tmp135b, _tmp135a));
+                    _tmp[3][m] = _mm256_comp_fmadd_ps(_4, _tmp135c, _mm256_comp_fmadd_ps(_8, _tmp135b, _tmp135a));
+                    _tmp[5][m] = _mm256_add_ps(_mm256_add_ps(_r07, _tmp135a), _mm256_comp_fmadd_ps(_32, _tmp135b, _tmp135c));
+                }
+
+                for (int m=0; m<6; m++)
+                {
+                    int y = i * 6 + m;
+                    if (y >= outh)
+                        break;
+
+                    __m256 _tmp00 = _tmp[m][0];
+                    __m256 _tmp01 = _tmp[m][1];
+                    __m256 _tmp02 = _tmp[m][2];
+                    __m256 _tmp03 = _tmp[m][3];
+                    __m256 _tmp04 = _tmp[m][4];
+                    __m256 _tmp05 = _tmp[m][5];
+                    __m256 _tmp06 = _tmp[m][6];
+                    __m256 _tmp07 = _tmp[m][7];
+
+                    __m256 _tmp024a = _mm256_add_ps(_tmp01, _tmp02);
+                    __m256 _tmp135a = _mm256_sub_ps(_tmp01, _tmp02);
+                    __m256 _tmp024b = _mm256_add_ps(_tmp03, _tmp04);
+                    __m256 _tmp135b = _mm256_sub_ps(_tmp03, _tmp04);
+                    __m256 _tmp024c = _mm256_add_ps(_tmp05, _tmp06);
+                    __m256 _tmp135c = _mm256_sub_ps(_tmp05, _tmp06);
+
+                    __m256 _out[6];
+                    _out[0] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_32, _tmp024c, _mm256_add_ps(_mm256_add_ps(_tmp00, _tmp024a), _tmp024b)));
+                    _out[2] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_8, _tmp024c, _mm256_comp_fmadd_ps(_4, _tmp024b, _tmp024a)));
+                    _out[4] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_2, _tmp024c, _mm256_comp_fmadd_ps(_16, _tmp024b, _tmp024a)));
+                    _out[1] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_16, _tmp135c, _mm256_comp_fmadd_ps(_2, _tmp135b, _tmp135a)));
+                    _out[3] = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_4, _tmp135c, _mm256_comp_fmadd_ps(_8, _tmp135b, _tmp135a)));
+                    _out[5] = _mm256_add_ps(_bias0, _mm256_add_ps(_mm256_add_ps(_tmp07, _tmp135a), _mm256_comp_fmadd_ps(_32, _tmp135b, _tmp135c)));
+
+                    float* outptr = out0.row(y) + j * 6 * 8;
+
+                    for (int n=0; n<6 && j * 6 + n < outw; n++)
+                    {
+                        _mm256_storeu_ps(outptr + n * 8, _out[n]);
+                    }
+                }
+            }
+        }
+    }
+
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int tiles_w;
+    int tiles_h;
+    Mat* top_blob_tm;
+    const float* bias;
+};
+
+} // namespace
+
+static int conv3x3s1_winograd63_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int inch = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    // pad to 6n+2
+    Mat bottom_blob_bordered = bottom_blob;
+
+    int outw_pad = (outw + 5) / 6 * 6;
+    int outh_pad = (outh + 5) / 6 * 6;
+
+    w = outw_pad + 2;
+    h = outh_pad + 2;
+    if (w != bottom_blob.w || h != bottom_blob.h)
+    {
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        copy_make_border(bottom_blob, bottom_blob_bordered, 0, h - bottom_blob.h, 0, w - bottom_blob.w, BORDER_CONSTANT, 0.f, opt_b);
+    }
+
+    const int tiles_w = outw_pad / 6;
+    const int tiles_h = outh_pad / 6;
+    const int tiles = tiles_w * tiles_h;
+
+    // BEGIN transform input
+    Mat bottom_blob_tm(tiles, 64, inch, elemsize, elempack, opt.workspace_allocator);
+    {
+        // BT
+        // const float itm[8][8] = {
+        //     {1.0f,  0.0f, -5.25f,  0.00f,  5.25f,  0.00f, -1.0f, 0.0f},
+        //     {0.0f,  1.0f,  1.00f, -4.25f, -4.25f,  1.00f,  1.0f, 0.0f},
+        //     {0.0f, -1.0f,  1.00f,  4.25f, -4.25f, -1.00f,  1.0f, 0.0f},
+        //     {0.0f,  0.5f,  0.25f, -2.50f, -1.25f,  2.00f,  1.0f, 0.0f},
+        //     {0.0f, -0.5f,  0.25f,  2.50f, -1.25f, -2.00f,  1.0f, 0.0f},
+        //     {0.0f,  2.0f,  4.00f, -2.50f, -5.00f,  0.50f,  1.0f, 0.0f},
+        //     {0.0f, -2.0f,  4.00f,  2.50f, -5.00f, -0.50f,  1.0f, 0.0f},
+        //     {0.0f, -1.0f,  0.00f,  5.25f,  0.00f, -5.25f,  0.0f, 1.0f}
+        // };
+
+        // 0 = r00 - r06 + (r04 - r02) * 5.25
+        // 7 = r07 - r01 + (r03 - r05) * 5.25
+
+        // 1 = (r02 + r06 - r04 * 4.25) + (r01 - r03 * 4.25 + r05)
+        // 2 = (r02 + r06 - r04 * 4.25) - (r01 - r03 * 4.25 + r05)
+
+        // 3 = (r06 + r02 * 0.25 - r04 * 1.25) + (r01 * 0.5 - r03 * 2.5 + r05 * 2)
+        // 4 = (r06 + r02 * 0.25 - r04 * 1.25) - (r01 * 0.5 - r03 * 2.5 + r05 * 2)
+
+        // 5 = (r06 + (r02 - r04 * 1.25) * 4) + (r01 * 2 - r03 * 2.5 + r05 * 0.5)
+        // 6 = (r06 + (r02 - r04 * 1.25) * 4) - (r01 * 2 - r03 * 2.5 + r05 * 0.5)
+
+        conv3x3s1_winograd63_pack8_avx_task_0 task;
+        task.bottom_blob_bordered = &bottom_blob_bordered;
+        task.tiles_w = tiles_w;
+        task.tiles_h = tiles_h;
+        task.bottom_blob_tm = &bottom_blob_tm;
+        parallel_for(opt, inch, task);
+    }
+    bottom_blob_bordered = Mat();
+    // END transform input
+
+    // BEGIN dot
+    Mat top_blob_tm;
+    int ret = convolution_winograd_dot_x86(bottom_blob_tm, outch * 8, kernel_tm, top_blob_tm, opt);
+    if (ret != 0)
+        return ret;
+    // END dot
+
+    // BEGIN transform output
+    {
+        // AT
+        // const float itm[6][8] = {
+        //     {1.0f,  1.0f,  1.0f,  1.0f,  1.0f, 32.0f, 32.0f, 0.0f},
+        //     {0.0f,  1.0f, -1.0f,  2.0f, -2.0f, 16.0f,-16.0f, 0.0f},
+        //     {0.0f,  1.0f,  1.0f,  4.0f,  4.0f,  8.0f,  8.0f, 0.0f},
+        //     {0.0f,  1.0f, -1.0f,  8.0f, -8.0f,  4.0f, -4.0f, 0.0f},
+        //     {0.0f,  1.0f,  1.0f, 16.0f, 16.0f,  2.0f,  2.0f, 0.0f},
+        //     {0.0f,  1.0f, -1.0f, 32.0f,-32.0f,  1.0f, -1.0f, 1.0f}
+        // };
+
+        // 0 = r0 + (r1 + r2) + (r3 + r4)     + (r5 + r6) * 32
+        // 1 =      (r1 - r2) + (r3 - r4) * 2 + (r5 - r6) * 16
+        // 2 =      (r1 + r2) + (r3 + r4) * 4 + (r5 + r6) * 8
+        // 3 =      (r1 - r2) + (r3 - r4) * 8 + (r5 - r6) * 4
+        // 4 =      (r1 + r2) + (r3 + r4) * 16+ (r5 + r6) * 2
+        // 5 = r7 + (r1 - r2) + (r3 - r4) * 32+ (r5 - r6)
+
+        const float* bias = _bias;
+
+        conv3x3s1_winograd63_pack8_avx_task_1 task;
+        task.top_blob = &top_blob;
+        task.outw = outw;
+        task.outh = outh;
+        task.tiles_w = tiles_w;
+        task.tiles_h = tiles_h;
+        task.top_blob_tm = &top_blob_tm;
+        task.bias = bias;
+        parallel_for(opt, outch, task);
+    }
+    // END transform output
+
+    return 0;
+}
@@ -12,22 +12,15 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
-static void conv5x5s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
-{
-    int w = bottom_blob.w;
-    int inch = bottom_blob.c;
-
-    int outw = top_blob.w;
-    int outh = top_blob.h;
-    int outch = top_blob.c;
-
-    const float* kernel = _kernel;
-    const float* bias = _bias;
+namespace {
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int p=0; p<outch; p++)
+// one output channel of conv5x5s1_sse
+class conv5x5s1_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
 
         const float bias0 = bias ? bias[p] : 0.f;
 
@@ -211,9 +204,44 @@ static void conv5x5s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _ker
         }
     }
 
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int inch;
+    int outw;
+    int outh;
+    const float* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void conv5x5s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    const float* kernel = _kernel;
+    const float* bias = _bias;
+
+    conv5x5s1_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.inch = inch;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
+
 }
 
-static void conv5x5s2_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat& _bias, const Option& opt)
+static int conv5x5s2_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat& _bias, const Option& opt)
 {
     int kernel_w = 5;
     int kernel_h = 5;
@@ -221,5 +249,5 @@ static void conv5x5s2_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_ker
     int stride_w = 2;
     int stride_h = 2;
 
-    conv_im2col_sgemm_sse(bottom_blob, top_blob, _kernel, _bias, kernel_w, kernel_h, stride_w, stride_h, opt);
+    return convolution_im2col_sgemm_x86(bottom_blob, top_blob, _kernel, 1, _bias, kernel_w, kernel_h, 1, 1, stride_w, stride_h, opt);
 }
\ No newline at end of file
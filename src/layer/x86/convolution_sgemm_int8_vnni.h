@@ -0,0 +1,369 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// vpdpbusd multiplies unsigned activations with signed weights,
+// so activations are shifted by +128 and 128 * sum(weights) is subtracted afterwards
+
+#if __AVX512VNNI__
+#define CONV_INT8_VNNI_OUTCH 16
+#else
+#define CONV_INT8_VNNI_OUTCH 8
+#endif
+
+static void conv_im2col_sgemm_transform_kernel_int8_vnni(const Mat& _kernel, Mat& kernel_tm, int inch, int outch, int maxk)
+{
+    const int nn = CONV_INT8_VNNI_OUTCH;
+
+    const int K = inch * maxk;
+    const int K4 = (K + 3) / 4 * 4;
+    const int nn_outch = (outch + nn - 1) / nn;
+
+    // each row = nn int32 compensation followed by K4/4 groups of nn x 4 int8 weights
+    kernel_tm.create(nn * 4 + K4 * nn, nn_outch, (size_t)1u);
+
+    const signed char* kernel = _kernel;
+
+    for (int pp=0; pp<nn_outch; pp++)
+    {
+        int* comp = kernel_tm.row<int>(pp);
+        signed char* g00 = kernel_tm.row<signed char>(pp) + nn * 4;
+
+        for (int i=0; i<nn; i++)
+        {
+            const int p = pp * nn + i;
+
+            int sum = 0;
+            if (p < outch)
+            {
+                for (int k=0; k<K; k++)
+                    sum += kernel[p * K + k];
+            }
+
+            comp[i] = sum * 128;
+        }
+
+        for (int k=0; k<K4; k+=4)
+        {
+            for (int i=0; i<nn; i++)
+            {
+                const int p = pp * nn + i;
+
+                for (int j=0; j<4; j++)
+                {
+                    g00[0] = (p < outch && k + j < K) ? kernel[p * K + k + j] : 0;
+                    g00++;
+                }
+            }
+        }
+    }
+}
+
+namespace {
+
+// one output channel of conv_im2col_sgemm_int8_vnni
+class conv_im2col_sgemm_int8_vnni_task_0 : public ParallelTask
+{
+public:
+    void operator()(int i) const
+    {
+        for (int j=0; j<outw; j++)
+        {
+            unsigned char* ptr = bottom_im2row->row<unsigned char>(i * outw + j);
+
+            for (int q=0; q<inch; q++)
+            {
+                const signed char* sptr = bottom_blob.channel(q).row<const signed char>(i * stride_h) + j * stride_w;
+
+                for (int k=0; k<maxk; k++)
+                {
+                    ptr[0] = (unsigned char)(sptr[space_ofs[k]] + 128);
+                    ptr++;
+                }
+            }
+
+            for (int k=K; k<K4; k++)
+            {
+                ptr[0] = 0;
+                ptr++;
+            }
+        }
+    }
+
+    Mat bottom_blob;
+    int stride_w;
+    int stride_h;
+    int inch;
+    int outw;
+    int maxk;
+    int K;
+    int K4;
+    int* space_ofs;
+    Mat* bottom_im2row;
+};
+
+// one output channel of conv_im2col_sgemm_int8_vnni
+class conv_im2col_sgemm_int8_vnni_task_1 : public ParallelTask
+{
+public:
+    void operator()(int ii) const
+    {
+        const int i = ii * 8;
+
+        const unsigned char* r0 = bottom_im2row->row<const unsigned char>(i);
+        const unsigned char* r1 = bottom_im2row->row<const unsigned char>(i + 1);
+        const unsigned char* r2 = bottom_im2row->row<const unsigned char>(i + 2);
+        const unsigned char* r3 = bottom_im2row->row<const unsigned char>(i + 3);
+        const unsigned char* r4 = bottom_im2row->row<const unsigned char>(i + 4);
+        const unsigned char* r5 = bottom_im2row->row<const unsigned char>(i + 5);
+        const unsigned char* r6 = bottom_im2row->row<const unsigned char>(i + 6);
+        const unsigned char* r7 = bottom_im2row->row<const unsigned char>(i + 7);
+
+        for (int pp=0; pp<nn_outch; pp++)
+        {
+            const int* comp = kernel_tm.row<const int>(pp);
+            const signed char* kptr = kernel_tm.row<const signed char>(pp) + nn * 4;
+
+            int sums[8][CONV_INT8_VNNI_OUTCH];
+
+#if __AVX512VNNI__
+            __m512i _sum0 = _mm512_setzero_si512();
+            __m512i _sum1 = _mm512_setzero_si512();
+            __m512i _sum2 = _mm512_setzero_si512();
+            __m512i _sum3 = _mm512_setzero_si512();
+            __m512i _sum4 = _mm512_setzero_si512();
+            __m512i _sum5 = _mm512_setzero_si512();
+            __m512i _sum6 = _mm512_setzero_si512();
+            __m512i _sum7 = _mm512_setzero_si512();
+
+            for (int k=0; k<K4; k+=4)
+            {
+                __m512i _w = _mm512_loadu_si512(kptr);
+
+                _sum0 = _mm512_dpbusd_epi32(_sum0, _mm512_set1_epi32(*(const int*)(r0 + k)), _w);
+                _sum1 = _mm512_dpbusd_epi32(_sum1, _mm512_set1_epi32(*(const int*)(r1 + k)), _w);
+                _sum2 = _mm512_dpbusd_epi32(_sum2, _mm512_set1_epi32(*(const int*)(r2 + k)), _w);
+                _sum3 = _mm512_dpbusd_epi32(_sum3, _mm512_set1_epi32(*(const int*)(r3 + k)), _w);
+                _sum4 = _mm512_dpbusd_epi32(_sum4, _mm512_set1_epi32(*(const int*)(r4 + k)), _w);
+                _sum5 = _mm512_dpbusd_epi32(_sum5, _mm512_set1_epi32(*(const int*)(r5 + k)), _w);
+                _sum6 = _mm512_dpbusd_epi32(_sum6, _mm512_set1_epi32(*(const int*)(r6 + k)), _w);
+                _sum7 = _mm512_dpbusd_epi32(_sum7, _mm512_set1_epi32(*(const int*)(r7 + k)), _w);
+
+                kptr += 64;
+            }
+
+            __m512i _comp = _mm512_loadu_si512(comp);
+            _mm512_storeu_si512(sums[0], _mm512_sub_epi32(_sum0, _comp));
+            _mm512_storeu_si512(sums[1], _mm512_sub_epi32(_sum1, _comp));
+            _mm512_storeu_si512(sums[2], _mm512_sub_epi32(_sum2, _comp));
+            _mm512_storeu_si512(sums[3], _mm512_sub_epi32(_sum3, _comp));
+            _mm512_storeu_si512(sums[4], _mm512_sub_epi32(_sum4, _comp));
+            _mm512_storeu_si512(sums[5], _mm512_sub_epi32(_sum5, _comp));
+            _mm512_storeu_si512(sums[6], _mm512_sub_epi32(_sum6, _comp));
+            _mm512_storeu_si512(sums[7], _mm512_sub_epi32(_sum7, _comp));
+#else
+            __m256i _sum0 = _mm256_setzero_si256();
+            __m256i _sum1 = _mm256_setzero_si256();
+            __m256i _sum2 = _mm256_setzero_si256();
+            __m256i _sum3 = _mm256_setzero_si256();
+            __m256i _sum4 = _mm256_setzero_si256();
+            __m256i _sum5 = _mm256_setzero_si256();
+            __m256i _sum6 = _mm256_setzero_si256();
+            __m256i _sum7 = _mm256_setzero_si256();
+
+            for (int k=0; k<K4; k+=4)
+            {
+                __m256i _w = _mm256_loadu_si256((const __m256i*)kptr);
+
+                _sum0 = _mm256_dpbusd_avx_epi32(_sum0, _mm256_set1_epi32(*(const int*)(r0 + k)), _w);
+                _sum1 = _mm256_dpbusd_avx_epi32(_sum1, _mm256_set1_epi32(*(const int*)(r1 + k)), _w);
+                _sum2 = _mm256_dpbusd_avx_epi32(_sum2, _mm256_set1_epi32(*(const int*)(r2 + k)), _w);
+                _sum3 = _mm256_dpbusd_avx_epi32(_sum3, _mm256_set1_epi32(*(const int*)(r3 + k)), _w);
+                _sum4 = _mm256_dpbusd_avx_epi32(_sum4, _mm256_set1_epi32(*(const int*)(r4 + k)), _w);
+                _sum5 = _mm256_dpbusd_avx_epi32(_sum5, _mm256_set1_epi32(*(const int*)(r5 + k)), _w);
+                _sum6 = _mm256_dpbusd_avx_epi32(_sum6, _mm256_set1_epi32(*(const int*)(r6 + k)), _w);
+                _sum7 = _mm256_dpbusd_avx_epi32(_sum7, _mm256_set1_epi32(*(const int*)(r7 + k)), _w);
+
+                kptr += 32;
+            }
+
+            __m256i _comp = _mm256_loadu_si256((const __m256i*)comp);
+            _mm256_storeu_si256((__m256i*)sums[0], _mm256_sub_epi32(_sum0, _comp));
+            _mm256_storeu_si256((__m256i*)sums[1], _mm256_sub_epi32(_sum1, _comp));
+            _mm256_storeu_si256((__m256i*)sums[2], _mm256_sub_epi32(_sum2, _comp));
+            _mm256_storeu_si256((__m256i*)sums[3], _mm256_sub_epi32(_sum3, _comp));
+            _mm256_storeu_si256((__m256i*)sums[4], _mm256_sub_epi32(_sum4, _comp));
+            _mm256_storeu_si256((__m256i*)sums[5], _mm256_sub_epi32(_sum5, _comp));
+            _mm256_storeu_si256((__m256i*)sums[6], _mm256_sub_epi32(_sum6, _comp));
+            _mm256_storeu_si256((__m256i*)sums[7], _mm256_sub_epi32(_sum7, _comp));
+#endif // __AVX512VNNI__
+
+            for (int j=0; j<nn && pp * nn + j < outch; j++)
+            {
+                int* outptr = (int*)top_blob->channel(pp * nn + j) + i;
+
+                for (int t=0; t<8; t++)
+                {
+                    outptr[t] = sums[t][j];
+                }
+            }
+        }
+    }
+
+    Mat* top_blob;
+    Mat kernel_tm;
+    int nn;
+    int outch;
+    int K4;
+    int nn_outch;
+    Mat* bottom_im2row;
+};
+
+// one output channel of conv_im2col_sgemm_int8_vnni
+class conv_im2col_sgemm_int8_vnni_task_2 : public ParallelTask
+{
+public:
+    void operator()(int ii) const
+    {
+        int i = begin + ii;
+
+        const unsigned char* r0 = bottom_im2row->row<const unsigned char>(i);
+
+        for (int pp=0; pp<nn_outch; pp++)
+        {
+            const int* comp = kernel_tm.row<const int>(pp);
+            const signed char* kptr = kernel_tm.row<const signed char>(pp) + nn * 4;
+
+            int sums[CONV_INT8_VNNI_OUTCH];
+
+#if __AVX512VNNI__
+            __m512i _sum = _mm512_setzero_si512();
+
+            for (int k=0; k<K4; k+=4)
+            {
+                _sum = _mm512_dpbusd_epi32(_sum, _mm512_set1_epi32(*(const int*)(r0 + k)), _mm512_loadu_si512(kptr));
+
+                kptr += 64;
+            }
+
+            _mm512_storeu_si512(sums, _mm512_sub_epi32(_sum, _mm512_loadu_si512(comp)));
+#else
+            __m256i _sum = _mm256_setzero_si256();
+
+            for (int k=0; k<K4; k+=4)
+            {
+                _sum = _mm256_dpbusd_avx_epi32(_sum, _mm256_set1_epi32(*(const int*)(r0 + k)), _mm256_loadu_si256((const __m256i*)kptr));
+
+                kptr += 32;
+            }
+
+            _mm256_storeu_si256((__m256i*)sums, _mm256_sub_epi32(_sum, _mm256_loadu_si256((const __m256i*)comp)));
+#endif // __AVX512VNNI__
+
+            for (int j=0; j<nn && pp * nn + j < outch; j++)
+            {
+                int* outptr = top_blob->channel(pp * nn + j);
+                outptr[i] = sums[j];
+            }
+        }
+    }
+
+    Mat* top_blob;
+    Mat kernel_tm;
+    int nn;
+    int outch;
+    int K4;
+    int nn_outch;
+    Mat* bottom_im2row;
+    int begin;
+};
+
+} // namespace
+
+static void conv_im2col_sgemm_int8_vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    const int nn = CONV_INT8_VNNI_OUTCH;
+
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    const int size = outw * outh;
+    const int maxk = kernel_w * kernel_h;
+    const int K = inch * maxk;
+    const int K4 = (K + 3) / 4 * 4;
+    const int nn_outch = kernel_tm.h;
+
+    // kernel offsets
+    std::vector<int> _space_ofs(maxk);
+    int* space_ofs = &_space_ofs[0];
+    {
+        int p1 = 0;
+        int p2 = 0;
+        int gap = w * dilation_h - kernel_w * dilation_w;
+        for (int i = 0; i < kernel_h; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+            {
+                space_ofs[p1] = p2;
+                p1++;
+                p2 += dilation_w;
+            }
+            p2 += gap;
+        }
+    }
+
+    // im2row, shifted to unsigned
+    Mat bottom_im2row(K4, size, (size_t)1u, opt.workspace_allocator);
+    {
+        conv_im2col_sgemm_int8_vnni_task_0 task;
+        task.bottom_blob = bottom_blob;
+        task.stride_w = stride_w;
+        task.stride_h = stride_h;
+        task.inch = inch;
+        task.outw = outw;
+        task.maxk = maxk;
+        task.K = K;
+        task.K4 = K4;
+        task.space_ofs = space_ofs;
+        task.bottom_im2row = &bottom_im2row;
+        parallel_for(opt, outh, task);
+    }
+
+    int nn_size = size >> 3;
+    int remain_size_start = nn_size << 3;
+
+    conv_im2col_sgemm_int8_vnni_task_1 task;
+    task.top_blob = &top_blob;
+    task.kernel_tm = kernel_tm;
+    task.nn = nn;
+    task.outch = outch;
+    task.K4 = K4;
+    task.nn_outch = nn_outch;
+    task.bottom_im2row = &bottom_im2row;
+    parallel_for(opt, nn_size, task);
+
+    conv_im2col_sgemm_int8_vnni_task_2 remain_task;
+    remain_task.top_blob = &top_blob;
+    remain_task.kernel_tm = kernel_tm;
+    remain_task.nn = nn;
+    remain_task.outch = outch;
+    remain_task.K4 = K4;
+    remain_task.nn_outch = nn_outch;
+    remain_task.bottom_im2row = &bottom_im2row;
+    remain_task.begin = remain_size_start;
+    parallel_for(opt, size - remain_size_start, remain_task);
+}
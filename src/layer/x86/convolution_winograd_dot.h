@@ -0,0 +1,108 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+namespace {
+
+// one output channel of convolution_winograd_transform_kernel_x86
+class convolution_winograd_transform_kernel_x86_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
+    {
+        for (int q = 0; q < inch; q++)
+        {
+            const float* kernel0 = (const float*)kernel + (p * inch + q) * 9;
+
+            // h
+            float tmp[8][3];
+            for (int i = 0; i < n; i++)
+            {
+                const float* g = ktm + i * 3;
+                tmp[i][0] = kernel0[0] * g[0] + kernel0[1] * g[1] + kernel0[2] * g[2];
+                tmp[i][1] = kernel0[3] * g[0] + kernel0[4] * g[1] + kernel0[5] * g[2];
+                tmp[i][2] = kernel0[6] * g[0] + kernel0[7] * g[1] + kernel0[8] * g[2];
+            }
+
+            // U
+            for (int r = 0; r < n; r++)
+            {
+                const float* g = ktm + r * 3;
+
+                for (int i = 0; i < n; i++)
+                {
+                    float* uptr = kernel_tm_unpacked->row(r * n + i) + p * inch + q;
+                    uptr[0] = tmp[i][0] * g[0] + tmp[i][1] * g[1] + tmp[i][2] * g[2];
+                }
+            }
+        }
+    }
+
+    Mat kernel;
+    int inch;
+    const float* ktm;
+    int n;
+    Mat* kernel_tm_unpacked;
+};
+
+} // namespace
+
+// kernel_tm row r holds the x86_sgemm packed U[r] = (G g G^T)[r] of all outch x inch kernels
+static void convolution_winograd_transform_kernel_x86(const Mat& kernel, Mat& kernel_tm, int inch, int outch, const float* ktm, int n, Allocator* allocator)
+{
+    Mat kernel_tm_unpacked(inch * outch, n * n);
+
+    convolution_winograd_transform_kernel_x86_task task;
+    task.kernel = kernel;
+    task.inch = inch;
+    task.ktm = ktm;
+    task.n = n;
+    task.kernel_tm_unpacked = &kernel_tm_unpacked;
+    parallel_for(Option(), outch, task);
+
+    kernel_tm.create((int)x86_sgemm_packed_a_size(outch, inch), n * n, (size_t)4u, allocator);
+
+    for (int r = 0; r < n * n; r++)
+    {
+        x86_sgemm_pack_a(kernel_tm_unpacked.row(r), inch, outch, inch, kernel_tm.row(r));
+    }
+}
+
+// batched gemm over the transform positions
+// top_blob_tm[r] = kernel_tm[r] x bottom_blob_tm[r], inch and outch in scalar channels
+static int convolution_winograd_dot_x86(Mat& bottom_blob_tm, int outch, const Mat& kernel_tm, Mat& top_blob_tm, const Option& opt)
+{
+    const int tiles = bottom_blob_tm.w;
+    const int batch = bottom_blob_tm.h;
+    const size_t elemsize = bottom_blob_tm.elemsize;
+    const int elempack = bottom_blob_tm.elempack;
+    const int inch = bottom_blob_tm.c * elempack;
+
+    top_blob_tm.create(tiles, batch, outch / elempack, elemsize, elempack, opt.workspace_allocator);
+    if (top_blob_tm.empty())
+        return -100;
+
+    for (int r = 0; r < batch; r++)
+    {
+        const float* B = bottom_blob_tm.row(r);
+        float* C = top_blob_tm.row(r);
+
+        int ret = x86_sgemm(outch, tiles, inch, kernel_tm.row(r), B, bottom_blob_tm.cstep * elempack, elempack, C, top_blob_tm.cstep * elempack, elempack, 0, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    bottom_blob_tm = Mat();
+
+    return 0;
+}
@@ -22,13 +22,18 @@
 #include <immintrin.h>
 #endif
 
+#include "x86_usability.h"
 #include "layer_type.h"
 #include "benchmark.h"
+#include "cpu.h"
+#include "threadpool.h"
 
 namespace ncnn
 {
 
+#include "x86_sgemm.h"
 #include "convolution_sgemm.h"
+#include "convolution_winograd_dot.h"
 #include "convolution_1x1.h"
 #include "convolution_3x3.h"
 #include "convolution_5x5.h"
@@ -37,12 +42,52 @@ namespace ncnn
 #include "convolution_1x1_int8.h"
 #include "convolution_3x3_int8.h"
 
+#if __AVX__
+#include "convolution_3x3_pack8.h"
+#endif // __AVX__
+#if __AVX512F__
+#include "convolution_3x3_pack16.h"
+#endif // __AVX512F__
+
+#if NCNN_AVX512VNNI && __AVX512F__
+void conv_im2col_sgemm_transform_kernel_int8_avx512vnni(const Mat& kernel, Mat& kernel_tm, int inch, int outch, int maxk);
+void conv_im2col_sgemm_int8_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__
+#if NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+void conv_im2col_sgemm_transform_kernel_int8_avxvnni(const Mat& kernel, Mat& kernel_tm, int inch, int outch, int maxk);
+void conv_im2col_sgemm_int8_avxvnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt);
+#endif // NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+
 DEFINE_LAYER_CREATOR(Convolution_x86)
 
+#if __AVX__
+// transform-domain gemm work of winograd F(m,3) is tiles * (m+2)^2,
+// F(6,3) pays off once its coarser tiles do not waste too much on the border
+static bool winograd63_is_cheaper(int outw, int outh, int m)
+{
+    const int tiles63 = ((outw + 5) / 6) * ((outh + 5) / 6);
+    const int tiles = ((outw + m - 1) / m) * ((outh + m - 1) / m);
+
+    return tiles63 * 64 < tiles * (m + 2) * (m + 2);
+}
+#endif // __AVX__
+
 Convolution_x86::Convolution_x86()
 {
+#if __AVX__
+    support_packing = true;
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+
+    support_bf16_storage = true;
+    support_batch = true;
+
     activation = 0;
     convolution_dilation1 = 0;
+    weight_sgemm_type = 1;
 }
 
 int Convolution_x86::create_pipeline(const Option &opt)
@@ -86,6 +131,11 @@ int Convolution_x86::create_pipeline(const Option &opt)
 
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
+        // int8 kernels consume pack1 fp32 only
+        preferred_elempack = 1;
+        support_bf16_storage = false;
+        support_batch = false;
+
         return create_pipeline_int8_x86(opt);
     }
 
@@ -93,6 +143,56 @@ int Convolution_x86::create_pipeline(const Option &opt)
     int num_input = weight_data_size / kernel_size / num_output;
 
     use_winograd3x3 = false;
+    weight_sgemm_type = 1;
+
+    // the net feeds this layer in preferred_elempack, so only one weight layout is kept
+#if __AVX512F__
+    if (opt.use_packing_layout && num_input % 16 == 0 && num_output % 16 == 0)
+    {
+        preferred_elempack = 16;
+
+        if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        {
+            // both tile sizes are kept, forward picks the one with less work for the actual feature map
+            conv3x3s1_winograd23_transform_kernel_pack16_avx512(weight_data, weight_3x3_winograd23_data_pack16, num_input, num_output, opt.weight_allocator);
+            conv3x3s1_winograd63_transform_kernel_pack16_avx512(weight_data, weight_3x3_winograd63_data_pack16, num_input, num_output, opt.weight_allocator);
+        }
+        else
+        {
+            convolution_im2col_sgemm_transform_kernel_x86(weight_data, weight_sgemm_data, num_input, num_output, kernel_size, 16, opt.weight_allocator);
+
+            if (opt.use_weight_fp16_storage || opt.use_bf16_storage)
+                return create_pipeline_narrow_weight_x86(opt);
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
+
+#if __AVX__
+    if (opt.use_packing_layout && num_input % 8 == 0 && num_output % 8 == 0)
+    {
+        preferred_elempack = 8;
+
+        if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        {
+            // both tile sizes are kept, forward picks the one with less work for the actual feature map
+            conv3x3s1_winograd43_transform_kernel_pack8_avx(weight_data, weight_3x3_winograd43_data_pack8, num_input, num_output, opt.weight_allocator);
+            conv3x3s1_winograd63_transform_kernel_pack8_avx(weight_data, weight_3x3_winograd63_data_pack8, num_input, num_output, opt.weight_allocator);
+        }
+        else
+        {
+            convolution_im2col_sgemm_transform_kernel_x86(weight_data, weight_sgemm_data, num_input, num_output, kernel_size, 8, opt.weight_allocator);
+
+            if (opt.use_weight_fp16_storage || opt.use_bf16_storage)
+                return create_pipeline_narrow_weight_x86(opt);
+        }
+
+        return 0;
+    }
+#endif // __AVX__
+
+    preferred_elempack = 1;
 
     if (kernel_w == kernel_h && dilation_w != 1 && dilation_h == dilation_w && stride_w == 1 && stride_h == 1)
     {
@@ -138,20 +238,46 @@ int Convolution_x86::create_pipeline(const Option &opt)
         // winograd is slow on small channel count
         use_winograd3x3 = true;
 
-        conv3x3s1_winograd23_transform_kernel_sse(weight_data, weight_3x3_winograd23_data, num_input, num_output);
+        conv3x3s1_winograd23_transform_kernel_sse(weight_data, weight_3x3_winograd23_data, num_input, num_output, opt.weight_allocator);
         //         conv3x3s1_winograd43_transform_kernel_sse(weight_data, weight_3x3_winograd43_data, num_input, num_output);
 
         // for small size
-        conv_im2col_sgemm_transform_kernel_sse(weight_data, weight_sgemm_data, num_input, num_output, kernel_size);
+        convolution_im2col_sgemm_transform_kernel_x86(weight_data, weight_sgemm_data, num_input, num_output, kernel_size, 1, opt.weight_allocator);
+
+        if (opt.use_weight_fp16_storage || opt.use_bf16_storage)
+            return create_pipeline_narrow_weight_x86(opt);
     }
     else
     {
-        conv_im2col_sgemm_transform_kernel_sse(weight_data, weight_sgemm_data, num_input, num_output, kernel_size);
+        convolution_im2col_sgemm_transform_kernel_x86(weight_data, weight_sgemm_data, num_input, num_output, kernel_size, 1, opt.weight_allocator);
+
+        // strided or uneven dilation falls back to the reference implementation
+        const bool dilated = dilation_w > 1 || dilation_h > 1;
+        if ((opt.use_weight_fp16_storage || opt.use_bf16_storage) && !(dilated && (stride_w > 1 || stride_h > 1 || dilation_w != dilation_h)))
+            return create_pipeline_narrow_weight_x86(opt);
     }
 
     return 0;
 }
 
+int Convolution_x86::create_pipeline_narrow_weight_x86(const Option &opt)
+{
+    if (opt.use_bf16_storage)
+        x86_sgemm_cast_a_bf16(weight_sgemm_data, opt);
+    else
+        x86_sgemm_cast_a_fp16(weight_sgemm_data, opt);
+    if (weight_sgemm_data.empty())
+        return -100;
+
+    // forward may run with other options than these, the type is fixed here
+    weight_sgemm_type = opt.use_bf16_storage ? 4 : 2;
+
+    // forward reads the packed weights only from here on
+    weight_data.release();
+
+    return 0;
+}
+
 int Convolution_x86::destroy_pipeline(const Option &opt)
 {
     if (activation)
@@ -171,43 +297,15 @@ int Convolution_x86::destroy_pipeline(const Option &opt)
     return 0;
 }
 
-int Convolution_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+void Convolution_x86::make_padding(const Mat &bottom_blob, Mat &bottom_blob_bordered, const Option &opt) const
 {
-    // convolv with NxN kernel
-    // value = value + bias
-
-    if (bottom_blob.dims != 3)
-    {
-        //fprintf(stdout,"1\n");
-        return Convolution::forward(bottom_blob, top_blob, opt);
-    }
-
-    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
-    {
-        //fprintf(stdout,"2\n");
-        return forward_int8_x86(bottom_blob, top_blob, opt);
-    }
-
-    if ((dilation_w > 1 || dilation_h > 1) && (stride_w > 1 || stride_h > 1))
-    {
-        //fprintf(stdout,"3\n");
-        return Convolution::forward(bottom_blob, top_blob, opt);
-    }
-
-    if ((dilation_w > 1 || dilation_h > 1) && dilation_w != dilation_h)
-    {
-        //fprintf(stdout,"4\n");
-        return Convolution::forward(bottom_blob, top_blob, opt);
-    }
-
     int w = bottom_blob.w;
     int h = bottom_blob.h;
-    size_t elemsize = bottom_blob.elemsize;
 
     const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
     const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
-    Mat bottom_blob_bordered = bottom_blob;
+    bottom_blob_bordered = bottom_blob;
     if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0)
     {
         Option opt_b = opt;
@@ -236,6 +334,110 @@ int Convolution_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option
             copy_make_border(bottom_blob, bottom_blob_bordered, hpad - hpad / 2, hpad / 2, wpad - wpad / 2, wpad / 2, BORDER_CONSTANT, pad_value, opt_b);
         }
     }
+}
+
+int Convolution_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    // convolv with NxN kernel
+    // value = value + bias
+
+    if (opt.use_bf16_storage && bottom_blob.elemsize == 2u * bottom_blob.elempack)
+    {
+        return forward_bf16_x86(bottom_blob, top_blob, opt);
+    }
+
+    if (bottom_blob.dims == 3 && preferred_elempack != 1 && bottom_blob.elempack != preferred_elempack)
+    {
+        // the weights are kept in the preferred layout only
+        Option opt_pack = opt;
+        opt_pack.blob_allocator = opt.workspace_allocator;
+
+        Mat bottom_blob_packed;
+        convert_packing(bottom_blob, bottom_blob_packed, preferred_elempack, opt_pack);
+        if (bottom_blob_packed.empty())
+            return -100;
+
+        return forward(bottom_blob_packed, top_blob, opt);
+    }
+
+    if (bottom_blob.elempack != 1)
+    {
+#if __AVX512F__
+        if (bottom_blob.elempack == 16 && bottom_blob.dims == 3 && preferred_elempack == 16)
+        {
+            return forward_pack16_x86(bottom_blob, top_blob, opt);
+        }
+#endif // __AVX512F__
+#if __AVX__
+        if (bottom_blob.elempack == 8 && bottom_blob.dims == 3 && preferred_elempack == 8)
+        {
+            return forward_pack8_x86(bottom_blob, top_blob, opt);
+        }
+#endif // __AVX__
+
+        // other packed layouts run the pack1 kernels
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+
+        Mat bottom_blob_unpacked;
+        convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_unpack);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+
+        return forward(bottom_blob_unpacked, top_blob, opt);
+    }
+
+    const bool int8 = opt.use_int8_inference && weight_data.elemsize == (size_t)1u;
+
+    if (!int8 && bottom_blob.dims == 1 && kernel_w == 1 && kernel_h == 1 && bottom_blob.w == weight_data_size / num_output && !weight_sgemm_data.empty())
+    {
+        // flattened blob, a 1x1 kernel is an innerproduct over the packed weights
+        return forward_innerproduct_x86(bottom_blob, top_blob, opt);
+    }
+
+    if (!int8 && bottom_blob.dims != 3 && weight_data.empty())
+    {
+        // the reference path reads the released fp32 weights, run the blob as a one channel image instead
+        Mat bottom_blob_3d = bottom_blob.reshape(bottom_blob.w, bottom_blob.h, 1, opt.workspace_allocator);
+        if (bottom_blob_3d.empty())
+            return -100;
+
+        return forward(bottom_blob_3d, top_blob, opt);
+    }
+
+    if (bottom_blob.dims != 3 || preferred_elempack != 1)
+    {
+        //fprintf(stdout,"1\n");
+        return Convolution::forward(bottom_blob, top_blob, opt);
+    }
+
+    if (int8)
+    {
+        //fprintf(stdout,"2\n");
+        return forward_int8_x86(bottom_blob, top_blob, opt);
+    }
+
+    if ((dilation_w > 1 || dilation_h > 1) && (stride_w > 1 || stride_h > 1))
+    {
+        //fprintf(stdout,"3\n");
+        return Convolution::forward(bottom_blob, top_blob, opt);
+    }
+
+    if ((dilation_w > 1 || dilation_h > 1) && dilation_w != dilation_h)
+    {
+        //fprintf(stdout,"4\n");
+        return Convolution::forward(bottom_blob, top_blob, opt);
+    }
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    size_t elemsize = bottom_blob.elemsize;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
         return -100;
 
@@ -266,7 +468,9 @@ int Convolution_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option
         else
         {
             //fprintf(stdout,"6\n");
-            conv_im2col_sgemm_sse(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, stride_w, stride_h, opt);
+            int ret = convolution_im2col_sgemm_x86(bottom_blob_bordered, top_blob, weight_sgemm_data, weight_sgemm_type, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+            if (ret != 0)
+                return ret;
         }
 
         if (activation)
@@ -282,7 +486,9 @@ int Convolution_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option
         //         conv3x3s2_sse(bottom_blob_bordered, top_blob, weight_data, bias_data, opt);
         //         conv5x5s1_neon(bottom_blob_bordered, top_blob, weight_data, bias_data, opt);
         //fprintf(stdout,"7\n");
-        conv_im2col_sgemm_sse(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, stride_w, stride_h, opt);
+        int ret = convolution_im2col_sgemm_x86(bottom_blob_bordered, top_blob, weight_sgemm_data, weight_sgemm_type, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+        if (ret != 0)
+            return ret;
 
         if (activation)
         {
@@ -293,6 +499,319 @@ int Convolution_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option
     return 0;
 }
 
+int Convolution_x86::forward_innerproduct_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    const int num_input = bottom_blob.w;
+
+    top_blob.create(num_output, (size_t)4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // with a 1x1 kernel the im2col weight rows are the plain innerproduct rows
+    int ret = x86_sgemm(num_output, 1, num_input, weight_sgemm_data, weight_sgemm_type, (const float*)bottom_blob, num_input, num_input, top_blob, num_output, num_output, bias_term ? (const float*)bias_data : 0, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
+int Convolution_x86::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    const int batch = bottom_blobs.size();
+    const int elempack = bottom_blob.elempack;
+    const size_t elemsize = bottom_blob.elemsize;
+
+    // only the im2col sgemm paths fold the batch
+    bool fold = batch > 1 && bottom_blob.dims == 3 && elemsize == 4u * elempack && elempack == preferred_elempack && !weight_sgemm_data.empty();
+    for (int b = 1; fold && b < batch; b++)
+    {
+        const Mat& m = bottom_blobs[b];
+        fold = m.dims == 3 && m.w == bottom_blob.w && m.h == bottom_blob.h && m.c == bottom_blob.c && m.elemsize == elemsize && m.elempack == elempack;
+    }
+#if __AVX512F__
+    if (elempack == 16 && (!weight_3x3_winograd23_data_pack16.empty() || !weight_3x3_winograd63_data_pack16.empty()))
+        fold = false;
+#endif // __AVX512F__
+#if __AVX__
+    if (elempack == 8 && (!weight_3x3_winograd43_data_pack8.empty() || !weight_3x3_winograd63_data_pack8.empty()))
+        fold = false;
+#endif // __AVX__
+    if (elempack == 1 && (dilation_w != 1 || dilation_h != 1))
+        fold = false;
+
+    if (!fold)
+        return Convolution::forward_batch(bottom_blobs, top_blobs, opt);
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    std::vector<Mat> bottom_blobs_bordered(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        make_padding(bottom_blobs[b], bottom_blobs_bordered[b], opt);
+        if (bottom_blobs_bordered[b].empty())
+            return -100;
+    }
+
+    int outw = (bottom_blobs_bordered[0].w - kernel_extent_w) / stride_w + 1;
+    int outh = (bottom_blobs_bordered[0].h - kernel_extent_h) / stride_h + 1;
+
+    if (elempack == 1 && use_winograd3x3 && kernel_w == 3 && kernel_h == 3 && stride_w == 1 && stride_h == 1 && outw >= 8 && outh >= 8)
+        return Convolution::forward_batch(bottom_blobs, top_blobs, opt);
+
+    // folding pays off when the weights outweigh one item of im2col input
+    // large feature maps already amortize them and only pay the extra copies
+    if (outw * outh >= num_output)
+        return Convolution::forward_batch(bottom_blobs, top_blobs, opt);
+
+    top_blobs.resize(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b].create(outw, outh, num_output / elempack, elemsize, elempack, opt.blob_allocator);
+        if (top_blobs[b].empty())
+            return -100;
+    }
+
+    int ret = convolution_im2col_sgemm_batch_x86(bottom_blobs_bordered, top_blobs, weight_sgemm_data, weight_sgemm_type, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        for (int b = 0; b < batch; b++)
+        {
+            activation->forward_inplace(top_blobs[b], opt);
+        }
+    }
+
+    return 0;
+}
+
+int Convolution_x86::forward_bf16_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    Option opt_ws = opt;
+    opt_ws.blob_allocator = opt.workspace_allocator;
+
+    if (bottom_blob.dims == 1 && bottom_blob.elempack == 1 && kernel_w == 1 && kernel_h == 1 && bottom_blob.w == weight_data_size / num_output && !weight_sgemm_data.empty())
+    {
+        const int num_input = bottom_blob.w;
+
+        // flattened blob, an innerproduct straight from the bf16 input
+        Mat top_blob_fp32(num_output, (size_t)4u, opt.workspace_allocator);
+        if (top_blob_fp32.empty())
+            return -100;
+
+        int ret = x86_sgemm(num_output, 1, num_input, weight_sgemm_data, weight_sgemm_type, (const unsigned short*)bottom_blob, num_input, num_input, top_blob_fp32, num_output, num_output, bias_term ? (const float*)bias_data : 0, opt);
+        if (ret != 0)
+            return ret;
+
+        if (activation)
+        {
+            activation->forward_inplace(top_blob_fp32, opt_ws);
+        }
+
+        cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+        if (top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    if (weight_sgemm_type == 1 || use_winograd3x3 || bottom_blob.dims != 3 || bottom_blob.elempack != preferred_elempack)
+    {
+        // the other paths compute from a fp32 copy
+        Mat bottom_blob_fp32;
+        cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt_ws);
+        if (bottom_blob_fp32.empty())
+            return -100;
+
+        Mat top_blob_fp32;
+        int ret = forward(bottom_blob_fp32, top_blob_fp32, opt_ws);
+        if (ret != 0)
+            return ret;
+
+        cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+        if (top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    // same border as make_padding
+    int pl = 0;
+    int pr = 0;
+    int pt = 0;
+    int pb = 0;
+    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0)
+    {
+        pl = pad_left;
+        pr = pad_right;
+        pt = pad_top;
+        pb = pad_bottom;
+    }
+    else if ((pad_left == -233 && pad_right == -233 && pad_top == -233 && pad_bottom == -233) || (pad_left == -234 && pad_right == -234 && pad_top == -234 && pad_bottom == -234))
+    {
+        int wpad = kernel_extent_w + (w - 1) / stride_w * stride_w - w;
+        int hpad = kernel_extent_h + (h - 1) / stride_h * stride_h - h;
+        if (wpad > 0 || hpad > 0)
+        {
+            pl = pad_left == -233 ? wpad / 2 : wpad - wpad / 2;
+            pr = wpad - pl;
+            pt = pad_top == -233 ? hpad / 2 : hpad - hpad / 2;
+            pb = hpad - pt;
+        }
+    }
+
+    int outw = (w + pl + pr - kernel_extent_w) / stride_w + 1;
+    int outh = (h + pt + pb - kernel_extent_h) / stride_h + 1;
+
+    const int out_elempack = preferred_elempack;
+
+    // bf16 in, fp32 accumulation, bf16 out
+    Mat top_blob_fp32(outw, outh, num_output / out_elempack, (size_t)4u * out_elempack, out_elempack, opt.workspace_allocator);
+    if (top_blob_fp32.empty())
+        return -100;
+
+    int ret = convolution_im2col_sgemm_bf16_x86(bottom_blob, top_blob_fp32, weight_sgemm_data, weight_sgemm_type, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, pl, pt, pad_value, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob_fp32, opt_ws);
+    }
+
+    cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+int Convolution_x86::forward_pack8_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+#if __AVX__
+    size_t elemsize = bottom_blob.elemsize;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
+
+    int outw = (w - kernel_extent_w) / stride_w + 1;
+    int outh = (h - kernel_extent_h) / stride_h + 1;
+
+    top_blob.create(outw, outh, num_output / 8, elemsize, 8, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int ret = 0;
+    if (!weight_3x3_winograd63_data_pack8.empty())
+    {
+        if (winograd63_is_cheaper(outw, outh, 4))
+        {
+            ret = conv3x3s1_winograd63_pack8_avx(bottom_blob_bordered, top_blob, weight_3x3_winograd63_data_pack8, bias_data, opt);
+        }
+        else
+        {
+            ret = conv3x3s1_winograd43_pack8_avx(bottom_blob_bordered, top_blob, weight_3x3_winograd43_data_pack8, bias_data, opt);
+        }
+    }
+    else
+    {
+        ret = convolution_im2col_sgemm_x86(bottom_blob_bordered, top_blob, weight_sgemm_data, weight_sgemm_type, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+    }
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+#else
+    (void)bottom_blob;
+    (void)top_blob;
+    (void)opt;
+    return -1;
+#endif // __AVX__
+}
+
+int Convolution_x86::forward_pack16_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+#if __AVX512F__
+    size_t elemsize = bottom_blob.elemsize;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
+
+    int outw = (w - kernel_extent_w) / stride_w + 1;
+    int outh = (h - kernel_extent_h) / stride_h + 1;
+
+    top_blob.create(outw, outh, num_output / 16, elemsize, 16, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int ret = 0;
+    if (!weight_3x3_winograd63_data_pack16.empty())
+    {
+        if (winograd63_is_cheaper(outw, outh, 2))
+        {
+            ret = conv3x3s1_winograd63_pack16_avx512(bottom_blob_bordered, top_blob, weight_3x3_winograd63_data_pack16, bias_data, opt);
+        }
+        else
+        {
+            ret = conv3x3s1_winograd23_pack16_avx512(bottom_blob_bordered, top_blob, weight_3x3_winograd23_data_pack16, bias_data, opt);
+        }
+    }
+    else
+    {
+        ret = convolution_im2col_sgemm_x86(bottom_blob_bordered, top_blob, weight_sgemm_data, weight_sgemm_type, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+    }
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+#else
+    (void)bottom_blob;
+    (void)top_blob;
+    (void)opt;
+    return -1;
+#endif // __AVX512F__
+}
+
 int Convolution_x86::create_pipeline_int8_x86(const Option &opt)
 {
     int kernel_size = kernel_w * kernel_h;
@@ -300,6 +819,22 @@ int Convolution_x86::create_pipeline_int8_x86(const Option &opt)
 
     use_winograd3x3_int8 = false;
 
+    // vnni sgemm covers every kernel size, stride and dilation
+#if NCNN_AVX512VNNI && __AVX512F__
+    if (cpu_support_x86_avx512_vnni())
+    {
+        conv_im2col_sgemm_transform_kernel_int8_avx512vnni(weight_data, weight_sgemm_data_int8_vnni, num_input, num_output, kernel_size);
+        return 0;
+    }
+#endif // NCNN_AVX512VNNI && __AVX512F__
+#if NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+    if (cpu_support_x86_avx_vnni())
+    {
+        conv_im2col_sgemm_transform_kernel_int8_avxvnni(weight_data, weight_sgemm_data_int8_vnni, num_input, num_output, kernel_size);
+        return 0;
+    }
+#endif // NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+
     if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1 && num_input >= 16 && num_output >= 16)
     {
         // winograd is slow on small channel count
@@ -316,9 +851,78 @@ int Convolution_x86::create_pipeline_int8_x86(const Option &opt)
     return 0;
 }
 
+namespace {
+
+// one output channel of the winograd int8 requantize
+class convolution_requantize_x86_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
+    {
+        Option opt_g = opt;
+        opt_g.num_threads = 1;
+        opt_g.blob_allocator = top_blob->allocator;
+
+        Mat top_blob_tm_g = top_blob_tm.channel_range(p, 1);
+        Mat top_blob_g = top_blob->channel_range(p, 1);
+
+        // requantize and relu
+        float scale_in;
+        if (weight_data_int8_scales[p] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scale * weight_data_int8_scales[p]);
+
+        float scale_out = top_blob_int8_scale; //FIXME load param
+
+        requantize_int8_to_int8(top_blob_tm_g, top_blob_g, scale_in, scale_out, bias_term ? (const float *)bias_data + p : 0, bias_term ? 1 : 0, 0, opt_g);
+    }
+
+    Mat top_blob_tm;
+    Mat* top_blob;
+    Mat weight_data_int8_scales;
+    float bottom_blob_int8_scale;
+    float top_blob_int8_scale;
+    int bias_term;
+    Mat bias_data;
+    Option opt;
+};
+
+// one output channel of the winograd int8 dequantize
+class convolution_dequantize_x86_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
+    {
+        Option opt_g = opt;
+        opt_g.num_threads = 1;
+        opt_g.blob_allocator = top_blob->allocator;
+
+        Mat top_blob_g = top_blob->channel_range(p, 1);
+
+        // dequantize
+        float scale_in;
+        if (weight_data_int8_scales[p] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scale * weight_data_int8_scales[p]);
+
+        dequantize_int32_to_float32(top_blob_g, scale_in, bias_term ? (const float *)bias_data + p : 0, bias_term ? 1 : 0, opt_g);
+    }
+
+    Mat* top_blob;
+    Mat weight_data_int8_scales;
+    float bottom_blob_int8_scale;
+    int bias_term;
+    Mat bias_data;
+    Option opt;
+};
+
+} // namespace
+
 int Convolution_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
 {
-    if (dilation_w > 1 || dilation_h > 1)
+    if ((dilation_w > 1 || dilation_h > 1) && weight_sgemm_data_int8_vnni.empty())
     {
         return Convolution::forward(bottom_blob, top_blob, opt);
     }
@@ -373,6 +977,11 @@ int Convolution_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, con
     if (bottom_blob_bordered.empty())
         return -100;
 
+    if (!weight_sgemm_data_int8_vnni.empty())
+    {
+        return forward_int8_vnni_x86(bottom_blob_bordered, top_blob, opt);
+    }
+
     w = bottom_blob_bordered.w;
     h = bottom_blob_bordered.h;
 
@@ -400,27 +1009,16 @@ int Convolution_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, con
             //             conv3x3s1_winograd43_int8_sse(bottom_blob_bordered, top_blob_tm, weight_3x3_winograd23_data_int8, opt);
 
 // requantize, reverse scale inplace
-#pragma omp parallel for num_threads(opt.num_threads)
-            for (int p = 0; p < num_output; p++)
-            {
-                Option opt_g = opt;
-                opt_g.num_threads = 1;
-                opt_g.blob_allocator = top_blob.allocator;
-
-                Mat top_blob_tm_g = top_blob_tm.channel_range(p, 1);
-                Mat top_blob_g = top_blob.channel_range(p, 1);
-
-                // requantize and relu
-                float scale_in;
-                if (weight_data_int8_scales[p] == 0)
-                    scale_in = 0;
-                else
-                    scale_in = 1.f / (bottom_blob_int8_scale * weight_data_int8_scales[p]);
-
-                float scale_out = top_blob_int8_scale; //FIXME load param
-
-                requantize_int8_to_int8(top_blob_tm_g, top_blob_g, scale_in, scale_out, bias_term ? (const float *)bias_data + p : 0, bias_term ? 1 : 0, 0, opt_g);
-            }
+            convolution_requantize_x86_task task;
+            task.top_blob_tm = top_blob_tm;
+            task.top_blob = &top_blob;
+            task.weight_data_int8_scales = weight_data_int8_scales;
+            task.bottom_blob_int8_scale = bottom_blob_int8_scale;
+            task.top_blob_int8_scale = top_blob_int8_scale;
+            task.bias_term = bias_term;
+            task.bias_data = bias_data;
+            task.opt = opt;
+            parallel_for(opt, num_output, task);
         }
         else
         {
@@ -450,24 +1048,14 @@ int Convolution_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, con
             //             conv3x3s1_winograd43_int8_sse(bottom_blob_bordered, top_blob, weight_3x3_winograd23_data_int8, opt);
 
 // dequantize, reverse scale inplace
-#pragma omp parallel for num_threads(opt.num_threads)
-            for (int p = 0; p < num_output; p++)
-            {
-                Option opt_g = opt;
-                opt_g.num_threads = 1;
-                opt_g.blob_allocator = top_blob.allocator;
-
-                Mat top_blob_g = top_blob.channel_range(p, 1);
-
-                // dequantize
-                float scale_in;
-                if (weight_data_int8_scales[p] == 0)
-                    scale_in = 0;
-                else
-                    scale_in = 1.f / (bottom_blob_int8_scale * weight_data_int8_scales[p]);
-
-                dequantize_int32_to_float32(top_blob_g, scale_in, bias_term ? (const float *)bias_data + p : 0, bias_term ? 1 : 0, opt_g);
-            }
+            convolution_dequantize_x86_task task;
+            task.top_blob = &top_blob;
+            task.weight_data_int8_scales = weight_data_int8_scales;
+            task.bottom_blob_int8_scale = bottom_blob_int8_scale;
+            task.bias_term = bias_term;
+            task.bias_data = bias_data;
+            task.opt = opt;
+            parallel_for(opt, num_output, task);
         }
         else
         {
@@ -495,6 +1083,173 @@ int Convolution_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, con
     return 0;
 }
 
+namespace {
+
+// one output channel of the int8 vnni dequantize or requantize
+class convolution_int8_vnni_output_x86_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
+    {
+        const int* intptr = top_blob_int32.channel(p);
+
+        float scale_in;
+        if (weight_data_int8_scales[p] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scale * weight_data_int8_scales[p]);
+
+        const float bias = bias_term ? bias_data[p] : 0.f;
+
+        if (use_int8_requantize)
+        {
+            signed char* ptr = top_blob->channel(p);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = float2int8((intptr[i] * scale_in + bias) * top_blob_int8_scale);
+            }
+        }
+        else
+        {
+            float* ptr = top_blob->channel(p);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = intptr[i] * scale_in + bias;
+            }
+        }
+    }
+
+    Mat top_blob_int32;
+    Mat* top_blob;
+    int size;
+    Mat weight_data_int8_scales;
+    float bottom_blob_int8_scale;
+    int bias_term;
+    Mat bias_data;
+    bool use_int8_requantize;
+    float top_blob_int8_scale;
+};
+
+} // namespace
+
+int Convolution_x86::forward_int8_vnni_x86(const Mat &bottom_blob_bordered, Mat &top_blob, const Option &opt) const
+{
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    int outw = (w - kernel_extent_w) / stride_w + 1;
+    int outh = (h - kernel_extent_h) / stride_h + 1;
+
+    size_t out_elemsize = use_int8_requantize ? 1u : 4u;
+
+    top_blob.create(outw, outh, num_output, out_elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // dequantize writes back in place, requantize goes through an int32 workspace
+    Mat top_blob_int32 = top_blob;
+    if (use_int8_requantize)
+    {
+        top_blob_int32.create(outw, outh, num_output, (size_t)4u, opt.workspace_allocator);
+        if (top_blob_int32.empty())
+            return -100;
+    }
+
+#if NCNN_AVX512VNNI && __AVX512F__
+    conv_im2col_sgemm_int8_avx512vnni(bottom_blob_bordered, top_blob_int32, weight_sgemm_data_int8_vnni, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__
+#if NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+    conv_im2col_sgemm_int8_avxvnni(bottom_blob_bordered, top_blob_int32, weight_sgemm_data_int8_vnni, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+#endif // NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+
+    const int size = outw * outh;
+
+    convolution_int8_vnni_output_x86_task task;
+    task.top_blob_int32 = top_blob_int32;
+    task.top_blob = &top_blob;
+    task.size = size;
+    task.weight_data_int8_scales = weight_data_int8_scales;
+    task.bottom_blob_int8_scale = bottom_blob_int8_scale;
+    task.bias_term = bias_term;
+    task.bias_data = bias_data;
+    task.use_int8_requantize = use_int8_requantize;
+    task.top_blob_int8_scale = top_blob_int8_scale;
+    parallel_for(opt, num_output, task);
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
+namespace {
+
+// one channel of the dilation batch gather
+class convolution_dilation_split_x86_task : public ParallelTask
+{
+public:
+    void operator()(int c) const
+    {
+        float *outptr = inner_bottom_blob->channel(c);
+
+        for (int i = 0; i < inner_h; i++)
+        {
+            const float *ptr = (const float *)bottom_blob.channel(c) + dilation * i * w + x * w + y;
+            for (int j = 0; j < inner_w; j++)
+            {
+                outptr[j] = ptr[j * dilation];
+            }
+            outptr += inner_w;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* inner_bottom_blob;
+    int w;
+    int inner_w;
+    int inner_h;
+    int dilation;
+    int x;
+    int y;
+};
+
+// one output channel of the dilation batch scatter
+class convolution_dilation_merge_x86_task : public ParallelTask
+{
+public:
+    void operator()(int c) const
+    {
+        float *outptr = (float *)top_blob->channel(c) + x * outw + y;
+        for (int i = 0; i < inner_outh; i++)
+        {
+            const float *ptr = (const float *)inner_top_blob.channel(c) + i * inner_outw;
+            for (int j = 0; j < inner_outw; j++)
+            {
+                outptr[j * dilation] = ptr[j];
+            }
+            outptr += dilation * outw;
+        }
+    }
+
+    Mat inner_top_blob;
+    Mat* top_blob;
+    int outw;
+    int inner_outw;
+    int inner_outh;
+    int dilation;
+    int x;
+    int y;
+};
+
+} // namespace
+
 int Convolution_x86::forwardDilation_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
 {
     int w = bottom_blob.w;
@@ -534,40 +1289,31 @@ int Convolution_x86::forwardDilation_x86(const Mat &bottom_blob, Mat &top_blob,
             if (inner_top_blob.empty())
                 return -100;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-            for (int c = 0; c < bottom_blob.c; c++)
-            {
-                float *outptr = inner_bottom_blob.channel(c);
-
-                for (int i = 0; i < inner_h; i++)
-                {
-                    const float *ptr = (const float *)bottom_blob.channel(c) + dilation * i * w + x * w + y;
-                    for (int j = 0; j < inner_w; j++)
-                    {
-                        outptr[j] = ptr[j * dilation];
-                    }
-                    outptr += inner_w;
-                }
-            }
+            convolution_dilation_split_x86_task split_task;
+            split_task.bottom_blob = bottom_blob;
+            split_task.inner_bottom_blob = &inner_bottom_blob;
+            split_task.w = w;
+            split_task.inner_w = inner_w;
+            split_task.inner_h = inner_h;
+            split_task.dilation = dilation;
+            split_task.x = x;
+            split_task.y = y;
+            parallel_for(opt, bottom_blob.c, split_task);
 
             Option opt_g = opt;
             opt_g.blob_allocator = inner_top_blob.allocator;
             convolution_dilation1->forward(inner_bottom_blob, inner_top_blob, opt_g);
 
-#pragma omp parallel for num_threads(opt.num_threads)
-            for (int c = 0; c < num_output; c++)
-            {
-                float *outptr = (float *)top_blob.channel(c) + x * outw + y;
-                for (int i = 0; i < inner_outh; i++)
-                {
-                    const float *ptr = (const float *)inner_top_blob.channel(c) + i * inner_outw;
-                    for (int j = 0; j < inner_outw; j++)
-                    {
-                        outptr[j * dilation] = ptr[j];
-                    }
-                    outptr += dilation * outw;
-                }
-            }
+            convolution_dilation_merge_x86_task merge_task;
+            merge_task.inner_top_blob = inner_top_blob;
+            merge_task.top_blob = &top_blob;
+            merge_task.outw = outw;
+            merge_task.inner_outw = inner_outw;
+            merge_task.inner_outh = inner_outh;
+            merge_task.dilation = dilation;
+            merge_task.x = x;
+            merge_task.y = y;
+            parallel_for(opt, num_output, merge_task);
         }
     }
 
@@ -29,9 +29,18 @@ public:
 
     virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
+    virtual int forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
 protected:
+    void make_padding(const Mat& bottom_blob, Mat& bottom_blob_bordered, const Option& opt) const;
+    int forward_bf16_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_pack8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_pack16_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_innerproduct_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
     int create_pipeline_int8_x86(const Option& opt);
+    int create_pipeline_narrow_weight_x86(const Option& opt);
     int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_int8_vnni_x86(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const;
     int forwardDilation_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 public:
@@ -39,14 +48,27 @@ public:
     bool use_winograd3x3;
     Mat weight_3x3_winograd23_data;
     Mat weight_sgemm_data;
+    // element type of weight_sgemm_data, 1 = float32, 2 = float16, 4 = bfloat16
+    int weight_sgemm_type;
     std::vector<Mat> weight_3x3_winograd43_data;
 
+    // pack8
+    Mat weight_3x3_winograd43_data_pack8;
+    Mat weight_3x3_winograd63_data_pack8;
+
+    // pack16
+    Mat weight_3x3_winograd23_data_pack16;
+    Mat weight_3x3_winograd63_data_pack16;
+
     // forwardDilation
     Layer* convolution_dilation1;
 
     // int8
     bool use_winograd3x3_int8;
     Mat weight_3x3_winograd23_data_int8;
+
+    // int8 vnni
+    Mat weight_sgemm_data_int8_vnni;
 };
 
 } // namespace ncnn
@@ -12,22 +12,15 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
-static void convdw3x3s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
-{
-    int w = bottom_blob.w;
-
-    int outw = top_blob.w;
-    int outh = top_blob.h;
-
-    const int group = bottom_blob.c;
-
-    const float* kernel = _kernel;
-    const float* bias = _bias;
+namespace {
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int g=0; g<group; g++)
+// one group of convdw3x3s1_sse
+class convdw3x3s1_sse_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
     {
-        Mat out = top_blob.channel(g);
+        Mat out = top_blob->channel(g);
 
         const float bias0 = bias ? bias[g] : 0.f;
 
@@ -128,9 +121,19 @@ static void convdw3x3s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _k
             r2 += 2;
         }
     }
-}
 
-static void convdw3x3s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    const float* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw3x3s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
 {
     int w = bottom_blob.w;
 
@@ -139,15 +142,29 @@ static void convdw3x3s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _k
 
     const int group = bottom_blob.c;
 
-    const int tailstep = w - 2*outw + w;
-
     const float* kernel = _kernel;
     const float* bias = _bias;
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int g=0; g<group; g++)
+    convdw3x3s1_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
+
+namespace {
+
+// one group of convdw3x3s2_sse
+class convdw3x3s2_sse_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
     {
-        Mat out = top_blob.channel(g);
+        Mat out = top_blob->channel(g);
 
         const float bias0 = bias ? bias[g] : 0.f;
 
@@ -198,4 +215,41 @@ static void convdw3x3s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _k
         }
 
     }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw3x3s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int tailstep = w - 2*outw + w;
+
+    const float* kernel = _kernel;
+    const float* bias = _bias;
+
+    convdw3x3s2_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, group, task);
 }
@@ -22,22 +22,15 @@ static inline signed char float2int8(float v)
     return (signed char)int32;
 }
 
-static void convdw3x3s1_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option &opt)
-{
-    int w = bottom_blob.w;
-    //int h = bottom_blob.h;
-    //int inch = bottom_blob.c;
-
-    int outw = top_blob.w;
-    int outh = top_blob.h;
-    int outch = top_blob.c;
-
-    const signed char *kernel = _kernel;
+namespace {
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+// one channel of convdw3x3s1_int8_sse
+class convdw3x3s1_int8_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
 
         out.fill(0);
 
@@ -84,9 +77,18 @@ static void convdw3x3s1_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Ma
             r2 += 2;
         }
     }
-}
 
-static void convdw3x3s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option &opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    const signed char* kernel;
+};
+
+} // namespace
+
+static void convdw3x3s1_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option &opt)
 {
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
@@ -96,14 +98,27 @@ static void convdw3x3s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Ma
     int outh = top_blob.h;
     int outch = top_blob.c;
 
-    const int tailstep = w - 2 * outw + w;
-
     const signed char *kernel = _kernel;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+    convdw3x3s1_int8_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    parallel_for(opt, outch, task);
+}
+
+namespace {
+
+// one channel of convdw3x3s2_int8_sse
+class convdw3x3s2_int8_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
         out.fill(0);
 
         const signed char *kernel0 = (const signed char *)kernel + p * 9;
@@ -149,9 +164,19 @@ static void convdw3x3s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Ma
             r2 += tailstep;
         }
     }
-}
 
-static void convdw3x3s1_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_dequant, const Option &opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const signed char* kernel;
+};
+
+} // namespace
+
+static void convdw3x3s2_int8_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Option &opt)
 {
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
@@ -161,13 +186,30 @@ static void convdw3x3s1_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob,
     int outh = top_blob.h;
     int outch = top_blob.c;
 
+    const int tailstep = w - 2 * outw + w;
+
     const signed char *kernel = _kernel;
-    const int32_t *bias = _bias;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+    convdw3x3s2_int8_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    parallel_for(opt, outch, task);
+}
+
+namespace {
+
+// one channel of convdw3x3s1_int8_dequant_sse
+class convdw3x3s1_int8_dequant_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
         float *outptr = out;
 
         const float scale_dequant = scales_dequant[p];
@@ -217,9 +259,20 @@ static void convdw3x3s1_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob,
             r2 += 2;
         }
     }
-}
 
-static void convdw3x3s2_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_dequant, const Option &opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* scales_dequant;
+    int w;
+    int outw;
+    int outh;
+    const signed char* kernel;
+    const int32_t* bias;
+};
+
+} // namespace
+
+static void convdw3x3s1_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_dequant, const Option &opt)
 {
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
@@ -229,15 +282,30 @@ static void convdw3x3s2_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob,
     int outh = top_blob.h;
     int outch = top_blob.c;
 
-    const int tailstep = w - 2 * outw + w;
-
     const signed char *kernel = _kernel;
     const int32_t *bias = _bias;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+    convdw3x3s1_int8_dequant_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.scales_dequant = &scales_dequant[0];
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
+}
+
+namespace {
+
+// one channel of convdw3x3s2_int8_dequant_sse
+class convdw3x3s2_int8_dequant_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
         float *outptr = out;
 
         const float scale_dequant = scales_dequant[p];
@@ -288,9 +356,21 @@ static void convdw3x3s2_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob,
             r2 += tailstep;
         }
     }
-}
 
-static void convdw3x3s1_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_requant, const Option &opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* scales_dequant;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const signed char* kernel;
+    const int32_t* bias;
+};
+
+} // namespace
+
+static void convdw3x3s2_int8_dequant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_dequant, const Option &opt)
 {
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
@@ -300,13 +380,33 @@ static void convdw3x3s1_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob,
     int outh = top_blob.h;
     int outch = top_blob.c;
 
+    const int tailstep = w - 2 * outw + w;
+
     const signed char *kernel = _kernel;
-    const float *bias = _bias;
+    const int32_t *bias = _bias;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+    convdw3x3s2_int8_dequant_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.scales_dequant = &scales_dequant[0];
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
+}
+
+namespace {
+
+// one channel of convdw3x3s1_int8_requant_sse
+class convdw3x3s1_int8_requant_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
         signed char *outptr = out;
 
         const float bias0 = bias ? bias[p] : 0.f;
@@ -352,9 +452,20 @@ static void convdw3x3s1_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob,
             r2 += 2;
         }
     }
-}
 
-static void convdw3x3s2_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_requant, const Option &opt)
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* scales_requant;
+    int w;
+    int outw;
+    int outh;
+    const signed char* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw3x3s1_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_requant, const Option &opt)
 {
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
@@ -364,15 +475,30 @@ static void convdw3x3s2_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob,
     int outh = top_blob.h;
     int outch = top_blob.c;
 
-    const int tailstep = w - 2 * outw + w;
-
     const signed char *kernel = _kernel;
     const float *bias = _bias;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int p = 0; p < outch; p++)
+    convdw3x3s1_int8_requant_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.scales_requant = &scales_requant[0];
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
+}
+
+namespace {
+
+// one channel of convdw3x3s2_int8_requant_sse
+class convdw3x3s2_int8_requant_sse_task : public ParallelTask
+{
+public:
+    void operator()(int p) const
     {
-        Mat out = top_blob.channel(p);
+        Mat out = top_blob->channel(p);
         signed char *outptr = out;
 
         const float bias0 = bias ? bias[p] : 0.f;
@@ -419,4 +545,44 @@ static void convdw3x3s2_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob,
             r2 += tailstep;
         }
     }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* scales_requant;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const signed char* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw3x3s2_int8_requant_sse(const Mat &bottom_blob, Mat &top_blob, const Mat &_kernel, const Mat &_bias, std::vector<float> scales_requant, const Option &opt)
+{
+    int w = bottom_blob.w;
+    //int h = bottom_blob.h;
+    //int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    const int tailstep = w - 2 * outw + w;
+
+    const signed char *kernel = _kernel;
+    const float *bias = _bias;
+
+    convdw3x3s2_int8_requant_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.scales_requant = &scales_requant[0];
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, outch, task);
 }
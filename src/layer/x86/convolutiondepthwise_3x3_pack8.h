@@ -0,0 +1,260 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+namespace {
+
+// one group of convdw3x3s1_pack8_avx
+class convdw3x3s1_pack8_avx_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        Mat out = top_blob->channel(g);
+
+        __m256 _bias0 = bias ? _mm256_loadu_ps(bias + g * 8) : _mm256_setzero_ps();
+
+        const float* k0 = kernel.row(g);
+
+        float* outptr0 = out;
+
+        const float* r0 = bottom_blob.channel(g);
+
+        for (int i=0; i<outh; i++)
+        {
+            int j = 0;
+
+            // two neighbouring outputs share 2 of the 4 input columns of a kernel row
+            for (; j+1<outw; j+=2)
+            {
+                __m256 _sum0 = _bias0;
+                __m256 _sum1 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<3; k++)
+                {
+                    __m256 _r0 = _mm256_loadu_ps(sptr);
+                    __m256 _r1 = _mm256_loadu_ps(sptr + 8);
+                    __m256 _r2 = _mm256_loadu_ps(sptr + 16);
+                    __m256 _r3 = _mm256_loadu_ps(sptr + 24);
+
+                    __m256 _k0 = _mm256_loadu_ps(kptr);
+                    __m256 _k1 = _mm256_loadu_ps(kptr + 8);
+                    __m256 _k2 = _mm256_loadu_ps(kptr + 16);
+
+                    _sum0 = _mm256_comp_fmadd_ps(_k0, _r0, _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_k1, _r1, _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_k2, _r2, _sum0);
+                    _sum1 = _mm256_comp_fmadd_ps(_k0, _r1, _sum1);
+                    _sum1 = _mm256_comp_fmadd_ps(_k1, _r2, _sum1);
+                    _sum1 = _mm256_comp_fmadd_ps(_k2, _r3, _sum1);
+
+                    sptr += w * 8;
+                    kptr += 24;
+                }
+
+                _mm256_storeu_ps(outptr0, _sum0);
+                _mm256_storeu_ps(outptr0 + 8, _sum1);
+
+                r0 += 16;
+                outptr0 += 16;
+            }
+            for (; j<outw; j++)
+            {
+                __m256 _sum0 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<3; k++)
+                {
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_loadu_ps(sptr), _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _mm256_loadu_ps(sptr + 8), _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 16), _mm256_loadu_ps(sptr + 16), _sum0);
+
+                    sptr += w * 8;
+                    kptr += 24;
+                }
+
+                _mm256_storeu_ps(outptr0, _sum0);
+
+                r0 += 8;
+                outptr0 += 8;
+            }
+
+            r0 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    Mat kernel;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw3x3s1_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int tailstep = (w - outw) * 8;
+
+    const float* bias = _bias;
+
+    convdw3x3s1_pack8_avx_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.kernel = kernel;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
+
+namespace {
+
+// one group of convdw3x3s2_pack8_avx
+class convdw3x3s2_pack8_avx_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        Mat out = top_blob->channel(g);
+
+        __m256 _bias0 = bias ? _mm256_loadu_ps(bias + g * 8) : _mm256_setzero_ps();
+
+        const float* k0 = kernel.row(g);
+
+        float* outptr0 = out;
+
+        const float* r0 = bottom_blob.channel(g);
+
+        for (int i=0; i<outh; i++)
+        {
+            int j = 0;
+
+            // two neighbouring outputs share 3 of the 5 input columns of a kernel row
+            for (; j+1<outw; j+=2)
+            {
+                __m256 _sum0 = _bias0;
+                __m256 _sum1 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<3; k++)
+                {
+                    __m256 _r0 = _mm256_loadu_ps(sptr);
+                    __m256 _r1 = _mm256_loadu_ps(sptr + 8);
+                    __m256 _r2 = _mm256_loadu_ps(sptr + 16);
+                    __m256 _r3 = _mm256_loadu_ps(sptr + 24);
+                    __m256 _r4 = _mm256_loadu_ps(sptr + 32);
+
+                    __m256 _k0 = _mm256_loadu_ps(kptr);
+                    __m256 _k1 = _mm256_loadu_ps(kptr + 8);
+                    __m256 _k2 = _mm256_loadu_ps(kptr + 16);
+
+                    _sum0 = _mm256_comp_fmadd_ps(_k0, _r0, _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_k1, _r1, _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_k2, _r2, _sum0);
+                    _sum1 = _mm256_comp_fmadd_ps(_k0, _r2, _sum1);
+                    _sum1 = _mm256_comp_fmadd_ps(_k1, _r3, _sum1);
+                    _sum1 = _mm256_comp_fmadd_ps(_k2, _r4, _sum1);
+
+                    sptr += w * 8;
+                    kptr += 24;
+                }
+
+                _mm256_storeu_ps(outptr0, _sum0);
+                _mm256_storeu_ps(outptr0 + 8, _sum1);
+
+                r0 += 32;
+                outptr0 += 16;
+            }
+            for (; j<outw; j++)
+            {
+                __m256 _sum0 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<3; k++)
+                {
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_loadu_ps(sptr), _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _mm256_loadu_ps(sptr + 8), _sum0);
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 16), _mm256_loadu_ps(sptr + 16), _sum0);
+
+                    sptr += w * 8;
+                    kptr += 24;
+                }
+
+                _mm256_storeu_ps(outptr0, _sum0);
+
+                r0 += 16;
+                outptr0 += 8;
+            }
+
+            r0 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    Mat kernel;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw3x3s2_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int tailstep = (w - 2 * outw + w) * 8;
+
+    const float* bias = _bias;
+
+    convdw3x3s2_pack8_avx_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.kernel = kernel;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
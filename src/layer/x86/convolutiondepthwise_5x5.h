@@ -0,0 +1,212 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+namespace {
+
+// one group of convdw5x5s1_sse
+class convdw5x5s1_sse_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        Mat out = top_blob->channel(g);
+
+        const float bias0 = bias ? bias[g] : 0.f;
+
+        const float* kernel0 = kernel + g*25;
+
+        float* outptr = out;
+
+        const float* r0 = bottom_blob.channel(g);
+
+        for (int i=0; i<outh; i++)
+        {
+            int j = 0;
+
+#if __SSE2__
+            // four neighbouring outputs per vector
+            for (; j+3<outw; j+=4)
+            {
+                __m128 _sum = _mm_set1_ps(bias0);
+
+                const float* sptr = r0;
+                const float* kptr = kernel0;
+
+                for (int k=0; k<5; k++)
+                {
+                    _sum = _mm_comp_fmadd_ps(_mm_set1_ps(kptr[0]), _mm_loadu_ps(sptr), _sum);
+                    _sum = _mm_comp_fmadd_ps(_mm_set1_ps(kptr[1]), _mm_loadu_ps(sptr + 1), _sum);
+                    _sum = _mm_comp_fmadd_ps(_mm_set1_ps(kptr[2]), _mm_loadu_ps(sptr + 2), _sum);
+                    _sum = _mm_comp_fmadd_ps(_mm_set1_ps(kptr[3]), _mm_loadu_ps(sptr + 3), _sum);
+                    _sum = _mm_comp_fmadd_ps(_mm_set1_ps(kptr[4]), _mm_loadu_ps(sptr + 4), _sum);
+
+                    sptr += w;
+                    kptr += 5;
+                }
+
+                _mm_storeu_ps(outptr, _sum);
+
+                r0 += 4;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j<outw; j++)
+            {
+                float sum = bias0;
+
+                const float* sptr = r0;
+                const float* kptr = kernel0;
+
+                for (int k=0; k<5; k++)
+                {
+                    sum += sptr[0] * kptr[0];
+                    sum += sptr[1] * kptr[1];
+                    sum += sptr[2] * kptr[2];
+                    sum += sptr[3] * kptr[3];
+                    sum += sptr[4] * kptr[4];
+
+                    sptr += w;
+                    kptr += 5;
+                }
+
+                *outptr = sum;
+
+                r0++;
+                outptr++;
+            }
+
+            r0 += w - outw;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    const float* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw5x5s1_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const float* kernel = _kernel;
+    const float* bias = _bias;
+
+    convdw5x5s1_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
+
+namespace {
+
+// one group of convdw5x5s2_sse
+class convdw5x5s2_sse_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        Mat out = top_blob->channel(g);
+
+        const float bias0 = bias ? bias[g] : 0.f;
+
+        const float* kernel0 = kernel + g*25;
+
+        float* outptr = out;
+
+        const float* r0 = bottom_blob.channel(g);
+
+        for (int i=0; i<outh; i++)
+        {
+            for (int j=0; j<outw; j++)
+            {
+                float sum = bias0;
+
+                const float* sptr = r0;
+                const float* kptr = kernel0;
+
+                for (int k=0; k<5; k++)
+                {
+                    sum += sptr[0] * kptr[0];
+                    sum += sptr[1] * kptr[1];
+                    sum += sptr[2] * kptr[2];
+                    sum += sptr[3] * kptr[3];
+                    sum += sptr[4] * kptr[4];
+
+                    sptr += w;
+                    kptr += 5;
+                }
+
+                *outptr = sum;
+
+                r0 += 2;
+                outptr++;
+            }
+
+            r0 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* kernel;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw5x5s2_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int tailstep = w - 2*outw + w;
+
+    const float* kernel = _kernel;
+    const float* bias = _bias;
+
+    convdw5x5s2_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.kernel = kernel;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
@@ -0,0 +1,280 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+namespace {
+
+// one group of convdw5x5s1_pack16_avx512
+class convdw5x5s1_pack16_avx512_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        Mat out = top_blob->channel(g);
+
+        __m512 _bias0 = bias ? _mm512_loadu_ps(bias + g * 16) : _mm512_setzero_ps();
+
+        const float* k0 = kernel.row(g);
+
+        float* outptr0 = out;
+
+        const float* r0 = bottom_blob.channel(g);
+
+        for (int i=0; i<outh; i++)
+        {
+            int j = 0;
+
+            // two neighbouring outputs share 4 of the 6 input columns of a kernel row
+            for (; j+1<outw; j+=2)
+            {
+                __m512 _sum0 = _bias0;
+                __m512 _sum1 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<5; k++)
+                {
+                    __m512 _r0 = _mm512_loadu_ps(sptr);
+                    __m512 _r1 = _mm512_loadu_ps(sptr + 16);
+                    __m512 _r2 = _mm512_loadu_ps(sptr + 32);
+                    __m512 _r3 = _mm512_loadu_ps(sptr + 48);
+                    __m512 _r4 = _mm512_loadu_ps(sptr + 64);
+                    __m512 _r5 = _mm512_loadu_ps(sptr + 80);
+
+                    __m512 _k0 = _mm512_loadu_ps(kptr);
+                    __m512 _k1 = _mm512_loadu_ps(kptr + 16);
+                    __m512 _k2 = _mm512_loadu_ps(kptr + 32);
+                    __m512 _k3 = _mm512_loadu_ps(kptr + 48);
+                    __m512 _k4 = _mm512_loadu_ps(kptr + 64);
+
+                    _sum0 = _mm512_fmadd_ps(_k0, _r0, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k1, _r1, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k2, _r2, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k3, _r3, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k4, _r4, _sum0);
+                    _sum1 = _mm512_fmadd_ps(_k0, _r1, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k1, _r2, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k2, _r3, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k3, _r4, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k4, _r5, _sum1);
+
+                    sptr += w * 16;
+                    kptr += 80;
+                }
+
+                _mm512_storeu_ps(outptr0, _sum0);
+                _mm512_storeu_ps(outptr0 + 16, _sum1);
+
+                r0 += 32;
+                outptr0 += 32;
+            }
+            for (; j<outw; j++)
+            {
+                __m512 _sum0 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<5; k++)
+                {
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr), _mm512_loadu_ps(sptr), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 16), _mm512_loadu_ps(sptr + 16), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 32), _mm512_loadu_ps(sptr + 32), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 48), _mm512_loadu_ps(sptr + 48), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 64), _mm512_loadu_ps(sptr + 64), _sum0);
+
+                    sptr += w * 16;
+                    kptr += 80;
+                }
+
+                _mm512_storeu_ps(outptr0, _sum0);
+
+                r0 += 16;
+                outptr0 += 16;
+            }
+
+            r0 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    Mat kernel;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw5x5s1_pack16_avx512(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int tailstep = (w - outw) * 16;
+
+    const float* bias = _bias;
+
+    convdw5x5s1_pack16_avx512_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.kernel = kernel;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
+
+namespace {
+
+// one group of convdw5x5s2_pack16_avx512
+class convdw5x5s2_pack16_avx512_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        Mat out = top_blob->channel(g);
+
+        __m512 _bias0 = bias ? _mm512_loadu_ps(bias + g * 16) : _mm512_setzero_ps();
+
+        const float* k0 = kernel.row(g);
+
+        float* outptr0 = out;
+
+        const float* r0 = bottom_blob.channel(g);
+
+        for (int i=0; i<outh; i++)
+        {
+            int j = 0;
+
+            // two neighbouring outputs share 5 of the 7 input columns of a kernel row
+            for (; j+1<outw; j+=2)
+            {
+                __m512 _sum0 = _bias0;
+                __m512 _sum1 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<5; k++)
+                {
+                    __m512 _r0 = _mm512_loadu_ps(sptr);
+                    __m512 _r1 = _mm512_loadu_ps(sptr + 16);
+                    __m512 _r2 = _mm512_loadu_ps(sptr + 32);
+                    __m512 _r3 = _mm512_loadu_ps(sptr + 48);
+                    __m512 _r4 = _mm512_loadu_ps(sptr + 64);
+                    __m512 _r5 = _mm512_loadu_ps(sptr + 80);
+                    __m512 _r6 = _mm512_loadu_ps(sptr + 96);
+
+                    __m512 _k0 = _mm512_loadu_ps(kptr);
+                    __m512 _k1 = _mm512_loadu_ps(kptr + 16);
+                    __m512 _k2 = _mm512_loadu_ps(kptr + 32);
+                    __m512 _k3 = _mm512_loadu_ps(kptr + 48);
+                    __m512 _k4 = _mm512_loadu_ps(kptr + 64);
+
+                    _sum0 = _mm512_fmadd_ps(_k0, _r0, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k1, _r1, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k2, _r2, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k3, _r3, _sum0);
+                    _sum0 = _mm512_fmadd_ps(_k4, _r4, _sum0);
+                    _sum1 = _mm512_fmadd_ps(_k0, _r2, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k1, _r3, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k2, _r4, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k3, _r5, _sum1);
+                    _sum1 = _mm512_fmadd_ps(_k4, _r6, _sum1);
+
+                    sptr += w * 16;
+                    kptr += 80;
+                }
+
+                _mm512_storeu_ps(outptr0, _sum0);
+                _mm512_storeu_ps(outptr0 + 16, _sum1);
+
+                r0 += 64;
+                outptr0 += 32;
+            }
+            for (; j<outw; j++)
+            {
+                __m512 _sum0 = _bias0;
+
+                const float* sptr = r0;
+                const float* kptr = k0;
+
+                for (int k=0; k<5; k++)
+                {
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr), _mm512_loadu_ps(sptr), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 16), _mm512_loadu_ps(sptr + 16), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 32), _mm512_loadu_ps(sptr + 32), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 48), _mm512_loadu_ps(sptr + 48), _sum0);
+                    _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(kptr + 64), _mm512_loadu_ps(sptr + 64), _sum0);
+
+                    sptr += w * 16;
+                    kptr += 80;
+                }
+
+                _mm512_storeu_ps(outptr0, _sum0);
+
+                r0 += 32;
+                outptr0 += 16;
+            }
+
+            r0 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    Mat kernel;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    const float* bias;
+};
+
+} // namespace
+
+static void convdw5x5s2_pack16_avx512(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
+{
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int group = bottom_blob.c;
+
+    const int tailstep = (w - 2 * outw + w) * 16;
+
+    const float* bias = _bias;
+
+    convdw5x5s2_pack16_avx512_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.kernel = kernel;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.bias = bias;
+    parallel_for(opt, group, task);
+}
@@ -0,0 +1,189 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// vpdpbusd multiplies unsigned activations with signed weights,
+// so activations are shifted by +128 and 128 * sum(weights) is subtracted afterwards
+
+#if __AVX512VNNI__
+#define CONVDW_INT8_VNNI_LANES 16
+#else
+#define CONVDW_INT8_VNNI_LANES 8
+#endif
+
+static void convdw_transform_kernel_int8_vnni(const Mat& _kernel, Mat& kernel_tm, int channels, int maxk)
+{
+    const int K4 = (maxk + 3) / 4 * 4;
+
+    // each row = int32 compensation + K4 int8 weight
+    kernel_tm.create(4 + K4, channels, (size_t)1u);
+
+    const signed char* kernel = _kernel;
+
+    for (int g=0; g<channels; g++)
+    {
+        const signed char* k0 = kernel + g * maxk;
+
+        int* comp = kernel_tm.row<int>(g);
+        signed char* g00 = kernel_tm.row<signed char>(g) + 4;
+
+        int sum = 0;
+        for (int k=0; k<K4; k++)
+        {
+            g00[k] = k < maxk ? k0[k] : 0;
+            sum += g00[k];
+        }
+
+        comp[0] = sum * 128;
+    }
+}
+
+namespace {
+
+// one channel of convdw_int8_vnni
+class convdw_int8_vnni_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        const Mat m = bottom_blob.channel(g);
+        int* outptr = top_blob->channel(g);
+
+        const int comp = kernel_tm.row<const int>(g)[0];
+        const signed char* kptr = kernel_tm.row<const signed char>(g) + 4;
+
+        // one output row laid out as [K4/4][outw_aligned][4] unsigned
+        std::vector<unsigned char> rowbuf(K4 * outw_aligned, 0);
+
+        for (int i=0; i<outh; i++)
+        {
+            const signed char* sptr = m.row<const signed char>(i * stride_h);
+
+            for (int kg=0; kg<K4/4; kg++)
+            {
+                unsigned char* ptr = &rowbuf[kg * outw_aligned * 4];
+
+                for (int j=0; j<outw; j++)
+                {
+                    const signed char* sptr2 = sptr + j * stride_w;
+
+                    for (int t=0; t<4; t++)
+                    {
+                        const int k = kg * 4 + t;
+                        ptr[t] = k < maxk ? (unsigned char)(sptr2[space_ofs[k]] + 128) : 0;
+                    }
+
+                    ptr += 4;
+                }
+            }
+
+            for (int j=0; j<outw; j+=nn)
+            {
+                int sums[CONVDW_INT8_VNNI_LANES];
+
+#if __AVX512VNNI__
+                __m512i _sum = _mm512_setzero_si512();
+
+                for (int kg=0; kg<K4/4; kg++)
+                {
+                    __m512i _val = _mm512_loadu_si512(&rowbuf[(kg * outw_aligned + j) * 4]);
+                    _sum = _mm512_dpbusd_epi32(_sum, _val, _mm512_set1_epi32(*(const int*)(kptr + kg * 4)));
+                }
+
+                _mm512_storeu_si512(sums, _mm512_sub_epi32(_sum, _mm512_set1_epi32(comp)));
+#else
+                __m256i _sum = _mm256_setzero_si256();
+
+                for (int kg=0; kg<K4/4; kg++)
+                {
+                    __m256i _val = _mm256_loadu_si256((const __m256i*)&rowbuf[(kg * outw_aligned + j) * 4]);
+                    _sum = _mm256_dpbusd_avx_epi32(_sum, _val, _mm256_set1_epi32(*(const int*)(kptr + kg * 4)));
+                }
+
+                _mm256_storeu_si256((__m256i*)sums, _mm256_sub_epi32(_sum, _mm256_set1_epi32(comp)));
+#endif // __AVX512VNNI__
+
+                for (int t=0; t<nn && j + t < outw; t++)
+                {
+                    outptr[j + t] = sums[t];
+                }
+            }
+
+            outptr += outw;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    Mat kernel_tm;
+    int stride_w;
+    int stride_h;
+    int nn;
+    int outw;
+    int outh;
+    int maxk;
+    int K4;
+    int outw_aligned;
+    int* space_ofs;
+};
+
+} // namespace
+
+static void convdw_int8_vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    const int nn = CONVDW_INT8_VNNI_LANES;
+
+    int w = bottom_blob.w;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int channels = top_blob.c;
+
+    const int maxk = kernel_w * kernel_h;
+    const int K4 = (maxk + 3) / 4 * 4;
+    const int outw_aligned = (outw + nn - 1) / nn * nn;
+
+    // kernel offsets
+    std::vector<int> _space_ofs(maxk);
+    int* space_ofs = &_space_ofs[0];
+    {
+        int p1 = 0;
+        int p2 = 0;
+        int gap = w * dilation_h - kernel_w * dilation_w;
+        for (int i = 0; i < kernel_h; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+            {
+                space_ofs[p1] = p2;
+                p1++;
+                p2 += dilation_w;
+            }
+            p2 += gap;
+        }
+    }
+
+    convdw_int8_vnni_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.kernel_tm = kernel_tm;
+    task.stride_w = stride_w;
+    task.stride_h = stride_h;
+    task.nn = nn;
+    task.outw = outw;
+    task.outh = outh;
+    task.maxk = maxk;
+    task.K4 = K4;
+    task.outw_aligned = outw_aligned;
+    task.space_ofs = space_ofs;
+    parallel_for(opt, channels, task);
+}
@@ -14,19 +14,63 @@
 
 #include "convolutiondepthwise_x86.h"
 
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "x86_usability.h"
 #include "layer_type.h"
+#include "cpu.h"
+#include "threadpool.h"
 
 namespace ncnn
 {
 
 #include "convolutiondepthwise_3x3.h"
+#include "convolutiondepthwise_5x5.h"
 
 #include "convolutiondepthwise_3x3_int8.h"
 
+#if __SSE2__
+#include "convolutiondepthwise_3x3_pack4.h"
+#include "convolutiondepthwise_5x5_pack4.h"
+#endif // __SSE2__
+#if __AVX__
+#include "convolutiondepthwise_3x3_pack8.h"
+#include "convolutiondepthwise_5x5_pack8.h"
+#endif // __AVX__
+#if __AVX512F__
+#include "convolutiondepthwise_3x3_pack16.h"
+#include "convolutiondepthwise_5x5_pack16.h"
+#endif // __AVX512F__
+
+#if NCNN_AVX512VNNI && __AVX512F__
+void convdw_transform_kernel_int8_avx512vnni(const Mat& kernel, Mat& kernel_tm, int channels, int maxk);
+void convdw_int8_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__
+#if NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+void convdw_transform_kernel_int8_avxvnni(const Mat& kernel, Mat& kernel_tm, int channels, int maxk);
+void convdw_int8_avxvnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt);
+#endif // NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+
 DEFINE_LAYER_CREATOR(ConvolutionDepthWise_x86)
 
 ConvolutionDepthWise_x86::ConvolutionDepthWise_x86()
 {
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+#endif // __SSE2__
+
     activation = 0;
 }
 
@@ -78,9 +122,82 @@ int ConvolutionDepthWise_x86::create_pipeline(const Option &opt)
 
     group_ops.clear();
 
+    // grouped and int8 convolution consume pack1 only
+    preferred_elempack = 1;
+
     if (channels == group && group == num_output)
     {
         // depth-wise specific
+        if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+        {
+            // vnni path covers every kernel size, stride and dilation
+#if NCNN_AVX512VNNI && __AVX512F__
+            if (cpu_support_x86_avx512_vnni())
+            {
+                convdw_transform_kernel_int8_avx512vnni(weight_data, weight_int8_vnni, channels, maxk);
+                return 0;
+            }
+#endif // NCNN_AVX512VNNI && __AVX512F__
+#if NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+            if (cpu_support_x86_avx_vnni())
+            {
+                convdw_transform_kernel_int8_avxvnni(weight_data, weight_int8_vnni, channels, maxk);
+                return 0;
+            }
+#endif // NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+        }
+
+        else
+        {
+            int elempack = 1;
+#if __SSE2__
+            if (opt.use_packing_layout)
+            {
+                elempack = channels % 4 == 0 ? 4 : 1;
+#if __AVX__
+                if (channels % 8 == 0)
+                    elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+                if (channels % 16 == 0)
+                    elempack = 16;
+#endif // __AVX512F__
+            }
+#endif // __SSE2__
+
+            if (elempack != 1)
+            {
+                // the packed path covers every kernel size, stride and dilation
+                preferred_elempack = elempack;
+
+                // src = maxk-channels
+                // dst = pb-maxk-channels/pb
+                weight_data_packed.create(maxk, channels / elempack, (size_t)4u * elempack, elempack);
+                if (weight_data_packed.empty())
+                    return -100;
+
+                for (int g = 0; g < channels / elempack; g++)
+                {
+                    float* ptr = weight_data_packed.row(g);
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        for (int l = 0; l < elempack; l++)
+                        {
+                            ptr[k * elempack + l] = weight_data[(g * elempack + l) * maxk + k];
+                        }
+                    }
+                }
+
+                return 0;
+            }
+
+            if (kernel_w == 5 && kernel_h == 5 && dilation_w == 1 && dilation_h == 1 && (stride_w == 1 || stride_w == 2) && stride_h == stride_w)
+            {
+                return 0;
+            }
+        }
+
         // special path for both int8 and fp32
         if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
@@ -180,28 +297,20 @@ int ConvolutionDepthWise_x86::destroy_pipeline(const Option &opt)
     }
     group_ops.clear();
 
+    weight_data_packed.release();
+
     return 0;
 }
 
-int ConvolutionDepthWise_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+void ConvolutionDepthWise_x86::make_padding(const Mat &bottom_blob, Mat &bottom_blob_bordered, const Option &opt) const
 {
-    // convolv with NxN kernel
-    // value = value + bias
-
-    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
-    {
-        return forward_int8_x86(bottom_blob, top_blob, opt);
-    }
-
     int w = bottom_blob.w;
     int h = bottom_blob.h;
-    int channels = bottom_blob.c;
-    size_t elemsize = bottom_blob.elemsize;
 
     const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
     const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
-    Mat bottom_blob_bordered = bottom_blob;
+    bottom_blob_bordered = bottom_blob;
     if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0)
     {
         Option opt_b = opt;
@@ -230,11 +339,50 @@ int ConvolutionDepthWise_x86::forward(const Mat &bottom_blob, Mat &top_blob, con
             copy_make_border(bottom_blob, bottom_blob_bordered, hpad - hpad / 2, hpad / 2, wpad - wpad / 2, wpad / 2, BORDER_CONSTANT, pad_value, opt_b);
         }
     }
+}
+
+int ConvolutionDepthWise_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    // convolv with NxN kernel
+    // value = value + bias
+
+    if (bottom_blob.elempack != 1)
+    {
+        if (bottom_blob.elempack == weight_data_packed.elempack && bottom_blob.dims == 3)
+        {
+            return forward_packed_x86(bottom_blob, top_blob, opt);
+        }
+
+        // other packed layouts run the pack1 kernels
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+
+        Mat bottom_blob_unpacked;
+        convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_unpack);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+
+        return forward(bottom_blob_unpacked, top_blob, opt);
+    }
+
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return forward_int8_x86(bottom_blob, top_blob, opt);
+    }
+
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
         return -100;
 
-    w = bottom_blob_bordered.w;
-    h = bottom_blob_bordered.h;
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
 
     int outw = (w - kernel_extent_w) / stride_w + 1;
     int outh = (h - kernel_extent_h) / stride_h + 1;
@@ -267,10 +415,38 @@ int ConvolutionDepthWise_x86::forward(const Mat &bottom_blob, Mat &top_blob, con
                 activation->forward_inplace(top_blob, opt);
             }
 
+            return 0;
+        }
+        if (kernel_w == 5 && kernel_h == 5 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        {
+            convdw5x5s1_sse(bottom_blob_bordered, top_blob, weight_data, bias_data, opt);
+
+            if (activation)
+            {
+                activation->forward_inplace(top_blob, opt);
+            }
+
+            return 0;
+        }
+        if (kernel_w == 5 && kernel_h == 5 && dilation_w == 1 && dilation_h == 1 && stride_w == 2 && stride_h == 2)
+        {
+            convdw5x5s2_sse(bottom_blob_bordered, top_blob, weight_data, bias_data, opt);
+
+            if (activation)
+            {
+                activation->forward_inplace(top_blob, opt);
+            }
+
             return 0;
         }
     }
 
+    if (group_ops.empty())
+    {
+        // pipeline was built for packed input only
+        return ConvolutionDepthWise::forward(bottom_blob, top_blob, opt);
+    }
+
     // group convolution
     const int channels_g = channels / group;
     const int num_output_g = num_output / group;
@@ -292,69 +468,345 @@ int ConvolutionDepthWise_x86::forward(const Mat &bottom_blob, Mat &top_blob, con
     return 0;
 }
 
-int ConvolutionDepthWise_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+#if __SSE2__
+namespace {
+
+// one channel of the packed depth-wise fallback
+class convdw_packed_x86_task : public ParallelTask
 {
-    int w = bottom_blob.w;
-    int h = bottom_blob.h;
+public:
+    void operator()(int g) const
+    {
+        float* outptr = top_blob->channel(g);
+        const Mat m = bottom_blob_bordered.channel(g);
+        const float* kptr0 = weight_data_packed.row(g);
+
+        for (int i = 0; i < outh; i++)
+        {
+            for (int j = 0; j < outw; j++)
+            {
+                const float* sptr = m.row(i * stride_h) + j * stride_w * elempack;
+
+#if __AVX512F__
+                if (elempack == 16)
+                {
+                    __m512 _sum = bias ? _mm512_loadu_ps(bias + g * 16) : _mm512_setzero_ps();
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        _sum = _mm512_fmadd_ps(_mm512_loadu_ps(kptr0 + k * 16), _mm512_loadu_ps(sptr + space_ofs[k]), _sum);
+                    }
+
+                    _mm512_storeu_ps(outptr, _sum);
+                }
+#endif // __AVX512F__
+#if __AVX__
+                if (elempack == 8)
+                {
+                    __m256 _sum = bias ? _mm256_loadu_ps(bias + g * 8) : _mm256_setzero_ps();
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        _sum = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr0 + k * 8), _mm256_loadu_ps(sptr + space_ofs[k]), _sum);
+                    }
+
+                    _mm256_storeu_ps(outptr, _sum);
+                }
+#endif // __AVX__
+                if (elempack == 4)
+                {
+                    __m128 _sum = bias ? _mm_loadu_ps(bias + g * 4) : _mm_setzero_ps();
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        _sum = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr0 + k * 4), _mm_loadu_ps(sptr + space_ofs[k]), _sum);
+                    }
+
+                    _mm_storeu_ps(outptr, _sum);
+                }
+
+                outptr += elempack;
+            }
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    Mat weight_data_packed;
+    int outw;
+    int outh;
+    int elempack;
+    int stride_w;
+    int stride_h;
+    int maxk;
+    int* space_ofs;
+    const float* bias;
+};
+
+} // namespace
+#endif // __SSE2__
+
+int ConvolutionDepthWise_x86::forward_packed_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+#if __SSE2__
     int channels = bottom_blob.c;
     size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
 
     const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
     const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
-    Mat bottom_blob_unbordered = bottom_blob;
-    if (elemsize != 1)
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
+
+    int outw = (w - kernel_extent_w) / stride_w + 1;
+    int outh = (h - kernel_extent_h) / stride_h + 1;
+
+    top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const bool k3 = kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1;
+    const bool k5 = kernel_w == 5 && kernel_h == 5 && dilation_w == 1 && dilation_h == 1;
+    const bool s1 = stride_w == 1 && stride_h == 1;
+    const bool s2 = stride_w == 2 && stride_h == 2;
+
+    bool done = true;
+
+#if __AVX512F__
+    if (elempack == 16)
     {
-        bottom_blob_unbordered.create(w, h, channels, (size_t)1u, opt.workspace_allocator);
-        if (bottom_blob_unbordered.empty())
-            return -100;
+        if (k3 && s1)
+            convdw3x3s1_pack16_avx512(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k3 && s2)
+            convdw3x3s2_pack16_avx512(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k5 && s1)
+            convdw5x5s1_pack16_avx512(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k5 && s2)
+            convdw5x5s2_pack16_avx512(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else
+            done = false;
+    }
+#endif // __AVX512F__
+#if __AVX__
+    if (elempack == 8)
+    {
+        if (k3 && s1)
+            convdw3x3s1_pack8_avx(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k3 && s2)
+            convdw3x3s2_pack8_avx(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k5 && s1)
+            convdw5x5s1_pack8_avx(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k5 && s2)
+            convdw5x5s2_pack8_avx(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else
+            done = false;
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        if (k3 && s1)
+            convdw3x3s1_pack4_sse(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k3 && s2)
+            convdw3x3s2_pack4_sse(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k5 && s1)
+            convdw5x5s1_pack4_sse(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else if (k5 && s2)
+            convdw5x5s2_pack4_sse(bottom_blob_bordered, top_blob, weight_data_packed, bias_data, opt);
+        else
+            done = false;
+    }
 
-        const int channels_g = channels / group;
+    if (!done)
+    {
+        const int maxk = kernel_w * kernel_h;
 
-// quantize, scale and round to nearest
-#pragma omp parallel for num_threads(opt.num_threads)
-        for (int g = 0; g < group; g++)
+        // kernel offsets
+        std::vector<int> _space_ofs(maxk);
+        int* space_ofs = &_space_ofs[0];
         {
-            Option opt_g = opt;
-            opt_g.num_threads = 1;
-            opt_g.blob_allocator = bottom_blob_unbordered.allocator;
+            int p1 = 0;
+            int p2 = 0;
+            int gap = w * dilation_h - kernel_w * dilation_w;
+            for (int i = 0; i < kernel_h; i++)
+            {
+                for (int j = 0; j < kernel_w; j++)
+                {
+                    space_ofs[p1] = p2 * elempack;
+                    p1++;
+                    p2 += dilation_w;
+                }
+                p2 += gap;
+            }
+        }
 
-            const Mat bottom_blob_g = bottom_blob.channel_range(channels_g * g, channels_g);
-            Mat bottom_blob_int8_g = bottom_blob_unbordered.channel_range(channels_g * g, channels_g);
+        const float* bias = bias_data;
+
+        convdw_packed_x86_task task;
+        task.bottom_blob_bordered = bottom_blob_bordered;
+        task.top_blob = &top_blob;
+        task.weight_data_packed = weight_data_packed;
+        task.outw = outw;
+        task.outh = outh;
+        task.elempack = elempack;
+        task.stride_w = stride_w;
+        task.stride_h = stride_h;
+        task.maxk = maxk;
+        task.space_ofs = space_ofs;
+        task.bias = bias;
+        parallel_for(opt, channels, task);
+    }
 
-            quantize_float32_to_int8(bottom_blob_g, bottom_blob_int8_g, bottom_blob_int8_scales[g], opt_g);
-        }
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
     }
 
-    Mat bottom_blob_bordered = bottom_blob_unbordered;
-    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0)
+    return 0;
+#else
+    (void)bottom_blob;
+    (void)top_blob;
+    (void)opt;
+    return -1;
+#endif // __SSE2__
+}
+
+namespace {
+
+// one group of the int8 quantization
+class convdw_quantize_x86_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
     {
-        Option opt_b = opt;
-        opt_b.blob_allocator = opt.workspace_allocator;
-        copy_make_border(bottom_blob_unbordered, bottom_blob_bordered, pad_top, pad_bottom, pad_left, pad_right, BORDER_CONSTANT, pad_value, opt_b);
+        Option opt_g = opt;
+        opt_g.num_threads = 1;
+        opt_g.blob_allocator = bottom_blob_unbordered->allocator;
+
+        const Mat bottom_blob_g = bottom_blob.channel_range(channels_g * g, channels_g);
+        Mat bottom_blob_int8_g = bottom_blob_unbordered->channel_range(channels_g * g, channels_g);
+
+        quantize_float32_to_int8(bottom_blob_g, bottom_blob_int8_g, bottom_blob_int8_scales[g], opt_g);
     }
-    else if (pad_left == -233 && pad_right == -233 && pad_top == -233 && pad_bottom == -233)
+
+    Mat bottom_blob;
+    Mat* bottom_blob_unbordered;
+    int channels_g;
+    Mat bottom_blob_int8_scales;
+    Option opt;
+};
+
+// one channel of the int8 vnni dequantize or requantize
+class convdw_int8_vnni_output_x86_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
     {
-        int wpad = kernel_extent_w + (w - 1) / stride_w * stride_w - w;
-        int hpad = kernel_extent_h + (h - 1) / stride_h * stride_h - h;
-        if (wpad > 0 || hpad > 0)
+        const int* intptr = top_blob_int32.channel(g);
+
+        float scale_in;
+        if (weight_data_int8_scales[g] == 0)
+            scale_in = 0;
+        else
+            scale_in = 1.f / (bottom_blob_int8_scales[g] * weight_data_int8_scales[g]);
+
+        const float bias = bias_term ? bias_data[g] : 0.f;
+
+        if (use_int8_requantize)
         {
-            Option opt_b = opt;
-            opt_b.blob_allocator = opt.workspace_allocator;
-            copy_make_border(bottom_blob_unbordered, bottom_blob_bordered, hpad / 2, hpad - hpad / 2, wpad / 2, wpad - wpad / 2, BORDER_CONSTANT, pad_value, opt_b);
+            signed char* ptr = top_blob->channel(g);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = float2int8((intptr[i] * scale_in + bias) * top_blob_int8_scale);
+            }
         }
-    }
-    else if (pad_left == -234 && pad_right == -234 && pad_top == -234 && pad_bottom == -234)
-    {
-        int wpad = kernel_extent_w + (w - 1) / stride_w * stride_w - w;
-        int hpad = kernel_extent_h + (h - 1) / stride_h * stride_h - h;
-        if (wpad > 0 || hpad > 0)
+        else
         {
-            Option opt_b = opt;
-            opt_b.blob_allocator = opt.workspace_allocator;
-            copy_make_border(bottom_blob_unbordered, bottom_blob_bordered, hpad - hpad / 2, hpad / 2, wpad - wpad / 2, wpad / 2, BORDER_CONSTANT, pad_value, opt_b);
+            float* ptr = top_blob->channel(g);
+
+            for (int i = 0; i < size; i++)
+            {
+                ptr[i] = intptr[i] * scale_in + bias;
+            }
         }
     }
+
+    Mat top_blob_int32;
+    Mat* top_blob;
+    int size;
+    Mat weight_data_int8_scales;
+    Mat bottom_blob_int8_scales;
+    int bias_term;
+    Mat bias_data;
+    bool use_int8_requantize;
+    float top_blob_int8_scale;
+};
+
+// one group of the group convolution
+class convdw_group_x86_task : public ParallelTask
+{
+public:
+    void operator()(int g) const
+    {
+        const Mat bottom_blob_bordered_g = bottom_blob_bordered.channel_range(channels_g * g, channels_g);
+        Mat top_blob_g = top_blob->channel_range(num_output_g * g, num_output_g);
+
+        const ncnn::Layer *op = group_ops[g];
+
+        Option opt_g = opt;
+        opt_g.blob_allocator = top_blob->allocator;
+
+        // forward
+        op->forward(bottom_blob_bordered_g, top_blob_g, opt_g);
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int channels_g;
+    int num_output_g;
+    ncnn::Layer* const* group_ops;
+    Option opt;
+};
+
+} // namespace
+
+int ConvolutionDepthWise_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    Mat bottom_blob_unbordered = bottom_blob;
+    if (elemsize != 1)
+    {
+        bottom_blob_unbordered.create(w, h, channels, (size_t)1u, opt.workspace_allocator);
+        if (bottom_blob_unbordered.empty())
+            return -100;
+
+        const int channels_g = channels / group;
+
+// quantize, scale and round to nearest
+        convdw_quantize_x86_task task;
+        task.bottom_blob = bottom_blob;
+        task.bottom_blob_unbordered = &bottom_blob_unbordered;
+        task.channels_g = channels_g;
+        task.bottom_blob_int8_scales = bottom_blob_int8_scales;
+        task.opt = opt;
+        parallel_for(opt, group, task);
+    }
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob_unbordered, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
         return -100;
 
@@ -374,6 +826,46 @@ int ConvolutionDepthWise_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_
     // depth-wise
     if (channels == group && group == num_output)
     {
+        if (!weight_int8_vnni.empty())
+        {
+            // dequantize writes back in place, requantize goes through an int32 workspace
+            Mat top_blob_int32 = top_blob;
+            if (use_int8_requantize)
+            {
+                top_blob_int32.create(outw, outh, num_output, (size_t)4u, opt.workspace_allocator);
+                if (top_blob_int32.empty())
+                    return -100;
+            }
+
+#if NCNN_AVX512VNNI && __AVX512F__
+            convdw_int8_avx512vnni(bottom_blob_bordered, top_blob_int32, weight_int8_vnni, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__
+#if NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+            convdw_int8_avxvnni(bottom_blob_bordered, top_blob_int32, weight_int8_vnni, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+#endif // NCNN_AVXVNNI && __AVX2__ && !__AVX512F__
+
+            const int size = outw * outh;
+
+            convdw_int8_vnni_output_x86_task task;
+            task.top_blob_int32 = top_blob_int32;
+            task.top_blob = &top_blob;
+            task.size = size;
+            task.weight_data_int8_scales = weight_data_int8_scales;
+            task.bottom_blob_int8_scales = bottom_blob_int8_scales;
+            task.bias_term = bias_term;
+            task.bias_data = bias_data;
+            task.use_int8_requantize = use_int8_requantize;
+            task.top_blob_int8_scale = top_blob_int8_scale;
+            parallel_for(opt, group, task);
+
+            if (activation)
+            {
+                activation->forward_inplace(top_blob, opt);
+            }
+
+            return 0;
+        }
+
         if (use_int8_requantize)
         {
             std::vector<float> requantize_scales;
@@ -455,20 +947,14 @@ int ConvolutionDepthWise_x86::forward_int8_x86(const Mat &bottom_blob, Mat &top_
     const int channels_g = channels / group;
     const int num_output_g = num_output / group;
 
-#pragma omp parallel for num_threads(opt.num_threads)
-    for (int g = 0; g < group; g++)
-    {
-        const Mat bottom_blob_bordered_g = bottom_blob_bordered.channel_range(channels_g * g, channels_g);
-        Mat top_blob_g = top_blob.channel_range(num_output_g * g, num_output_g);
-
-        const ncnn::Layer *op = group_ops[g];
-
-        Option opt_g = opt;
-        opt_g.blob_allocator = top_blob.allocator;
-
-        // forward
-        op->forward(bottom_blob_bordered_g, top_blob_g, opt_g);
-    }
+    convdw_group_x86_task task;
+    task.bottom_blob_bordered = bottom_blob_bordered;
+    task.top_blob = &top_blob;
+    task.channels_g = channels_g;
+    task.num_output_g = num_output_g;
+    task.group_ops = &group_ops[0];
+    task.opt = opt;
+    parallel_for(opt, group, task);
 
     return 0;
 }
@@ -30,11 +30,19 @@ public:
     virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 protected:
+    void make_padding(const Mat& bottom_blob, Mat& bottom_blob_bordered, const Option& opt) const;
+    int forward_packed_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
     int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 public:
     Layer* activation;
     std::vector<ncnn::Layer*> group_ops;
+
+    // packed layout
+    Mat weight_data_packed;
+
+    // int8 vnni
+    Mat weight_int8_vnni;
 };
 
 } // namespace ncnn
@@ -0,0 +1,38 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// int8 kernels built with avx512vnni, called from the layer after a runtime cpu check
+
+#include "mat.h"
+#include "option.h"
+#include "threadpool.h"
+
+#include <immintrin.h>
+#include <vector>
+
+namespace ncnn {
+
+#include "convolutiondepthwise_int8_vnni.h"
+
+void convdw_transform_kernel_int8_avx512vnni(const Mat& kernel, Mat& kernel_tm, int channels, int maxk)
+{
+    convdw_transform_kernel_int8_vnni(kernel, kernel_tm, channels, maxk);
+}
+
+void convdw_int8_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    convdw_int8_vnni(bottom_blob, top_blob, kernel_tm, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+}
+
+} // namespace ncnn
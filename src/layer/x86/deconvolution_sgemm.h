@@ -0,0 +1,158 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// deconvolution as sgemm + col2im
+//   col = kernel^T x bottom, one col row per (output channel, kernel offset)
+//   every col row is then accumulated into the output plane at its kernel offset
+
+static void deconv_sgemm_transform_kernel_sse(const Mat& _kernel, Mat& kernel_tm, int inch, int outch, int maxk, Allocator* allocator)
+{
+    const float* kernel = _kernel;
+
+    // col row r = p * maxk + k needs kernel[p][q][k] for every input channel q
+    const int M = outch * maxk;
+
+    Mat kernel_reordered(inch, M);
+
+    for (int r = 0; r < M; r++)
+    {
+        int p = r / maxk;
+        int k = r % maxk;
+
+        float* ptr = kernel_reordered.row(r);
+
+        for (int q = 0; q < inch; q++)
+        {
+            ptr[q] = kernel[(p * inch + q) * maxk + k];
+        }
+    }
+
+    x86_sgemm_pack_a(kernel_reordered, inch, M, inch, kernel_tm, allocator);
+}
+
+static int deconv_sgemm_sse(const Mat& bottom_blob, Mat& col, const Mat& kernel_tm, int M, const Option& opt)
+{
+    const int N = bottom_blob.w * bottom_blob.h;
+    const int K = bottom_blob.c;
+
+    return x86_sgemm(M, N, K, kernel_tm, 1, (const float*)bottom_blob, bottom_blob.cstep, 1, col, N, 1, 0, opt);
+}
+
+// outptr[j * stride] += ptr[j] * scale
+static void deconv_scatter_add(float* outptr, const float* ptr, float scale, int n, int stride)
+{
+    int j = 0;
+    if (stride == 1)
+    {
+#if __AVX__
+        __m256 _scale_avx = _mm256_set1_ps(scale);
+        for (; j + 7 < n; j += 8)
+        {
+            _mm256_storeu_ps(outptr + j, _mm256_comp_fmadd_ps(_mm256_loadu_ps(ptr + j), _scale_avx, _mm256_loadu_ps(outptr + j)));
+        }
+#endif // __AVX__
+#if __SSE2__
+        __m128 _scale = _mm_set1_ps(scale);
+        for (; j + 3 < n; j += 4)
+        {
+            _mm_storeu_ps(outptr + j, _mm_comp_fmadd_ps(_mm_loadu_ps(ptr + j), _scale, _mm_loadu_ps(outptr + j)));
+        }
+#endif // __SSE2__
+    }
+    for (; j < n; j++)
+    {
+        outptr[j * stride] += ptr[j] * scale;
+    }
+}
+
+// outptr[j * 2] += ptr0[j] * scale0 and outptr[j * 2 + 1] += ptr1[j] * scale1
+// two neighbouring kernel columns of a stride-2 deconvolution fill one contiguous run
+static void deconv_scatter_add_s2_pair(float* outptr, const float* ptr0, const float* ptr1, float scale0, float scale1, int n)
+{
+    int j = 0;
+#if __AVX__
+    __m256 _scale0_avx = _mm256_set1_ps(scale0);
+    __m256 _scale1_avx = _mm256_set1_ps(scale1);
+    for (; j + 7 < n; j += 8)
+    {
+        __m256 _p0 = _mm256_mul_ps(_mm256_loadu_ps(ptr0 + j), _scale0_avx);
+        __m256 _p1 = _mm256_mul_ps(_mm256_loadu_ps(ptr1 + j), _scale1_avx);
+        __m256 _lo = _mm256_unpacklo_ps(_p0, _p1);
+        __m256 _hi = _mm256_unpackhi_ps(_p0, _p1);
+        __m256 _r0 = _mm256_permute2f128_ps(_lo, _hi, _MM_SHUFFLE(0, 2, 0, 0));
+        __m256 _r1 = _mm256_permute2f128_ps(_lo, _hi, _MM_SHUFFLE(0, 3, 0, 1));
+
+        float* outp = outptr + j * 2;
+        _mm256_storeu_ps(outp, _mm256_add_ps(_mm256_loadu_ps(outp), _r0));
+        _mm256_storeu_ps(outp + 8, _mm256_add_ps(_mm256_loadu_ps(outp + 8), _r1));
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _scale0 = _mm_set1_ps(scale0);
+    __m128 _scale1 = _mm_set1_ps(scale1);
+    for (; j + 3 < n; j += 4)
+    {
+        __m128 _p0 = _mm_mul_ps(_mm_loadu_ps(ptr0 + j), _scale0);
+        __m128 _p1 = _mm_mul_ps(_mm_loadu_ps(ptr1 + j), _scale1);
+        __m128 _r0 = _mm_unpacklo_ps(_p0, _p1);
+        __m128 _r1 = _mm_unpackhi_ps(_p0, _p1);
+
+        float* outp = outptr + j * 2;
+        _mm_storeu_ps(outp, _mm_add_ps(_mm_loadu_ps(outp), _r0));
+        _mm_storeu_ps(outp + 4, _mm_add_ps(_mm_loadu_ps(outp + 4), _r1));
+    }
+#endif // __SSE2__
+    for (; j < n; j++)
+    {
+        outptr[j * 2] += ptr0[j] * scale0;
+        outptr[j * 2 + 1] += ptr1[j] * scale1;
+    }
+}
+
+// accumulate maxk planes of w x h into one output plane at their kernel offsets
+// plane k starts at colptr + k * kstep and is scaled by kernel[k], or by 1 without kernel
+static void deconv_col2im_sse(const float* colptr, int kstep, const float* kernel, Mat& out, int w, int h, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h)
+{
+    for (int y = 0; y < kernel_h; y++)
+    {
+        for (int i = 0; i < h; i++)
+        {
+            float* outptr = out.row(i * stride_h + y * dilation_h);
+
+            int x = 0;
+            if (stride_w == 2 && dilation_w == 1)
+            {
+                // 2x2, 3x3, 4x4 stride 2 upsampling hits this path
+                for (; x + 1 < kernel_w; x += 2)
+                {
+                    const int k = y * kernel_w + x;
+                    const float* ptr0 = colptr + k * kstep + i * w;
+                    const float* ptr1 = colptr + (k + 1) * kstep + i * w;
+                    const float scale0 = kernel ? kernel[k] : 1.f;
+                    const float scale1 = kernel ? kernel[k + 1] : 1.f;
+
+                    deconv_scatter_add_s2_pair(outptr + x, ptr0, ptr1, scale0, scale1, w);
+                }
+            }
+            for (; x < kernel_w; x++)
+            {
+                const int k = y * kernel_w + x;
+                const float* ptr = colptr + k * kstep + i * w;
+                const float scale = kernel ? kernel[k] : 1.f;
+
+                deconv_scatter_add(outptr + x * dilation_w, ptr, scale, w, stride_w);
+            }
+        }
+    }
+}
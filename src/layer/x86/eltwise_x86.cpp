@@ -0,0 +1,273 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "eltwise_x86.h"
+
+#include <algorithm>
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(Eltwise_x86)
+
+Eltwise_x86::Eltwise_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+#endif // __SSE2__
+}
+
+namespace Eltwise_x86_functor {
+
+struct eltwise_op_prod
+{
+    float operator()(const float &x, const float &y) const { return x * y; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_mul_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_mul_ps(x, y); }
+#endif
+};
+
+struct eltwise_op_sum
+{
+    float operator()(const float &x, const float &y) const { return x + y; }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_add_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_add_ps(x, y); }
+#endif
+};
+
+struct eltwise_op_max
+{
+    float operator()(const float &x, const float &y) const { return std::max(x, y); }
+#if __SSE2__
+    __m128 operator()(const __m128 &x, const __m128 &y) const { return _mm_max_ps(x, y); }
+#endif
+#if __AVX__
+    __m256 operator()(const __m256 &x, const __m256 &y) const { return _mm256_max_ps(x, y); }
+#endif
+};
+
+} // namespace Eltwise_x86_functor
+
+// outptr[i] = op(ptr[i], ptr1[i])
+template<typename Op>
+static void eltwise_op(const float *ptr, const float *ptr1, float *outptr, int size)
+{
+    Op op;
+
+    int i = 0;
+#if __AVX__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(outptr, op(_mm256_loadu_ps(ptr), _mm256_loadu_ps(ptr1)));
+        ptr += 8;
+        ptr1 += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(outptr, op(_mm_loadu_ps(ptr), _mm_loadu_ps(ptr1)));
+        ptr += 4;
+        ptr1 += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr = op(*ptr, *ptr1);
+        ptr++;
+        ptr1++;
+        outptr++;
+    }
+}
+
+// outptr[i] = ptr[i] * coeff + ptr1[i] * coeff1
+static void eltwise_sum_coeff(const float *ptr, float coeff, const float *ptr1, float coeff1, float *outptr, int size)
+{
+    int i = 0;
+#if __AVX__
+    __m256 _coeff_avx = _mm256_set1_ps(coeff);
+    __m256 _coeff1_avx = _mm256_set1_ps(coeff1);
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_mul_ps(_mm256_loadu_ps(ptr), _coeff_avx);
+        _mm256_storeu_ps(outptr, _mm256_comp_fmadd_ps(_mm256_loadu_ps(ptr1), _coeff1_avx, _p));
+        ptr += 8;
+        ptr1 += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _coeff = _mm_set1_ps(coeff);
+    __m128 _coeff1 = _mm_set1_ps(coeff1);
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_mul_ps(_mm_loadu_ps(ptr), _coeff);
+        _mm_storeu_ps(outptr, _mm_comp_fmadd_ps(_mm_loadu_ps(ptr1), _coeff1, _p));
+        ptr += 4;
+        ptr1 += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr = *ptr * coeff + *ptr1 * coeff1;
+        ptr++;
+        ptr1++;
+        outptr++;
+    }
+}
+
+namespace {
+
+// one channel of top_blob = op(a, b)
+template<typename Op>
+class eltwise_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        eltwise_op<Op>(a.channel(q), b.channel(q), top_blob->channel(q), size);
+    }
+
+    Mat a;
+    Mat b;
+    Mat *top_blob;
+    int size;
+};
+
+// one channel of top_blob = a * coeff0 + b * coeff1
+class eltwise_sum_coeff_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        eltwise_sum_coeff(a.channel(q), coeff0, b.channel(q), coeff1, top_blob->channel(q), size);
+    }
+
+    Mat a;
+    float coeff0;
+    Mat b;
+    float coeff1;
+    Mat *top_blob;
+    int size;
+};
+
+} // namespace
+
+template<typename Op>
+static void eltwise(const std::vector<Mat> &bottom_blobs, Mat &top_blob, const Option &opt)
+{
+    const Mat &bottom_blob = bottom_blobs[0];
+    int channels = bottom_blob.c;
+    int size = bottom_blob.w * bottom_blob.h * bottom_blob.elempack;
+
+    // first blob
+    eltwise_task<Op> task;
+    task.a = bottom_blob;
+    task.b = bottom_blobs[1];
+    task.top_blob = &top_blob;
+    task.size = size;
+    parallel_for(opt, channels, task);
+
+    task.a = top_blob;
+    for (size_t b = 2; b < bottom_blobs.size(); b++)
+    {
+        task.b = bottom_blobs[b];
+        parallel_for(opt, channels, task);
+    }
+}
+
+int Eltwise_x86::forward(const std::vector<Mat> &bottom_blobs, std::vector<Mat> &top_blobs, const Option &opt) const
+{
+    const Mat &bottom_blob = bottom_blobs[0];
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+    int size = w * h * elempack;
+
+    Mat &top_blob = top_blobs[0];
+    top_blob.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    using namespace Eltwise_x86_functor;
+
+    if (op_type == Operation_PROD)
+    {
+        eltwise<eltwise_op_prod>(bottom_blobs, top_blob, opt);
+    }
+    else if (op_type == Operation_SUM)
+    {
+        if (coeffs.w == 0)
+        {
+            eltwise<eltwise_op_sum>(bottom_blobs, top_blob, opt);
+        }
+        else
+        {
+            // first blob
+            eltwise_sum_coeff_task task;
+            task.a = bottom_blob;
+            task.coeff0 = coeffs[0];
+            task.b = bottom_blobs[1];
+            task.coeff1 = coeffs[1];
+            task.top_blob = &top_blob;
+            task.size = size;
+            parallel_for(opt, channels, task);
+
+            task.a = top_blob;
+            task.coeff0 = 1.f;
+            for (size_t b = 2; b < bottom_blobs.size(); b++)
+            {
+                task.b = bottom_blobs[b];
+                task.coeff1 = coeffs[b];
+                parallel_for(opt, channels, task);
+            }
+        }
+    }
+    else if (op_type == Operation_MAX)
+    {
+        eltwise<eltwise_op_max>(bottom_blobs, top_blob, opt);
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,122 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "elu_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+#include <math.h>
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(ELU_x86)
+
+ELU_x86::ELU_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+#endif // __SSE2__
+}
+
+namespace {
+
+// one channel of ELU_x86::forward_inplace
+class ELU_x86_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = bottom_top_blob->channel(q);
+
+        int i = 0;
+#if __AVX__
+        __m256 _zero_avx = _mm256_setzero_ps();
+        __m256 _one_avx = _mm256_set1_ps(1.f);
+        __m256 _alpha_avx = _mm256_set1_ps(alpha);
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr);
+            __m256 _nps = _mm256_mul_ps(_alpha_avx, _mm256_sub_ps(exp256_ps(_p), _one_avx));
+            _p = _mm256_blendv_ps(_p, _nps, _mm256_cmp_ps(_p, _zero_avx, _CMP_LT_OQ));
+            _mm256_storeu_ps(ptr, _p);
+
+            ptr += 8;
+        }
+#endif // __AVX__
+#if __SSE2__
+        __m128 _zero = _mm_setzero_ps();
+        __m128 _one = _mm_set1_ps(1.f);
+        __m128 _alpha = _mm_set1_ps(alpha);
+        for (; i + 3 < size; i += 4)
+        {
+            __m128 _p = _mm_loadu_ps(ptr);
+            __m128 _nps = _mm_mul_ps(_alpha, _mm_sub_ps(exp_ps(_p), _one));
+            _p = _mm_comp_blendv_ps(_p, _nps, _mm_cmplt_ps(_p, _zero));
+            _mm_storeu_ps(ptr, _p);
+
+            ptr += 4;
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            if (*ptr < 0.f)
+                *ptr = static_cast<float>(alpha * (exp(*ptr) - 1.f));
+
+            ptr++;
+        }
+    }
+
+    Mat* bottom_top_blob;
+    int size;
+    float alpha;
+};
+
+} // namespace
+
+int ELU_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int channels = bottom_top_blob.c;
+    int elempack = bottom_top_blob.elempack;
+    int size = w * h * elempack;
+
+    ELU_x86_task task;
+    task.bottom_top_blob = &bottom_top_blob;
+    task.size = size;
+    task.alpha = alpha;
+    parallel_for(opt, channels, task);
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,136 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "hardsigmoid_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(HardSigmoid_x86)
+
+HardSigmoid_x86::HardSigmoid_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+#endif // __SSE2__
+}
+
+namespace {
+
+// one channel of HardSigmoid_x86::forward_inplace
+class HardSigmoid_x86_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = bottom_top_blob->channel(q);
+
+        int i = 0;
+#if __AVX__
+        __m256 _zero_avx = _mm256_setzero_ps();
+        __m256 _one_avx = _mm256_set1_ps(1.f);
+        __m256 _alpha_avx = _mm256_set1_ps(alpha);
+        __m256 _beta_avx = _mm256_set1_ps(beta);
+        __m256 _lower_avx = _mm256_set1_ps(lower);
+        __m256 _upper_avx = _mm256_set1_ps(upper);
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr);
+            __m256 _outp = _mm256_comp_fmadd_ps(_p, _alpha_avx, _beta_avx);
+            _outp = _mm256_blendv_ps(_outp, _zero_avx, _mm256_cmp_ps(_p, _lower_avx, _CMP_LT_OQ));
+            _outp = _mm256_blendv_ps(_outp, _one_avx, _mm256_cmp_ps(_p, _upper_avx, _CMP_GT_OQ));
+            _mm256_storeu_ps(ptr, _outp);
+
+            ptr += 8;
+        }
+#endif // __AVX__
+#if __SSE2__
+        __m128 _zero = _mm_setzero_ps();
+        __m128 _one = _mm_set1_ps(1.f);
+        __m128 _alpha = _mm_set1_ps(alpha);
+        __m128 _beta = _mm_set1_ps(beta);
+        __m128 _lower = _mm_set1_ps(lower);
+        __m128 _upper = _mm_set1_ps(upper);
+        for (; i + 3 < size; i += 4)
+        {
+            __m128 _p = _mm_loadu_ps(ptr);
+            __m128 _outp = _mm_comp_fmadd_ps(_p, _alpha, _beta);
+            _outp = _mm_comp_blendv_ps(_outp, _zero, _mm_cmplt_ps(_p, _lower));
+            _outp = _mm_comp_blendv_ps(_outp, _one, _mm_cmpgt_ps(_p, _upper));
+            _mm_storeu_ps(ptr, _outp);
+
+            ptr += 4;
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            if (*ptr < lower)
+                *ptr = 0.f;
+            else if (*ptr > upper)
+                *ptr = 1.f;
+            else
+                *ptr = *ptr * alpha + beta;
+
+            ptr++;
+        }
+    }
+
+    Mat* bottom_top_blob;
+    int size;
+    float alpha;
+    float beta;
+    float lower;
+    float upper;
+};
+
+} // namespace
+
+int HardSigmoid_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int channels = bottom_top_blob.c;
+    int elempack = bottom_top_blob.elempack;
+    int size = w * h * elempack;
+
+    HardSigmoid_x86_task task;
+    task.bottom_top_blob = &bottom_top_blob;
+    task.size = size;
+    task.alpha = alpha;
+    task.beta = beta;
+    task.lower = lower;
+    task.upper = upper;
+    parallel_for(opt, channels, task);
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,308 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "innerproduct_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "x86_usability.h"
+#include "layer_type.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+#include "x86_sgemm.h"
+
+DEFINE_LAYER_CREATOR(InnerProduct_x86)
+
+InnerProduct_x86::InnerProduct_x86()
+{
+    support_bf16_storage = true;
+    support_batch = true;
+
+    activation = 0;
+    weight_sgemm_type = 1;
+}
+
+int InnerProduct_x86::create_pipeline(const Option &opt)
+{
+    if (activation_type == 1)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::ReLU);
+
+        ncnn::ParamDict pd;
+        activation->load_param(pd);
+    }
+    else if (activation_type == 2)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::ReLU);
+
+        ncnn::ParamDict pd;
+        pd.set(0, activation_params[0]); // slope
+        activation->load_param(pd);
+    }
+    else if (activation_type == 3)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::Clip);
+
+        ncnn::ParamDict pd;
+        pd.set(0, activation_params[0]); // min
+        pd.set(1, activation_params[1]); // max
+        activation->load_param(pd);
+    }
+    else if (activation_type == 4)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::Sigmoid);
+
+        ncnn::ParamDict pd;
+        activation->load_param(pd);
+    }
+
+    if (activation)
+    {
+        activation->create_pipeline(opt);
+    }
+
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        // int8 goes through the reference implementation
+        support_bf16_storage = false;
+        support_batch = false;
+        return 0;
+    }
+
+    const int num_input = weight_data_size / num_output;
+
+    weight_sgemm_type = 1;
+
+    x86_sgemm_pack_a(weight_data, num_input, num_output, num_input, weight_sgemm_data, opt.weight_allocator);
+    if (weight_sgemm_data.empty())
+        return -100;
+
+    if (opt.use_weight_fp16_storage || opt.use_bf16_storage)
+    {
+        if (opt.use_bf16_storage)
+            x86_sgemm_cast_a_bf16(weight_sgemm_data, opt);
+        else
+            x86_sgemm_cast_a_fp16(weight_sgemm_data, opt);
+        if (weight_sgemm_data.empty())
+            return -100;
+
+        // forward may run with other options than these, the type is fixed here
+        weight_sgemm_type = opt.use_bf16_storage ? 4 : 2;
+
+        // forward reads the packed weights only from here on
+        weight_data.release();
+    }
+
+    return 0;
+}
+
+int InnerProduct_x86::destroy_pipeline(const Option &opt)
+{
+    if (activation)
+    {
+        activation->destroy_pipeline(opt);
+        delete activation;
+        activation = 0;
+    }
+
+    weight_sgemm_data.release();
+
+    return 0;
+}
+
+int InnerProduct_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        return InnerProduct::forward(bottom_blob, top_blob, opt);
+    }
+
+    if (opt.use_bf16_storage && bottom_blob.elemsize == 2u * bottom_blob.elempack)
+    {
+        return forward_bf16_x86(bottom_blob, top_blob, opt);
+    }
+
+    const int num_input = weight_data_size / num_output;
+
+    if (bottom_blob.dims == 2 && bottom_blob.w == num_input && bottom_blob.h > 1)
+    {
+        return forward_gemm_x86(bottom_blob, top_blob, opt);
+    }
+
+    // flatten, the channel gaps of a 3-dim blob are squeezed out
+    Mat bottom_blob_flattened = bottom_blob.reshape(bottom_blob.w * bottom_blob.h * bottom_blob.c, opt.workspace_allocator);
+    if (bottom_blob_flattened.empty())
+        return -100;
+
+    size_t elemsize = bottom_blob.elemsize;
+
+    top_blob.create(num_output, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // matrix-vector product, the input vector is the single column of B
+    int ret = x86_sgemm(num_output, 1, num_input, weight_sgemm_data, weight_sgemm_type, (const float*)bottom_blob_flattened, num_input, num_input, top_blob, num_output, num_output, bias_term ? (const float*)bias_data : 0, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
+int InnerProduct_x86::forward_gemm_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    const int num_input = bottom_blob.w;
+    const int h = bottom_blob.h;
+    size_t elemsize = bottom_blob.elemsize;
+
+    top_blob.create(num_output, h, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // every input row is a column of B and every output row a column of C
+    int ret = x86_sgemm(num_output, h, num_input, weight_sgemm_data, weight_sgemm_type, (const float*)bottom_blob, num_input, num_input, top_blob, num_output, num_output, bias_term ? (const float*)bias_data : 0, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
+int InnerProduct_x86::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+    const int batch = bottom_blobs.size();
+
+    // flattened fp32 vectors only, 2-dim inputs with rows keep their own gemm
+    bool fold = batch > 1 && !weight_sgemm_data.empty();
+    for (int b = 0; fold && b < batch; b++)
+    {
+        const Mat& m = bottom_blobs[b];
+        fold = m.elemsize == 4u && m.elempack == 1 && m.w * m.h * m.c == num_input && !(m.dims == 2 && m.h > 1);
+    }
+
+    if (!fold)
+        return InnerProduct::forward_batch(bottom_blobs, top_blobs, opt);
+
+    // every item is a column of B, weights are streamed once for all of them
+    Mat bottom_batch(num_input, batch, (size_t)4u, opt.workspace_allocator);
+    if (bottom_batch.empty())
+        return -100;
+
+    for (int b = 0; b < batch; b++)
+    {
+        const Mat& m = bottom_blobs[b];
+        const int size = m.w * m.h;
+
+        float* outptr = bottom_batch.row(b);
+        for (int q = 0; q < m.c; q++)
+        {
+            memcpy(outptr + size * q, m.channel(q), size * sizeof(float));
+        }
+    }
+
+    Mat top_batch(num_output, batch, (size_t)4u, opt.workspace_allocator);
+    if (top_batch.empty())
+        return -100;
+
+    int ret = x86_sgemm(num_output, batch, num_input, weight_sgemm_data, weight_sgemm_type, (const float*)bottom_batch, num_input, num_input, top_batch, num_output, num_output, bias_term ? (const float*)bias_data : 0, opt);
+    if (ret != 0)
+        return ret;
+
+    top_blobs.resize(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b].create(num_output, (size_t)4u, opt.blob_allocator);
+        if (top_blobs[b].empty())
+            return -100;
+
+        memcpy(top_blobs[b], top_batch.row(b), num_output * sizeof(float));
+
+        if (activation)
+        {
+            activation->forward_inplace(top_blobs[b], opt);
+        }
+    }
+
+    return 0;
+}
+
+int InnerProduct_x86::forward_bf16_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    const float* bias = bias_term ? (const float*)bias_data : 0;
+
+    // bf16 in, fp32 accumulation, bf16 out
+    Mat top_blob_fp32;
+    if (bottom_blob.dims == 2 && bottom_blob.w == num_input && bottom_blob.h > 1)
+    {
+        const int h = bottom_blob.h;
+
+        top_blob_fp32.create(num_output, h, (size_t)4u, opt.workspace_allocator);
+        if (top_blob_fp32.empty())
+            return -100;
+
+        int ret = x86_sgemm(num_output, h, num_input, weight_sgemm_data, weight_sgemm_type, (const unsigned short*)bottom_blob, num_input, num_input, top_blob_fp32, num_output, num_output, bias, opt);
+        if (ret != 0)
+            return ret;
+    }
+    else
+    {
+        Mat bottom_blob_flattened = bottom_blob.reshape(bottom_blob.w * bottom_blob.h * bottom_blob.c, opt.workspace_allocator);
+        if (bottom_blob_flattened.empty())
+            return -100;
+
+        top_blob_fp32.create(num_output, (size_t)4u, opt.workspace_allocator);
+        if (top_blob_fp32.empty())
+            return -100;
+
+        int ret = x86_sgemm(num_output, 1, num_input, weight_sgemm_data, weight_sgemm_type, (const unsigned short*)bottom_blob_flattened, num_input, num_input, top_blob_fp32, num_output, num_output, bias, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    if (activation)
+    {
+        Option opt_ws = opt;
+        opt_ws.blob_allocator = opt.workspace_allocator;
+
+        activation->forward_inplace(top_blob_fp32, opt_ws);
+    }
+
+    cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,371 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "padding_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+#if __SSE2__
+#include "padding_pack4.h"
+#endif
+#if __AVX__
+#include "padding_pack8.h"
+#endif
+#if __AVX512F__
+#include "padding_pack16.h"
+#endif
+
+DEFINE_LAYER_CREATOR(Padding_x86)
+
+Padding_x86::Padding_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#if __AVX512F__
+    preferred_elempack = 16;
+#endif // __AVX512F__
+#endif // __SSE2__
+}
+
+namespace {
+
+#if __AVX512F__
+// one channel of a pack16 Padding_x86::forward
+class Padding_x86_pack16_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob.channel(q);
+        Mat borderm = top_blob->channel(q);
+
+        __m512 pad_value = per_channel_pad_data_size ? _mm512_loadu_ps((const float*)per_channel_pad_data + q * 16) : _mm512_set1_ps(value);
+
+        if (type == 0)
+            padding_constant_pack16_avx512(m, borderm, top, bottom, left, right, pad_value);
+        else if (type == 1)
+            padding_replicate_pack16_avx512(m, borderm, top, bottom, left, right);
+        else // if (type == 2)
+            padding_reflect_pack16_avx512(m, borderm, top, bottom, left, right);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* per_channel_pad_data;
+    int per_channel_pad_data_size;
+    float value;
+    int type;
+    int top;
+    int bottom;
+    int left;
+    int right;
+};
+#endif // __AVX512F__
+
+#if __AVX__
+// one channel of a pack8 Padding_x86::forward
+class Padding_x86_pack8_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob.channel(q);
+        Mat borderm = top_blob->channel(q);
+
+        __m256 pad_value = per_channel_pad_data_size ? _mm256_loadu_ps((const float*)per_channel_pad_data + q * 8) : _mm256_set1_ps(value);
+
+        if (type == 0)
+            padding_constant_pack8_avx(m, borderm, top, bottom, left, right, pad_value);
+        else if (type == 1)
+            padding_replicate_pack8_avx(m, borderm, top, bottom, left, right);
+        else // if (type == 2)
+            padding_reflect_pack8_avx(m, borderm, top, bottom, left, right);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* per_channel_pad_data;
+    int per_channel_pad_data_size;
+    float value;
+    int type;
+    int top;
+    int bottom;
+    int left;
+    int right;
+};
+#endif // __AVX__
+
+#if __SSE2__
+// one channel of a pack4 Padding_x86::forward
+class Padding_x86_pack4_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob.channel(q);
+        Mat borderm = top_blob->channel(q);
+
+        __m128 pad_value = per_channel_pad_data_size ? _mm_loadu_ps((const float*)per_channel_pad_data + q * 4) : _mm_set1_ps(value);
+
+        if (type == 0)
+            padding_constant_pack4_sse(m, borderm, top, bottom, left, right, pad_value);
+        else if (type == 1)
+            padding_replicate_pack4_sse(m, borderm, top, bottom, left, right);
+        else // if (type == 2)
+            padding_reflect_pack4_sse(m, borderm, top, bottom, left, right);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    const float* per_channel_pad_data;
+    int per_channel_pad_data_size;
+    float value;
+    int type;
+    int top;
+    int bottom;
+    int left;
+    int right;
+};
+#endif // __SSE2__
+
+} // namespace
+
+int Padding_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    if (top == 0 && bottom == 0 && left == 0 && right == 0)
+    {
+        top_blob = bottom_blob;
+        return 0;
+    }
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int dims = bottom_blob.dims;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        int outw = w + left + right;
+
+        if (dims == 1)
+        {
+            top_blob.create(outw, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack16_avx512(bottom_blob, top_blob, 0, 0, left, right, _mm512_set1_ps(value));
+            else if (type == 1)
+                padding_replicate_pack16_avx512(bottom_blob, top_blob, 0, 0, left, right);
+            else // if (type == 2)
+                padding_reflect_pack16_avx512(bottom_blob, top_blob, 0, 0, left, right);
+
+            return 0;
+        }
+
+        int outh = h + top + bottom;
+
+        if (dims == 2)
+        {
+            top_blob.create(outw, outh, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack16_avx512(bottom_blob, top_blob, top, bottom, left, right, _mm512_set1_ps(value));
+            else if (type == 1)
+                padding_replicate_pack16_avx512(bottom_blob, top_blob, top, bottom, left, right);
+            else // if (type == 2)
+                padding_reflect_pack16_avx512(bottom_blob, top_blob, top, bottom, left, right);
+
+            return 0;
+        }
+
+        if (dims == 3)
+        {
+            top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            Padding_x86_pack16_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.per_channel_pad_data = per_channel_pad_data;
+            task.per_channel_pad_data_size = per_channel_pad_data_size;
+            task.value = value;
+            task.type = type;
+            task.top = top;
+            task.bottom = bottom;
+            task.left = left;
+            task.right = right;
+            parallel_for(opt, channels, task);
+
+            return 0;
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
+
+#if __AVX__
+    if (elempack == 8)
+    {
+        int outw = w + left + right;
+
+        if (dims == 1)
+        {
+            top_blob.create(outw, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack8_avx(bottom_blob, top_blob, 0, 0, left, right, _mm256_set1_ps(value));
+            else if (type == 1)
+                padding_replicate_pack8_avx(bottom_blob, top_blob, 0, 0, left, right);
+            else // if (type == 2)
+                padding_reflect_pack8_avx(bottom_blob, top_blob, 0, 0, left, right);
+
+            return 0;
+        }
+
+        int outh = h + top + bottom;
+
+        if (dims == 2)
+        {
+            top_blob.create(outw, outh, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack8_avx(bottom_blob, top_blob, top, bottom, left, right, _mm256_set1_ps(value));
+            else if (type == 1)
+                padding_replicate_pack8_avx(bottom_blob, top_blob, top, bottom, left, right);
+            else // if (type == 2)
+                padding_reflect_pack8_avx(bottom_blob, top_blob, top, bottom, left, right);
+
+            return 0;
+        }
+
+        if (dims == 3)
+        {
+            top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            Padding_x86_pack8_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.per_channel_pad_data = per_channel_pad_data;
+            task.per_channel_pad_data_size = per_channel_pad_data_size;
+            task.value = value;
+            task.type = type;
+            task.top = top;
+            task.bottom = bottom;
+            task.left = left;
+            task.right = right;
+            parallel_for(opt, channels, task);
+
+            return 0;
+        }
+
+        return 0;
+    }
+#endif // __AVX__
+
+#if __SSE2__
+    if (elempack == 4)
+    {
+        int outw = w + left + right;
+
+        if (dims == 1)
+        {
+            top_blob.create(outw, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack4_sse(bottom_blob, top_blob, 0, 0, left, right, _mm_set1_ps(value));
+            else if (type == 1)
+                padding_replicate_pack4_sse(bottom_blob, top_blob, 0, 0, left, right);
+            else // if (type == 2)
+                padding_reflect_pack4_sse(bottom_blob, top_blob, 0, 0, left, right);
+
+            return 0;
+        }
+
+        int outh = h + top + bottom;
+
+        if (dims == 2)
+        {
+            top_blob.create(outw, outh, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack4_sse(bottom_blob, top_blob, top, bottom, left, right, _mm_set1_ps(value));
+            else if (type == 1)
+                padding_replicate_pack4_sse(bottom_blob, top_blob, top, bottom, left, right);
+            else // if (type == 2)
+                padding_reflect_pack4_sse(bottom_blob, top_blob, top, bottom, left, right);
+
+            return 0;
+        }
+
+        if (dims == 3)
+        {
+            top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            Padding_x86_pack4_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.per_channel_pad_data = per_channel_pad_data;
+            task.per_channel_pad_data_size = per_channel_pad_data_size;
+            task.value = value;
+            task.type = type;
+            task.top = top;
+            task.bottom = bottom;
+            task.left = left;
+            task.right = right;
+            parallel_for(opt, channels, task);
+
+            return 0;
+        }
+
+        return 0;
+    }
+#endif // __SSE2__
+
+    return Padding::forward(bottom_blob, top_blob, opt);
+}
+
+} // namespace ncnn
@@ -0,0 +1,171 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+namespace {
+
+// one channel of pooling2x2s2_max_sse
+class pooling2x2s2_max_sse_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0;
+        const float* r1 = img0 + w;
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+#if __SSE2__
+            for (; j + 3 < outw; j += 4)
+            {
+                __m128 _max0 = _mm_max_ps(_mm_loadu_ps(r0), _mm_loadu_ps(r1));
+                __m128 _max1 = _mm_max_ps(_mm_loadu_ps(r0 + 4), _mm_loadu_ps(r1 + 4));
+
+                // max of even and odd columns
+                __m128 _max = _mm_max_ps(_mm_shuffle_ps(_max0, _max1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(_max0, _max1, _MM_SHUFFLE(3, 1, 3, 1)));
+                _mm_storeu_ps(outptr, _max);
+
+                r0 += 8;
+                r1 += 8;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j < outw; j++)
+            {
+                float max0 = std::max(r0[0], r0[1]);
+                float max1 = std::max(r1[0], r1[1]);
+
+                *outptr = std::max(max0, max1);
+
+                r0 += 2;
+                r1 += 2;
+                outptr++;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+};
+
+} // namespace
+
+static void pooling2x2s2_max_sse(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = w - 2 * outw + w;
+
+    pooling2x2s2_max_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    parallel_for(opt, inch, task);
+}
+
+namespace {
+
+// one channel of pooling2x2s2_avg_sse
+class pooling2x2s2_avg_sse_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0;
+        const float* r1 = img0 + w;
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+#if __SSE2__
+            __m128 _inv_maxk = _mm_set1_ps(0.25f);
+            for (; j + 3 < outw; j += 4)
+            {
+                __m128 _sum0 = _mm_add_ps(_mm_loadu_ps(r0), _mm_loadu_ps(r1));
+                __m128 _sum1 = _mm_add_ps(_mm_loadu_ps(r0 + 4), _mm_loadu_ps(r1 + 4));
+
+                // sum of even and odd columns
+                __m128 _sum = _mm_add_ps(_mm_shuffle_ps(_sum0, _sum1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(_sum0, _sum1, _MM_SHUFFLE(3, 1, 3, 1)));
+                _mm_storeu_ps(outptr, _mm_mul_ps(_sum, _inv_maxk));
+
+                r0 += 8;
+                r1 += 8;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j < outw; j++)
+            {
+                float sum = r0[0] + r0[1] + r1[0] + r1[1];
+
+                *outptr = sum * 0.25f;
+
+                r0 += 2;
+                r1 += 2;
+                outptr++;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+};
+
+} // namespace
+
+static void pooling2x2s2_avg_sse(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = w - 2 * outw + w;
+
+    pooling2x2s2_avg_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    parallel_for(opt, inch, task);
+}
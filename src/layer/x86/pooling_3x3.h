@@ -0,0 +1,386 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __SSE2__
+// r[0..2], r[2..4], r[4..6], r[6..8] for 4 consecutive stride-2 windows
+static inline void pooling3x3s2_load_row_sse(const float* r, __m128& _e, __m128& _o, __m128& _e2)
+{
+    __m128 _r0 = _mm_loadu_ps(r);
+    __m128 _r4 = _mm_loadu_ps(r + 4);
+
+    _e = _mm_shuffle_ps(_r0, _r4, _MM_SHUFFLE(2, 0, 2, 0));
+    _o = _mm_shuffle_ps(_r0, _r4, _MM_SHUFFLE(3, 1, 3, 1));
+
+    __m128 _e8 = _mm_move_ss(_e, _mm_load_ss(r + 8));
+    _e2 = _mm_shuffle_ps(_e8, _e8, _MM_SHUFFLE(0, 3, 2, 1));
+}
+#endif // __SSE2__
+
+namespace {
+
+// one channel of pooling3x3s1_max_sse
+class pooling3x3s1_max_sse_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0;
+        const float* r1 = img0 + w;
+        const float* r2 = img0 + w * 2;
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+#if __SSE2__
+            for (; j + 3 < outw; j += 4)
+            {
+                __m128 _max0 = _mm_max_ps(_mm_max_ps(_mm_loadu_ps(r0), _mm_loadu_ps(r0 + 1)), _mm_loadu_ps(r0 + 2));
+                __m128 _max1 = _mm_max_ps(_mm_max_ps(_mm_loadu_ps(r1), _mm_loadu_ps(r1 + 1)), _mm_loadu_ps(r1 + 2));
+                __m128 _max2 = _mm_max_ps(_mm_max_ps(_mm_loadu_ps(r2), _mm_loadu_ps(r2 + 1)), _mm_loadu_ps(r2 + 2));
+
+                _mm_storeu_ps(outptr, _mm_max_ps(_mm_max_ps(_max0, _max1), _max2));
+
+                r0 += 4;
+                r1 += 4;
+                r2 += 4;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j < outw; j++)
+            {
+                float max0 = std::max(std::max(r0[0], r0[1]), r0[2]);
+                float max1 = std::max(std::max(r1[0], r1[1]), r1[2]);
+                float max2 = std::max(std::max(r2[0], r2[1]), r2[2]);
+
+                *outptr = std::max(std::max(max0, max1), max2);
+
+                r0++;
+                r1++;
+                r2++;
+                outptr++;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+            r2 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+};
+
+} // namespace
+
+static void pooling3x3s1_max_sse(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = w - outw;
+
+    pooling3x3s1_max_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    parallel_for(opt, inch, task);
+}
+
+namespace {
+
+// one channel of pooling3x3s1_avg_sse
+class pooling3x3s1_avg_sse_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0;
+        const float* r1 = img0 + w;
+        const float* r2 = img0 + w * 2;
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+#if __SSE2__
+            __m128 _inv_maxk = _mm_set1_ps(inv_maxk);
+            for (; j + 3 < outw; j += 4)
+            {
+                __m128 _sum0 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(r0), _mm_loadu_ps(r0 + 1)), _mm_loadu_ps(r0 + 2));
+                __m128 _sum1 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(r1), _mm_loadu_ps(r1 + 1)), _mm_loadu_ps(r1 + 2));
+                __m128 _sum2 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(r2), _mm_loadu_ps(r2 + 1)), _mm_loadu_ps(r2 + 2));
+
+                __m128 _sum = _mm_add_ps(_mm_add_ps(_sum0, _sum1), _sum2);
+                _mm_storeu_ps(outptr, _mm_mul_ps(_sum, _inv_maxk));
+
+                r0 += 4;
+                r1 += 4;
+                r2 += 4;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j < outw; j++)
+            {
+                float sum0 = r0[0] + r0[1] + r0[2];
+                float sum1 = r1[0] + r1[1] + r1[2];
+                float sum2 = r2[0] + r2[1] + r2[2];
+
+                *outptr = (sum0 + sum1 + sum2) * inv_maxk;
+
+                r0++;
+                r1++;
+                r2++;
+                outptr++;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+            r2 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    float inv_maxk;
+};
+
+} // namespace
+
+static void pooling3x3s1_avg_sse(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = w - outw;
+
+    const float inv_maxk = 1.f / 9;
+
+    pooling3x3s1_avg_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.inv_maxk = inv_maxk;
+    parallel_for(opt, inch, task);
+}
+
+namespace {
+
+// one channel of pooling3x3s2_max_sse
+class pooling3x3s2_max_sse_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0;
+        const float* r1 = img0 + w;
+        const float* r2 = img0 + w * 2;
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+#if __SSE2__
+            for (; j + 3 < outw; j += 4)
+            {
+                __m128 _e0, _o0, _e20;
+                __m128 _e1, _o1, _e21;
+                __m128 _e2, _o2, _e22;
+                pooling3x3s2_load_row_sse(r0, _e0, _o0, _e20);
+                pooling3x3s2_load_row_sse(r1, _e1, _o1, _e21);
+                pooling3x3s2_load_row_sse(r2, _e2, _o2, _e22);
+
+                __m128 _max0 = _mm_max_ps(_mm_max_ps(_e0, _o0), _e20);
+                __m128 _max1 = _mm_max_ps(_mm_max_ps(_e1, _o1), _e21);
+                __m128 _max2 = _mm_max_ps(_mm_max_ps(_e2, _o2), _e22);
+
+                _mm_storeu_ps(outptr, _mm_max_ps(_mm_max_ps(_max0, _max1), _max2));
+
+                r0 += 8;
+                r1 += 8;
+                r2 += 8;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j < outw; j++)
+            {
+                float max0 = std::max(std::max(r0[0], r0[1]), r0[2]);
+                float max1 = std::max(std::max(r1[0], r1[1]), r1[2]);
+                float max2 = std::max(std::max(r2[0], r2[1]), r2[2]);
+
+                *outptr = std::max(std::max(max0, max1), max2);
+
+                r0 += 2;
+                r1 += 2;
+                r2 += 2;
+                outptr++;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+            r2 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+};
+
+} // namespace
+
+static void pooling3x3s2_max_sse(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = w - 2 * outw + w;
+
+    pooling3x3s2_max_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    parallel_for(opt, inch, task);
+}
+
+namespace {
+
+// one channel of pooling3x3s2_avg_sse
+class pooling3x3s2_avg_sse_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float* img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0;
+        const float* r1 = img0 + w;
+        const float* r2 = img0 + w * 2;
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+#if __SSE2__
+            __m128 _inv_maxk = _mm_set1_ps(inv_maxk);
+            for (; j + 3 < outw; j += 4)
+            {
+                __m128 _e0, _o0, _e20;
+                __m128 _e1, _o1, _e21;
+                __m128 _e2, _o2, _e22;
+                pooling3x3s2_load_row_sse(r0, _e0, _o0, _e20);
+                pooling3x3s2_load_row_sse(r1, _e1, _o1, _e21);
+                pooling3x3s2_load_row_sse(r2, _e2, _o2, _e22);
+
+                __m128 _sum0 = _mm_add_ps(_mm_add_ps(_e0, _o0), _e20);
+                __m128 _sum1 = _mm_add_ps(_mm_add_ps(_e1, _o1), _e21);
+                __m128 _sum2 = _mm_add_ps(_mm_add_ps(_e2, _o2), _e22);
+
+                __m128 _sum = _mm_add_ps(_mm_add_ps(_sum0, _sum1), _sum2);
+                _mm_storeu_ps(outptr, _mm_mul_ps(_sum, _inv_maxk));
+
+                r0 += 8;
+                r1 += 8;
+                r2 += 8;
+                outptr += 4;
+            }
+#endif // __SSE2__
+            for (; j < outw; j++)
+            {
+                float sum0 = r0[0] + r0[1] + r0[2];
+                float sum1 = r1[0] + r1[1] + r1[2];
+                float sum2 = r2[0] + r2[1] + r2[2];
+
+                *outptr = (sum0 + sum1 + sum2) * inv_maxk;
+
+                r0 += 2;
+                r1 += 2;
+                r2 += 2;
+                outptr++;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+            r2 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int w;
+    int outw;
+    int outh;
+    int tailstep;
+    float inv_maxk;
+};
+
+} // namespace
+
+static void pooling3x3s2_avg_sse(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = w - 2 * outw + w;
+
+    const float inv_maxk = 1.f / 9;
+
+    pooling3x3s2_avg_sse_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.w = w;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    task.inv_maxk = inv_maxk;
+    parallel_for(opt, inch, task);
+}
@@ -0,0 +1,82 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+namespace {
+
+// one channel of pooling3x3s2_max_pack8_avx
+class pooling3x3s2_max_pack8_avx_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat img0 = bottom_blob.channel(q);
+        float* outptr = top_blob->channel(q);
+
+        const float* r0 = img0.row(0);
+        const float* r1 = img0.row(1);
+        const float* r2 = img0.row(2);
+
+        for (int i = 0; i < outh; i++)
+        {
+            // the right column of one window is the left column of the next
+            __m256 _max_left = _mm256_max_ps(_mm256_max_ps(_mm256_loadu_ps(r0), _mm256_loadu_ps(r1)), _mm256_loadu_ps(r2));
+
+            for (int j = 0; j < outw; j++)
+            {
+                __m256 _max_mid = _mm256_max_ps(_mm256_max_ps(_mm256_loadu_ps(r0 + 8), _mm256_loadu_ps(r1 + 8)), _mm256_loadu_ps(r2 + 8));
+                __m256 _max_right = _mm256_max_ps(_mm256_max_ps(_mm256_loadu_ps(r0 + 16), _mm256_loadu_ps(r1 + 16)), _mm256_loadu_ps(r2 + 16));
+
+                _mm256_storeu_ps(outptr, _mm256_max_ps(_mm256_max_ps(_max_left, _max_mid), _max_right));
+
+                _max_left = _max_right;
+
+                r0 += 16;
+                r1 += 16;
+                r2 += 16;
+                outptr += 8;
+            }
+
+            r0 += tailstep;
+            r1 += tailstep;
+            r2 += tailstep;
+        }
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int tailstep;
+};
+
+} // namespace
+
+static void pooling3x3s2_max_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int inch = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+
+    const int tailstep = (w - 2 * outw + w) * 8;
+
+    pooling3x3s2_max_pack8_avx_task task;
+    task.bottom_blob = bottom_blob;
+    task.top_blob = &top_blob;
+    task.outw = outw;
+    task.outh = outh;
+    task.tailstep = tailstep;
+    parallel_for(opt, inch, task);
+}
@@ -0,0 +1,983 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "pooling_x86.h"
+
+#include <float.h>
+#include <algorithm>
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+#include "pooling_2x2.h"
+#include "pooling_3x3.h"
+
+#if __SSE2__
+#include "pooling_2x2_pack4.h"
+#include "pooling_3x3_pack4.h"
+#endif
+#if __AVX__
+#include "pooling_2x2_pack8.h"
+#include "pooling_3x3_pack8.h"
+#endif
+
+DEFINE_LAYER_CREATOR(Pooling_x86)
+
+Pooling_x86::Pooling_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#endif // __SSE2__
+}
+
+namespace {
+
+#if __AVX__
+// one channel of a pack8 max Pooling_x86::forward
+class Pooling_x86_max_pack8_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob_bordered.channel(q);
+        float *outptr = top_blob->channel(q);
+
+        for (int i = 0; i < outh; i++)
+        {
+            for (int j = 0; j < outw; j++)
+            {
+                const float *sptr = m.row(i * stride_h) + j * stride_w * 8;
+
+                __m256 _max = _mm256_loadu_ps(sptr);
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    __m256 _val = _mm256_loadu_ps(sptr + space_ofs[k] * 8);
+                    _max = _mm256_max_ps(_max, _val);
+                }
+
+                _mm256_storeu_ps(outptr + j * 8, _max);
+            }
+
+            outptr += outw * 8;
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int stride_w;
+    int stride_h;
+    int maxk;
+    const int* space_ofs;
+};
+
+// one channel of a pack8 average Pooling_x86::forward without the padding in the area
+class Pooling_x86_avg_pack8_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob_bordered.channel(q);
+        float *outptr = top_blob->channel(q);
+
+        for (int i = 0; i < outh; i++)
+        {
+            int sy0 = i * stride_h;
+
+            for (int j = 0; j < outw; j++)
+            {
+                int sx0 = j * stride_w;
+
+                __m256 _sum = _mm256_setzero_ps();
+                int area = 0;
+
+                for (int ki = 0; ki < kernel_h; ki++)
+                {
+                    int sy = sy0 + ki;
+
+                    if (sy < pad_top)
+                        continue;
+
+                    if (sy >= h - pad_bottom - htailpad)
+                        break;
+
+                    for (int kj = 0; kj < kernel_w; kj++)
+                    {
+                        int sx = sx0 + kj;
+
+                        if (sx < pad_left)
+                            continue;
+
+                        if (sx >= w - pad_right - wtailpad)
+                            break;
+
+                        __m256 _val = _mm256_loadu_ps(m.row(sy) + sx * 8);
+                        _sum = _mm256_add_ps(_sum, _val);
+                        area += 1;
+                    }
+                }
+
+                __m256 _inv_area = _mm256_set1_ps(1.f / area);
+                __m256 _avg = _mm256_mul_ps(_sum, _inv_area);
+                _mm256_storeu_ps(outptr + j * 8, _avg);
+            }
+
+            outptr += outw * 8;
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int stride_w;
+    int stride_h;
+    int kernel_w;
+    int kernel_h;
+    int w;
+    int h;
+    int pad_left;
+    int pad_right;
+    int pad_top;
+    int pad_bottom;
+    int wtailpad;
+    int htailpad;
+};
+
+// one channel of a pack8 average Pooling_x86::forward with the padding in the area
+class Pooling_x86_avg_include_pad_pack8_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob_bordered.channel(q);
+        float *outptr = top_blob->channel(q);
+
+        __m256 _inv_maxk = _mm256_set1_ps(1.f / maxk);
+
+        for (int i = 0; i < outh; i++)
+        {
+            for (int j = 0; j < outw; j++)
+            {
+                const float *sptr = m.row(i * stride_h) + j * stride_w * 8;
+
+                __m256 _sum = _mm256_setzero_ps();
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    __m256 _val = _mm256_loadu_ps(sptr + space_ofs[k] * 8);
+                    _sum = _mm256_add_ps(_sum, _val);
+                }
+
+                __m256 _avg = _mm256_mul_ps(_sum, _inv_maxk);
+                _mm256_storeu_ps(outptr + j * 8, _avg);
+            }
+
+            outptr += outw * 8;
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int stride_w;
+    int stride_h;
+    int maxk;
+    const int* space_ofs;
+};
+#endif // __AVX__
+
+#if __SSE2__
+// one channel of a pack4 max Pooling_x86::forward
+class Pooling_x86_max_pack4_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob_bordered.channel(q);
+        float *outptr = top_blob->channel(q);
+
+        for (int i = 0; i < outh; i++)
+        {
+            for (int j = 0; j < outw; j++)
+            {
+                const float *sptr = m.row(i * stride_h) + j * stride_w * 4;
+
+                __m128 _max = _mm_loadu_ps(sptr);
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    __m128 _val = _mm_loadu_ps(sptr + space_ofs[k] * 4);
+                    _max = _mm_max_ps(_max, _val);
+                }
+
+                _mm_storeu_ps(outptr + j * 4, _max);
+            }
+
+            outptr += outw * 4;
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int stride_w;
+    int stride_h;
+    int maxk;
+    const int* space_ofs;
+};
+
+// one channel of a pack4 average Pooling_x86::forward without the padding in the area
+class Pooling_x86_avg_pack4_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob_bordered.channel(q);
+        float *outptr = top_blob->channel(q);
+
+        for (int i = 0; i < outh; i++)
+        {
+            int sy0 = i * stride_h;
+
+            for (int j = 0; j < outw; j++)
+            {
+                int sx0 = j * stride_w;
+
+                __m128 _sum = _mm_setzero_ps();
+                int area = 0;
+
+                for (int ki = 0; ki < kernel_h; ki++)
+                {
+                    int sy = sy0 + ki;
+
+                    if (sy < pad_top)
+                        continue;
+
+                    if (sy >= h - pad_bottom - htailpad)
+                        break;
+
+                    for (int kj = 0; kj < kernel_w; kj++)
+                    {
+                        int sx = sx0 + kj;
+
+                        if (sx < pad_left)
+                            continue;
+
+                        if (sx >= w - pad_right - wtailpad)
+                            break;
+
+                        __m128 _val = _mm_loadu_ps(m.row(sy) + sx * 4);
+                        _sum = _mm_add_ps(_sum, _val);
+                        area += 1;
+                    }
+                }
+
+                __m128 _inv_area = _mm_set1_ps(1.f / area);
+                __m128 _avg = _mm_mul_ps(_sum, _inv_area);
+                _mm_storeu_ps(outptr + j * 4, _avg);
+            }
+
+            outptr += outw * 4;
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int stride_w;
+    int stride_h;
+    int kernel_w;
+    int kernel_h;
+    int w;
+    int h;
+    int pad_left;
+    int pad_right;
+    int pad_top;
+    int pad_bottom;
+    int wtailpad;
+    int htailpad;
+};
+
+// one channel of a pack4 average Pooling_x86::forward with the padding in the area
+class Pooling_x86_avg_include_pad_pack4_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const Mat m = bottom_blob_bordered.channel(q);
+        float *outptr = top_blob->channel(q);
+
+        __m128 _inv_maxk = _mm_set1_ps(1.f / maxk);
+
+        for (int i = 0; i < outh; i++)
+        {
+            for (int j = 0; j < outw; j++)
+            {
+                const float *sptr = m.row(i * stride_h) + j * stride_w * 4;
+
+                __m128 _sum = _mm_setzero_ps();
+
+                for (int k = 0; k < maxk; k++)
+                {
+                    __m128 _val = _mm_loadu_ps(sptr + space_ofs[k] * 4);
+                    _sum = _mm_add_ps(_sum, _val);
+                }
+
+                __m128 _avg = _mm_mul_ps(_sum, _inv_maxk);
+                _mm_storeu_ps(outptr + j * 4, _avg);
+            }
+
+            outptr += outw * 4;
+        }
+    }
+
+    Mat bottom_blob_bordered;
+    Mat* top_blob;
+    int outw;
+    int outh;
+    int stride_w;
+    int stride_h;
+    int maxk;
+    const int* space_ofs;
+};
+#endif // __SSE2__
+
+} // namespace
+
+int Pooling_x86::forward(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    // max value in NxN window
+    // avg value in NxN window
+
+    if (global_pooling)
+    {
+        return forward_global_x86(bottom_blob, top_blob, opt);
+    }
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+#if __SSE2__
+    if (elempack != 1)
+    {
+        Mat bottom_blob_bordered;
+        int wtailpad = 0;
+        int htailpad = 0;
+        make_padding(bottom_blob, bottom_blob_bordered, wtailpad, htailpad, opt);
+        if (bottom_blob_bordered.empty())
+            return -100;
+
+        w = bottom_blob_bordered.w;
+        h = bottom_blob_bordered.h;
+
+        int outw = (w - kernel_w) / stride_w + 1;
+        int outh = (h - kernel_h) / stride_h + 1;
+
+        top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        const int maxk = kernel_w * kernel_h;
+
+        // kernel offsets
+        std::vector<int> _space_ofs(maxk);
+        int *space_ofs = &_space_ofs[0];
+        {
+            int p1 = 0;
+            int p2 = 0;
+            int gap = w - kernel_w;
+            for (int i = 0; i < kernel_h; i++)
+            {
+                for (int j = 0; j < kernel_w; j++)
+                {
+                    space_ofs[p1] = p2;
+                    p1++;
+                    p2++;
+                }
+                p2 += gap;
+            }
+        }
+
+#if __AVX__
+        if (elempack == 8)
+        {
+            if (pooling_type == PoolMethod_MAX)
+            {
+                if (kernel_w == 2 && kernel_h == 2 && stride_w == 2 && stride_h == 2)
+                {
+                    pooling2x2s2_max_pack8_avx(bottom_blob_bordered, top_blob, opt);
+
+                    return 0;
+                }
+
+                if (kernel_w == 3 && kernel_h == 3 && stride_w == 2 && stride_h == 2)
+                {
+                    pooling3x3s2_max_pack8_avx(bottom_blob_bordered, top_blob, opt);
+
+                    return 0;
+                }
+
+                Pooling_x86_max_pack8_task task;
+                task.bottom_blob_bordered = bottom_blob_bordered;
+                task.top_blob = &top_blob;
+                task.outw = outw;
+                task.outh = outh;
+                task.stride_w = stride_w;
+                task.stride_h = stride_h;
+                task.maxk = maxk;
+                task.space_ofs = space_ofs;
+                parallel_for(opt, channels, task);
+            }
+            else if (pooling_type == PoolMethod_AVE)
+            {
+                if (avgpool_count_include_pad == 0)
+                {
+                    Pooling_x86_avg_pack8_task task;
+                    task.bottom_blob_bordered = bottom_blob_bordered;
+                    task.top_blob = &top_blob;
+                    task.outw = outw;
+                    task.outh = outh;
+                    task.stride_w = stride_w;
+                    task.stride_h = stride_h;
+                    task.kernel_w = kernel_w;
+                    task.kernel_h = kernel_h;
+                    task.w = w;
+                    task.h = h;
+                    task.pad_left = pad_left;
+                    task.pad_right = pad_right;
+                    task.pad_top = pad_top;
+                    task.pad_bottom = pad_bottom;
+                    task.wtailpad = wtailpad;
+                    task.htailpad = htailpad;
+                    parallel_for(opt, channels, task);
+                }
+                else // if (avgpool_count_include_pad == 1)
+                {
+                    Pooling_x86_avg_include_pad_pack8_task task;
+                    task.bottom_blob_bordered = bottom_blob_bordered;
+                    task.top_blob = &top_blob;
+                    task.outw = outw;
+                    task.outh = outh;
+                    task.stride_w = stride_w;
+                    task.stride_h = stride_h;
+                    task.maxk = maxk;
+                    task.space_ofs = space_ofs;
+                    parallel_for(opt, channels, task);
+                }
+            }
+
+            return 0;
+        }
+#endif // __AVX__
+
+        if (elempack == 4)
+        {
+            if (pooling_type == PoolMethod_MAX)
+            {
+                if (kernel_w == 2 && kernel_h == 2 && stride_w == 2 && stride_h == 2)
+                {
+                    pooling2x2s2_max_pack4_sse(bottom_blob_bordered, top_blob, opt);
+
+                    return 0;
+                }
+
+                if (kernel_w == 3 && kernel_h == 3 && stride_w == 2 && stride_h == 2)
+                {
+                    pooling3x3s2_max_pack4_sse(bottom_blob_bordered, top_blob, opt);
+
+                    return 0;
+                }
+
+                Pooling_x86_max_pack4_task task;
+                task.bottom_blob_bordered = bottom_blob_bordered;
+                task.top_blob = &top_blob;
+                task.outw = outw;
+                task.outh = outh;
+                task.stride_w = stride_w;
+                task.stride_h = stride_h;
+                task.maxk = maxk;
+                task.space_ofs = space_ofs;
+                parallel_for(opt, channels, task);
+            }
+            else if (pooling_type == PoolMethod_AVE)
+            {
+                if (avgpool_count_include_pad == 0)
+                {
+                    Pooling_x86_avg_pack4_task task;
+                    task.bottom_blob_bordered = bottom_blob_bordered;
+                    task.top_blob = &top_blob;
+                    task.outw = outw;
+                    task.outh = outh;
+                    task.stride_w = stride_w;
+                    task.stride_h = stride_h;
+                    task.kernel_w = kernel_w;
+                    task.kernel_h = kernel_h;
+                    task.w = w;
+                    task.h = h;
+                    task.pad_left = pad_left;
+                    task.pad_right = pad_right;
+                    task.pad_top = pad_top;
+                    task.pad_bottom = pad_bottom;
+                    task.wtailpad = wtailpad;
+                    task.htailpad = htailpad;
+                    parallel_for(opt, channels, task);
+                }
+                else // if (avgpool_count_include_pad == 1)
+                {
+                    Pooling_x86_avg_include_pad_pack4_task task;
+                    task.bottom_blob_bordered = bottom_blob_bordered;
+                    task.top_blob = &top_blob;
+                    task.outw = outw;
+                    task.outh = outh;
+                    task.stride_w = stride_w;
+                    task.stride_h = stride_h;
+                    task.maxk = maxk;
+                    task.space_ofs = space_ofs;
+                    parallel_for(opt, channels, task);
+                }
+            }
+
+            return 0;
+        }
+    }
+#endif // __SSE2__
+
+    if (kernel_w != kernel_h || stride_w != stride_h)
+    {
+        return Pooling::forward(bottom_blob, top_blob, opt);
+    }
+
+    const int kernel_size = kernel_w;
+    const int stride = stride_w;
+
+    if (!(kernel_size == 2 && stride == 2) && !(kernel_size == 3 && (stride == 1 || stride == 2)))
+    {
+        return Pooling::forward(bottom_blob, top_blob, opt);
+    }
+
+    Mat bottom_blob_bordered;
+    int wtailpad = 0;
+    int htailpad = 0;
+    make_padding(bottom_blob, bottom_blob_bordered, wtailpad, htailpad, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    if (pooling_type == PoolMethod_AVE && avgpool_count_include_pad == 0 && (bottom_blob_bordered.w != w || bottom_blob_bordered.h != h))
+    {
+        // the window area differs on the border, leave it to the reference implementation
+        return Pooling::forward(bottom_blob, top_blob, opt);
+    }
+
+    w = bottom_blob_bordered.w;
+    h = bottom_blob_bordered.h;
+
+    int outw = (w - kernel_w) / stride_w + 1;
+    int outh = (h - kernel_h) / stride_h + 1;
+
+    top_blob.create(outw, outh, channels, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    if (pooling_type == PoolMethod_MAX)
+    {
+        if (kernel_size == 2)
+            pooling2x2s2_max_sse(bottom_blob_bordered, top_blob, opt);
+        else if (stride == 1)
+            pooling3x3s1_max_sse(bottom_blob_bordered, top_blob, opt);
+        else // if (stride == 2)
+            pooling3x3s2_max_sse(bottom_blob_bordered, top_blob, opt);
+    }
+    else if (pooling_type == PoolMethod_AVE)
+    {
+        if (kernel_size == 2)
+            pooling2x2s2_avg_sse(bottom_blob_bordered, top_blob, opt);
+        else if (stride == 1)
+            pooling3x3s1_avg_sse(bottom_blob_bordered, top_blob, opt);
+        else // if (stride == 2)
+            pooling3x3s2_avg_sse(bottom_blob_bordered, top_blob, opt);
+    }
+
+    return 0;
+}
+
+namespace {
+
+#if __AVX__
+// one channel of a pack8 max Pooling_x86::forward_global_x86
+class Pooling_x86_global_max_pack8_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = bottom_blob.channel(q);
+
+        __m256 _max = _mm256_loadu_ps(ptr);
+        for (int i = 0; i < size; i++)
+        {
+            __m256 _val = _mm256_loadu_ps(ptr);
+            _max = _mm256_max_ps(_max, _val);
+            ptr += 8;
+        }
+
+        float *outptr = *top_blob;
+        _mm256_storeu_ps(outptr + q * 8, _max);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+
+// one channel of a pack8 average Pooling_x86::forward_global_x86
+class Pooling_x86_global_avg_pack8_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = bottom_blob.channel(q);
+
+        __m256 _sum = _mm256_setzero_ps();
+        for (int i = 0; i < size; i++)
+        {
+            __m256 _val = _mm256_loadu_ps(ptr);
+            _sum = _mm256_add_ps(_sum, _val);
+            ptr += 8;
+        }
+
+        __m256 _inv_size = _mm256_set1_ps(1.f / size);
+        __m256 _avg = _mm256_mul_ps(_sum, _inv_size);
+
+        float *outptr = *top_blob;
+        _mm256_storeu_ps(outptr + q * 8, _avg);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+#endif // __AVX__
+
+#if __SSE2__
+// one channel of a pack4 max Pooling_x86::forward_global_x86
+class Pooling_x86_global_max_pack4_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = bottom_blob.channel(q);
+
+        __m128 _max = _mm_loadu_ps(ptr);
+        for (int i = 0; i < size; i++)
+        {
+            __m128 _val = _mm_loadu_ps(ptr);
+            _max = _mm_max_ps(_max, _val);
+            ptr += 4;
+        }
+
+        float *outptr = *top_blob;
+        _mm_storeu_ps(outptr + q * 4, _max);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+
+// one channel of a pack4 average Pooling_x86::forward_global_x86
+class Pooling_x86_global_avg_pack4_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = bottom_blob.channel(q);
+
+        __m128 _sum = _mm_setzero_ps();
+        for (int i = 0; i < size; i++)
+        {
+            __m128 _val = _mm_loadu_ps(ptr);
+            _sum = _mm_add_ps(_sum, _val);
+            ptr += 4;
+        }
+
+        __m128 _inv_size = _mm_set1_ps(1.f / size);
+        __m128 _avg = _mm_mul_ps(_sum, _inv_size);
+
+        float *outptr = *top_blob;
+        _mm_storeu_ps(outptr + q * 4, _avg);
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+#endif // __SSE2__
+
+// one channel of a max Pooling_x86::forward_global_x86
+class Pooling_x86_global_max_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = bottom_blob.channel(q);
+
+        float max = ptr[0];
+
+        int i = 0;
+#if __AVX__
+        __m256 _max8 = _mm256_set1_ps(max);
+        for (; i + 7 < size; i += 8)
+        {
+            _max8 = _mm256_max_ps(_max8, _mm256_loadu_ps(ptr));
+            ptr += 8;
+        }
+        max = _mm256_reduce_max_ps(_max8);
+#endif // __AVX__
+#if __SSE2__
+        __m128 _max4 = _mm_set1_ps(max);
+        for (; i + 3 < size; i += 4)
+        {
+            _max4 = _mm_max_ps(_max4, _mm_loadu_ps(ptr));
+            ptr += 4;
+        }
+        max = _mm_reduce_max_ps(_max4);
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            max = std::max(max, *ptr);
+            ptr++;
+        }
+
+        (*top_blob)[q] = max;
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+
+// one channel of an average Pooling_x86::forward_global_x86
+class Pooling_x86_global_avg_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        const float *ptr = bottom_blob.channel(q);
+
+        float sum = 0.f;
+
+        int i = 0;
+#if __AVX__
+        __m256 _sum8 = _mm256_setzero_ps();
+        for (; i + 7 < size; i += 8)
+        {
+            _sum8 = _mm256_add_ps(_sum8, _mm256_loadu_ps(ptr));
+            ptr += 8;
+        }
+        sum += _mm256_reduce_add_ps(_sum8);
+#endif // __AVX__
+#if __SSE2__
+        __m128 _sum4 = _mm_setzero_ps();
+        for (; i + 3 < size; i += 4)
+        {
+            _sum4 = _mm_add_ps(_sum4, _mm_loadu_ps(ptr));
+            ptr += 4;
+        }
+        sum += _mm_reduce_add_ps(_sum4);
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            sum += *ptr;
+            ptr++;
+        }
+
+        (*top_blob)[q] = sum / size;
+    }
+
+    Mat bottom_blob;
+    Mat* top_blob;
+    int size;
+};
+
+} // namespace
+
+int Pooling_x86::forward_global_x86(const Mat &bottom_blob, Mat &top_blob, const Option &opt) const
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    int size = w * h;
+
+    top_blob.create(channels, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+#if __AVX__
+    if (elempack == 8)
+    {
+        if (pooling_type == PoolMethod_MAX)
+        {
+            Pooling_x86_global_max_pack8_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.size = size;
+            parallel_for(opt, channels, task);
+        }
+        else if (pooling_type == PoolMethod_AVE)
+        {
+            Pooling_x86_global_avg_pack8_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.size = size;
+            parallel_for(opt, channels, task);
+        }
+
+        return 0;
+    }
+#endif // __AVX__
+
+#if __SSE2__
+    if (elempack == 4)
+    {
+        if (pooling_type == PoolMethod_MAX)
+        {
+            Pooling_x86_global_max_pack4_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.size = size;
+            parallel_for(opt, channels, task);
+        }
+        else if (pooling_type == PoolMethod_AVE)
+        {
+            Pooling_x86_global_avg_pack4_task task;
+            task.bottom_blob = bottom_blob;
+            task.top_blob = &top_blob;
+            task.size = size;
+            parallel_for(opt, channels, task);
+        }
+
+        return 0;
+    }
+#endif // __SSE2__
+
+    if (pooling_type == PoolMethod_MAX)
+    {
+        Pooling_x86_global_max_task task;
+        task.bottom_blob = bottom_blob;
+        task.top_blob = &top_blob;
+        task.size = size;
+        parallel_for(opt, channels, task);
+    }
+    else if (pooling_type == PoolMethod_AVE)
+    {
+        Pooling_x86_global_avg_task task;
+        task.bottom_blob = bottom_blob;
+        task.top_blob = &top_blob;
+        task.size = size;
+        parallel_for(opt, channels, task);
+    }
+
+    return 0;
+}
+
+void Pooling_x86::make_padding(const Mat &bottom_blob, Mat &bottom_blob_bordered, int &wtailpad, int &htailpad, const Option &opt) const
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+
+    bottom_blob_bordered = bottom_blob;
+
+    float pad_value = 0.f;
+    if (pooling_type == PoolMethod_MAX)
+    {
+        pad_value = -FLT_MAX;
+    }
+    else if (pooling_type == PoolMethod_AVE)
+    {
+        pad_value = 0.f;
+    }
+
+    wtailpad = 0;
+    htailpad = 0;
+
+    if (pad_mode == 0) // full padding
+    {
+        int wtail = (w + pad_left + pad_right - kernel_w) % stride_w;
+        int htail = (h + pad_top + pad_bottom - kernel_h) % stride_h;
+
+        if (wtail != 0)
+            wtailpad = stride_w - wtail;
+        if (htail != 0)
+            htailpad = stride_h - htail;
+
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        copy_make_border(bottom_blob, bottom_blob_bordered, pad_top, pad_bottom + htailpad, pad_left, pad_right + wtailpad, BORDER_CONSTANT, pad_value, opt_b);
+    }
+    else if (pad_mode == 1) // valid padding
+    {
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        copy_make_border(bottom_blob, bottom_blob_bordered, pad_top, pad_bottom, pad_left, pad_right, BORDER_CONSTANT, pad_value, opt_b);
+    }
+    else if (pad_mode == 2) // tensorflow padding=SAME or onnx padding=SAME_UPPER
+    {
+        int wpad = kernel_w + (w - 1) / stride_w * stride_w - w;
+        int hpad = kernel_h + (h - 1) / stride_h * stride_h - h;
+        if (wpad > 0 || hpad > 0)
+        {
+            Option opt_b = opt;
+            opt_b.blob_allocator = opt.workspace_allocator;
+            copy_make_border(bottom_blob, bottom_blob_bordered, hpad / 2, hpad - hpad / 2, wpad / 2, wpad - wpad / 2, BORDER_CONSTANT, pad_value, opt_b);
+        }
+    }
+    else if (pad_mode == 3) // onnx padding=SAME_LOWER
+    {
+        int wpad = kernel_w + (w - 1) / stride_w * stride_w - w;
+        int hpad = kernel_h + (h - 1) / stride_h * stride_h - h;
+        if (wpad > 0 || hpad > 0)
+        {
+            Option opt_b = opt;
+            opt_b.blob_allocator = opt.workspace_allocator;
+            copy_make_border(bottom_blob, bottom_blob_bordered, hpad - hpad / 2, hpad / 2, wpad - wpad / 2, wpad / 2, BORDER_CONSTANT, pad_value, opt_b);
+        }
+    }
+}
+
+} // namespace ncnn
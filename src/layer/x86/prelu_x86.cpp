@@ -0,0 +1,196 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "prelu_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(PReLU_x86)
+
+PReLU_x86::PReLU_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#endif // __SSE2__
+}
+
+// negative elements are multiplied by slope[i % 8]
+static void prelu_inplace(float *ptr, const float *slope, int size)
+{
+    int i = 0;
+#if __AVX__
+    __m256 _zero_avx = _mm256_setzero_ps();
+    __m256 _slope_avx = _mm256_loadu_ps(slope);
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_loadu_ps(ptr);
+        __m256 _lemask = _mm256_cmp_ps(_p, _zero_avx, _CMP_LT_OQ);
+        _p = _mm256_blendv_ps(_p, _mm256_mul_ps(_p, _slope_avx), _lemask);
+        _mm256_storeu_ps(ptr, _p);
+
+        ptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _zero = _mm_setzero_ps();
+    __m128 _slope = _mm_loadu_ps(slope);
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_loadu_ps(ptr);
+        __m128 _lemask = _mm_cmplt_ps(_p, _zero);
+        _p = _mm_comp_blendv_ps(_p, _mm_mul_ps(_p, _slope), _lemask);
+        _mm_storeu_ps(ptr, _p);
+
+        ptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        if (*ptr < 0)
+            *ptr *= slope[i % 8];
+
+        ptr++;
+    }
+}
+
+namespace {
+
+// one row or channel of PReLU_x86::forward_inplace
+class PReLU_x86_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = dims == 2 ? bottom_top_blob->row(q) : (float *)bottom_top_blob->channel(q);
+
+        // lane values repeated to a full register, elempack divides 8
+        float slope[8];
+        for (int k = 0; k < 8; k++)
+        {
+            slope[k] = num_slope > 1 ? slope_ptr[q * elempack + k % elempack] : slope_ptr[0];
+        }
+
+        prelu_inplace(ptr, slope, size);
+    }
+
+    Mat* bottom_top_blob;
+    const float* slope_ptr;
+    int num_slope;
+    int dims;
+    int elempack;
+    int size;
+};
+
+// one register of a 1d PReLU_x86::forward_inplace with a slope per element
+class PReLU_x86_lanes_task : public ParallelTask
+{
+public:
+    void operator()(int ii) const
+    {
+#if __AVX__
+        int i = ii * 8;
+
+        __m256 _p = _mm256_loadu_ps(ptr + i);
+        __m256 _slope = _mm256_loadu_ps(slope_ptr + i);
+        __m256 _lemask = _mm256_cmp_ps(_p, _mm256_setzero_ps(), _CMP_LT_OQ);
+        _mm256_storeu_ps(ptr + i, _mm256_blendv_ps(_p, _mm256_mul_ps(_p, _slope), _lemask));
+#elif __SSE2__
+        int i = ii * 4;
+
+        __m128 _p = _mm_loadu_ps(ptr + i);
+        __m128 _slope = _mm_loadu_ps(slope_ptr + i);
+        __m128 _lemask = _mm_cmplt_ps(_p, _mm_setzero_ps());
+        _mm_storeu_ps(ptr + i, _mm_comp_blendv_ps(_p, _mm_mul_ps(_p, _slope), _lemask));
+#endif // __AVX__
+    }
+
+    float* ptr;
+    const float* slope_ptr;
+};
+
+} // namespace
+
+int PReLU_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    const float *slope_ptr = slope_data;
+
+    if (dims == 1 && num_slope > 1)
+    {
+        // one slope per element, walk both arrays linearly
+        int n = bottom_top_blob.w * elempack;
+
+        float *ptr = bottom_top_blob;
+
+        int nn = 0;
+#if __AVX__
+        nn = n / 8;
+#elif __SSE2__
+        nn = n / 4;
+#endif // __AVX__
+        PReLU_x86_lanes_task task;
+        task.ptr = ptr;
+        task.slope_ptr = slope_ptr;
+        parallel_for(opt, nn, task);
+#if __AVX__
+        nn *= 8;
+#elif __SSE2__
+        nn *= 4;
+#endif // __AVX__
+        for (int i = nn; i < n; i++)
+        {
+            if (ptr[i] < 0)
+                ptr[i] *= slope_ptr[i];
+        }
+
+        return 0;
+    }
+
+    // one slope per row (dims 2) or per channel (dims 3), or a single shared slope
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int channels = bottom_top_blob.c;
+    int outer = dims == 2 ? h : channels;
+    int size = dims == 2 ? w * elempack : w * h * elempack;
+
+    PReLU_x86_task task;
+    task.bottom_top_blob = &bottom_top_blob;
+    task.slope_ptr = slope_ptr;
+    task.num_slope = num_slope;
+    task.dims = dims;
+    task.elempack = elempack;
+    task.size = size;
+    parallel_for(opt, outer, task);
+
+    return 0;
+}
+
+} // namespace ncnn
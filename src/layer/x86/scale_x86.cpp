@@ -0,0 +1,224 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "scale_x86.h"
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(Scale_x86)
+
+Scale_x86::Scale_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#if __AVX__
+    preferred_elempack = 8;
+#endif // __AVX__
+#endif // __SSE2__
+}
+
+// ptr[i] = ptr[i] * s + b for size elements of elempack lanes
+// s and b hold one value per lane, bias is optional
+static void scale_inplace(float *ptr, const float *scale, const float *bias, int elempack, int size)
+{
+    // lane values repeated to a full register, elempack divides 8
+    float s[8];
+    float b[8];
+    for (int k = 0; k < 8; k++)
+    {
+        s[k] = scale[k % elempack];
+        b[k] = bias ? bias[k % elempack] : 0.f;
+    }
+
+    const int n = size * elempack;
+
+    int i = 0;
+#if __AVX__
+    __m256 _s_avx = _mm256_loadu_ps(s);
+    __m256 _b_avx = _mm256_loadu_ps(b);
+    for (; i + 7 < n; i += 8)
+    {
+        _mm256_storeu_ps(ptr, _mm256_comp_fmadd_ps(_mm256_loadu_ps(ptr), _s_avx, _b_avx));
+        ptr += 8;
+    }
+#endif // __AVX__
+#if __SSE2__
+    __m128 _s = _mm_loadu_ps(s);
+    __m128 _b = _mm_loadu_ps(b);
+    for (; i + 3 < n; i += 4)
+    {
+        _mm_storeu_ps(ptr, _mm_comp_fmadd_ps(_mm_loadu_ps(ptr), _s, _b));
+        ptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < n; i++)
+    {
+        *ptr = *ptr * s[i % 8] + b[i % 8];
+        ptr++;
+    }
+}
+
+namespace {
+
+// one row of a 2d Scale_x86::forward_inplace
+class Scale_x86_row_task : public ParallelTask
+{
+public:
+    void operator()(int i) const
+    {
+        float *ptr = bottom_top_blob->row(i);
+
+        scale_inplace(ptr, scale_ptr + i * elempack, bias_ptr ? bias_ptr + i * elempack : 0, elempack, w);
+    }
+
+    Mat* bottom_top_blob;
+    const float* scale_ptr;
+    const float* bias_ptr;
+    int elempack;
+    int w;
+};
+
+// one channel of a 3d Scale_x86::forward_inplace
+class Scale_x86_channel_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *ptr = bottom_top_blob->channel(q);
+
+        scale_inplace(ptr, scale_ptr + q * elempack, bias_ptr ? bias_ptr + q * elempack : 0, elempack, size);
+    }
+
+    Mat* bottom_top_blob;
+    const float* scale_ptr;
+    const float* bias_ptr;
+    int elempack;
+    int size;
+};
+
+// one register of a 1d Scale_x86::forward_inplace
+class Scale_x86_lanes_task : public ParallelTask
+{
+public:
+    void operator()(int ii) const
+    {
+#if __AVX__
+        int i = ii * 8;
+
+        __m256 _p = _mm256_loadu_ps(ptr + i);
+        __m256 _s = _mm256_loadu_ps(scale_ptr + i);
+        __m256 _b = bias_ptr ? _mm256_loadu_ps(bias_ptr + i) : _mm256_setzero_ps();
+        _mm256_storeu_ps(ptr + i, _mm256_comp_fmadd_ps(_p, _s, _b));
+#elif __SSE2__
+        int i = ii * 4;
+
+        __m128 _p = _mm_loadu_ps(ptr + i);
+        __m128 _s = _mm_loadu_ps(scale_ptr + i);
+        __m128 _b = bias_ptr ? _mm_loadu_ps(bias_ptr + i) : _mm_setzero_ps();
+        _mm_storeu_ps(ptr + i, _mm_comp_fmadd_ps(_p, _s, _b));
+#endif // __AVX__
+    }
+
+    float* ptr;
+    const float* scale_ptr;
+    const float* bias_ptr;
+};
+
+} // namespace
+
+int Scale_x86::forward_inplace(std::vector<Mat> &bottom_top_blobs, const Option &opt) const
+{
+    Mat &bottom_top_blob = bottom_top_blobs[0];
+    const Mat &scale_blob = bottom_top_blobs[1];
+
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    const float *scale_ptr = scale_blob;
+    const float *bias_ptr = bias_term ? (const float *)bias_data : 0;
+
+    if (dims == 1)
+    {
+        int n = bottom_top_blob.w * elempack;
+
+        float *ptr = bottom_top_blob;
+
+        int nn = 0;
+#if __AVX__
+        nn = n / 8;
+#elif __SSE2__
+        nn = n / 4;
+#endif // __AVX__
+        Scale_x86_lanes_task task;
+        task.ptr = ptr;
+        task.scale_ptr = scale_ptr;
+        task.bias_ptr = bias_ptr;
+        parallel_for(opt, nn, task);
+#if __AVX__
+        nn *= 8;
+#elif __SSE2__
+        nn *= 4;
+#endif // __AVX__
+        for (int i = nn; i < n; i++)
+        {
+            ptr[i] = bias_ptr ? ptr[i] * scale_ptr[i] + bias_ptr[i] : ptr[i] * scale_ptr[i];
+        }
+    }
+
+    if (dims == 2)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+
+        Scale_x86_row_task task;
+        task.bottom_top_blob = &bottom_top_blob;
+        task.scale_ptr = scale_ptr;
+        task.bias_ptr = bias_ptr;
+        task.elempack = elempack;
+        task.w = w;
+        parallel_for(opt, h, task);
+    }
+
+    if (dims == 3)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+        int size = w * h;
+
+        Scale_x86_channel_task task;
+        task.bottom_top_blob = &bottom_top_blob;
+        task.scale_ptr = scale_ptr;
+        task.bias_ptr = bias_ptr;
+        task.elempack = elempack;
+        task.size = size;
+        parallel_for(opt, channels, task);
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,380 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "softmax_x86.h"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#include "platform.h"
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "threadpool.h"
+
+namespace ncnn
+{
+
+DEFINE_LAYER_CREATOR(Softmax_x86)
+
+// columns handled together when reducing across rows or channels
+// outer x 64 floats stay in cache across the max, exp-sum and scale passes
+#define SOFTMAX_TILE 64
+
+// softmax over n contiguous floats
+static void softmax_row(float *ptr, int n)
+{
+    // max
+    float max = -FLT_MAX;
+    {
+        int j = 0;
+#if __SSE2__
+#if __AVX__
+        __m256 _max_avx = _mm256_set1_ps(-FLT_MAX);
+        for (; j + 7 < n; j += 8)
+        {
+            _max_avx = _mm256_max_ps(_max_avx, _mm256_loadu_ps(ptr + j));
+        }
+        max = std::max(max, _mm256_reduce_max_ps(_max_avx));
+#endif // __AVX__
+        __m128 _max = _mm_set1_ps(-FLT_MAX);
+        for (; j + 3 < n; j += 4)
+        {
+            _max = _mm_max_ps(_max, _mm_loadu_ps(ptr + j));
+        }
+        max = std::max(max, _mm_reduce_max_ps(_max));
+#endif // __SSE2__
+        for (; j < n; j++)
+        {
+            max = std::max(max, ptr[j]);
+        }
+    }
+
+    // exp and sum in one pass
+    float sum = 0.f;
+    {
+        int j = 0;
+#if __SSE2__
+#if __AVX__
+        __m256 _max_avx = _mm256_set1_ps(max);
+        __m256 _sum_avx = _mm256_setzero_ps();
+        for (; j + 7 < n; j += 8)
+        {
+            __m256 _p = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(ptr + j), _max_avx));
+            _mm256_storeu_ps(ptr + j, _p);
+            _sum_avx = _mm256_add_ps(_sum_avx, _p);
+        }
+        sum += _mm256_reduce_add_ps(_sum_avx);
+#endif // __AVX__
+        __m128 _max = _mm_set1_ps(max);
+        __m128 _sum = _mm_setzero_ps();
+        for (; j + 3 < n; j += 4)
+        {
+            __m128 _p = exp_ps(_mm_sub_ps(_mm_loadu_ps(ptr + j), _max));
+            _mm_storeu_ps(ptr + j, _p);
+            _sum = _mm_add_ps(_sum, _p);
+        }
+        sum += _mm_reduce_add_ps(_sum);
+#endif // __SSE2__
+        for (; j < n; j++)
+        {
+            ptr[j] = static_cast<float>(exp(ptr[j] - max));
+            sum += ptr[j];
+        }
+    }
+
+    // scale
+    float scale = 1.f / sum;
+    {
+        int j = 0;
+#if __SSE2__
+#if __AVX__
+        __m256 _scale_avx = _mm256_set1_ps(scale);
+        for (; j + 7 < n; j += 8)
+        {
+            _mm256_storeu_ps(ptr + j, _mm256_mul_ps(_mm256_loadu_ps(ptr + j), _scale_avx));
+        }
+#endif // __AVX__
+        __m128 _scale = _mm_set1_ps(scale);
+        for (; j + 3 < n; j += 4)
+        {
+            _mm_storeu_ps(ptr + j, _mm_mul_ps(_mm_loadu_ps(ptr + j), _scale));
+        }
+#endif // __SSE2__
+        for (; j < n; j++)
+        {
+            ptr[j] *= scale;
+        }
+    }
+}
+
+// softmax across outer slices for n <= SOFTMAX_TILE columns
+// slice i starts at ptr + i * stride
+static void softmax_across_tile(float *ptr, int outer, size_t stride, int n)
+{
+    float max[SOFTMAX_TILE];
+    float sum[SOFTMAX_TILE];
+    for (int j = 0; j < n; j++)
+    {
+        max[j] = -FLT_MAX;
+        sum[j] = 0.f;
+    }
+
+    // max
+    for (int i = 0; i < outer; i++)
+    {
+        const float *p = ptr + i * stride;
+
+        int j = 0;
+#if __SSE2__
+#if __AVX__
+        for (; j + 7 < n; j += 8)
+        {
+            _mm256_storeu_ps(max + j, _mm256_max_ps(_mm256_loadu_ps(max + j), _mm256_loadu_ps(p + j)));
+        }
+#endif // __AVX__
+        for (; j + 3 < n; j += 4)
+        {
+            _mm_storeu_ps(max + j, _mm_max_ps(_mm_loadu_ps(max + j), _mm_loadu_ps(p + j)));
+        }
+#endif // __SSE2__
+        for (; j < n; j++)
+        {
+            max[j] = std::max(max[j], p[j]);
+        }
+    }
+
+    // exp and sum in one pass
+    for (int i = 0; i < outer; i++)
+    {
+        float *p = ptr + i * stride;
+
+        int j = 0;
+#if __SSE2__
+#if __AVX__
+        for (; j + 7 < n; j += 8)
+        {
+            __m256 _p = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(p + j), _mm256_loadu_ps(max + j)));
+            _mm256_storeu_ps(p + j, _p);
+            _mm256_storeu_ps(sum + j, _mm256_add_ps(_mm256_loadu_ps(sum + j), _p));
+        }
+#endif // __AVX__
+        for (; j + 3 < n; j += 4)
+        {
+            __m128 _p = exp_ps(_mm_sub_ps(_mm_loadu_ps(p + j), _mm_loadu_ps(max + j)));
+            _mm_storeu_ps(p + j, _p);
+            _mm_storeu_ps(sum + j, _mm_add_ps(_mm_loadu_ps(sum + j), _p));
+        }
+#endif // __SSE2__
+        for (; j < n; j++)
+        {
+            p[j] = static_cast<float>(exp(p[j] - max[j]));
+            sum[j] += p[j];
+        }
+    }
+
+    for (int j = 0; j < n; j++)
+    {
+        sum[j] = 1.f / sum[j];
+    }
+
+    // scale
+    for (int i = 0; i < outer; i++)
+    {
+        float *p = ptr + i * stride;
+
+        int j = 0;
+#if __SSE2__
+#if __AVX__
+        for (; j + 7 < n; j += 8)
+        {
+            _mm256_storeu_ps(p + j, _mm256_mul_ps(_mm256_loadu_ps(p + j), _mm256_loadu_ps(sum + j)));
+        }
+#endif // __AVX__
+        for (; j + 3 < n; j += 4)
+        {
+            _mm_storeu_ps(p + j, _mm_mul_ps(_mm_loadu_ps(p + j), _mm_loadu_ps(sum + j)));
+        }
+#endif // __SSE2__
+        for (; j < n; j++)
+        {
+            p[j] *= sum[j];
+        }
+    }
+}
+
+namespace {
+
+// softmax_row over rows rows of w floats from ptr + q * step
+class softmax_rows_task : public ParallelTask
+{
+public:
+    void operator()(int q) const
+    {
+        float *p = ptr + q * step;
+
+        for (int i = 0; i < rows; i++)
+        {
+            softmax_row(p, w);
+
+            p += w;
+        }
+    }
+
+    float *ptr;
+    size_t step;
+    int rows;
+    int w;
+};
+
+// softmax_across_tile on tile k % nn_tile of the w columns from ptr + k / nn_tile * step
+class softmax_across_tile_task : public ParallelTask
+{
+public:
+    void operator()(int k) const
+    {
+        int q = k / nn_tile;
+        int j = k % nn_tile * SOFTMAX_TILE;
+        int n = std::min(SOFTMAX_TILE, w - j);
+
+        softmax_across_tile(ptr + q * step + j, outer, stride, n);
+    }
+
+    float *ptr;
+    size_t step;
+    int nn_tile;
+    int w;
+    int outer;
+    size_t stride;
+};
+
+} // namespace
+
+int Softmax_x86::forward_inplace(Mat &bottom_top_blob, const Option &opt) const
+{
+    // value = exp( value - global max value )
+    // sum all value
+    // value = value / sum
+
+    int dims = bottom_top_blob.dims;
+
+    if (dims == 1) // axis == 0
+    {
+        int w = bottom_top_blob.w;
+
+        float *ptr = bottom_top_blob;
+
+        softmax_row(ptr, w);
+
+        return 0;
+    }
+
+    if (dims == 2 && axis == 0)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+
+        softmax_across_tile_task task;
+        task.ptr = bottom_top_blob;
+        task.step = 0;
+        task.nn_tile = (w + SOFTMAX_TILE - 1) / SOFTMAX_TILE;
+        task.w = w;
+        task.outer = h;
+        task.stride = w;
+        parallel_for(opt, task.nn_tile, task);
+
+        return 0;
+    }
+
+    if (dims == 2 && axis == 1)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+
+        softmax_rows_task task;
+        task.ptr = bottom_top_blob;
+        task.step = w;
+        task.rows = 1;
+        task.w = w;
+        parallel_for(opt, h, task);
+
+        return 0;
+    }
+
+    if (dims == 3 && axis == 0)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+        int size = w * h;
+
+        softmax_across_tile_task task;
+        task.ptr = bottom_top_blob;
+        task.step = 0;
+        task.nn_tile = (size + SOFTMAX_TILE - 1) / SOFTMAX_TILE;
+        task.w = size;
+        task.outer = channels;
+        task.stride = bottom_top_blob.cstep;
+        parallel_for(opt, task.nn_tile, task);
+
+        return 0;
+    }
+
+    if (dims == 3 && axis == 1)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+
+        // every tile of every channel is independent
+        softmax_across_tile_task task;
+        task.ptr = bottom_top_blob;
+        task.step = bottom_top_blob.cstep;
+        task.nn_tile = (w + SOFTMAX_TILE - 1) / SOFTMAX_TILE;
+        task.w = w;
+        task.outer = h;
+        task.stride = w;
+        parallel_for(opt, channels * task.nn_tile, task);
+
+        return 0;
+    }
+
+    if (dims == 3 && axis == 2)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+
+        softmax_rows_task task;
+        task.ptr = bottom_top_blob;
+        task.step = bottom_top_blob.cstep;
+        task.rows = h;
+        task.w = w;
+        parallel_for(opt, channels, task);
+
+        return 0;
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,766 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// cache-blocked sgemm shared by the x86 convolution, deconvolution and innerproduct layers
+//   C(m, n) = bias(m) + sum_k A(m, k) * B(k, n)
+//
+// A is the weight matrix, packed once by x86_sgemm_pack_a into panels of x86_sgemm_mr rows,
+// x86_sgemm_cast_a_fp16/bf16 narrow the packed panels and they are widened again one panel at a time
+// B may be fp32 or bf16, it is widened while packing, C is always fp32
+// B and C are read as (rows / elempack) blocks of ld floats, each block holding n x elempack
+//   elempack = 1      plain row-major matrix with row stride ld
+//   elempack = 4/8/16 packed blob with k (B) or m (C) walking the channels, ld = cstep * elempack
+//   elempack = rows   column-major matrix, eg. a batch of row vectors used as B
+//
+// the outer loop walks k in x86_sgemm_kc blocks, the B block is repacked into x86_sgemm_nr column
+// strips and the (m, n) plane is split into x86_sgemm_mc x x86_sgemm_nc tasks run in parallel,
+// every task streams its B strips through L1 against the A block resident in L2
+
+#if __AVX512F__
+static const int x86_sgemm_mr = 16;
+static const int x86_sgemm_nr = 12;
+#elif __AVX__
+static const int x86_sgemm_mr = 8;
+static const int x86_sgemm_nr = 12;
+#else
+static const int x86_sgemm_mr = 4;
+static const int x86_sgemm_nr = 8;
+#endif
+
+static const int x86_sgemm_kc = 256;
+static const int x86_sgemm_mc = x86_sgemm_mr * 8;
+static const int x86_sgemm_nc = x86_sgemm_nr * 16;
+
+static size_t x86_sgemm_packed_a_size(int M, int K)
+{
+    return (size_t)(M + x86_sgemm_mr - 1) / x86_sgemm_mr * x86_sgemm_mr * K;
+}
+
+// dst = mr-K-M/mr, the rows past M are zero
+static void x86_sgemm_pack_a(const float* A, int lda, int M, int K, float* dst)
+{
+    const int mr = x86_sgemm_mr;
+
+    for (int m = 0; m < M; m += mr)
+    {
+        float* pa = dst + (size_t)m * K;
+
+        for (int k = 0; k < K; k++)
+        {
+            for (int i = 0; i < mr; i++)
+            {
+                pa[i] = m + i < M ? A[(size_t)(m + i) * lda + k] : 0.f;
+            }
+
+            pa += mr;
+        }
+    }
+}
+
+static void x86_sgemm_pack_a(const float* A, int lda, int M, int K, Mat& A_packed, Allocator* allocator = 0)
+{
+    A_packed.create((int)x86_sgemm_packed_a_size(M, K), (size_t)4u, allocator);
+    if (A_packed.empty())
+        return;
+
+    x86_sgemm_pack_a(A, lda, M, K, (float*)A_packed);
+}
+
+// narrow packed A to fp16 in place, the panel layout is kept
+static void x86_sgemm_cast_a_fp16(Mat& A_packed, const Option& opt)
+{
+    Option opt_cast = opt;
+    opt_cast.blob_allocator = opt.weight_allocator;
+
+    Mat A_packed_fp16;
+    cast_float32_to_float16(A_packed, A_packed_fp16, opt_cast);
+
+    A_packed = A_packed_fp16;
+}
+
+// narrow packed A to bf16 in place, the panel layout is kept
+static void x86_sgemm_cast_a_bf16(Mat& A_packed, const Option& opt)
+{
+    Option opt_cast = opt;
+    opt_cast.blob_allocator = opt.weight_allocator;
+
+    Mat A_packed_bf16;
+    cast_float32_to_bfloat16(A_packed, A_packed_bf16, opt_cast);
+
+    A_packed = A_packed_bf16;
+}
+
+static inline float x86_sgemm_half2float(unsigned short value)
+{
+    union
+    {
+        unsigned int u;
+        float f;
+    } tmp;
+
+    // shift exponent and significand into place and rebias by 2^112, denormals come out right too
+    tmp.u = (unsigned int)(value & 0x7fff) << 13;
+    tmp.f *= 5.192296858534828e+33f;
+    if ((value & 0x7c00) == 0x7c00)
+        tmp.u |= 0x7f800000;
+    tmp.u |= (unsigned int)(value & 0x8000) << 16;
+
+    return tmp.f;
+}
+
+// type 2 = float16, 4 = bfloat16
+static void x86_sgemm_unpack_a(const unsigned short* src, int type, float* dst, int size)
+{
+    int i = 0;
+
+    if (type == 4)
+    {
+#if __SSE2__
+        for (; i + 7 < size; i += 8)
+        {
+            __m128i _p = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi16(_mm_setzero_si128(), _p));
+            _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(_mm_setzero_si128(), _p));
+        }
+#endif // __SSE2__
+        for (; i < size; i++)
+        {
+            dst[i] = bfloat16_to_float32(src[i]);
+        }
+
+        return;
+    }
+
+#if __F16C__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+    }
+#endif // __F16C__
+    for (; i < size; i++)
+    {
+        dst[i] = x86_sgemm_half2float(src[i]);
+    }
+}
+
+static inline float x86_sgemm_widen(float v)
+{
+    return v;
+}
+
+static inline float x86_sgemm_widen(unsigned short v)
+{
+    return bfloat16_to_float32(v);
+}
+
+namespace {
+
+// one nr-wide strip of x86_sgemm_pack_b
+template<typename T>
+class x86_sgemm_pack_b_task : public ParallelTask
+{
+public:
+    void operator()(int s) const
+    {
+        const int nr = x86_sgemm_nr;
+
+        const int n = s * nr;
+
+        float* pb = dst + (size_t)n * kc;
+
+        if (elempack == 1)
+        {
+            for (int k = 0; k < kc; k++)
+            {
+                const T* p = B + (k0 + k) * ldb + n;
+
+                for (int j = 0; j < nr; j++)
+                {
+                    pb[j] = x86_sgemm_widen(p[j]);
+                }
+
+                pb += nr;
+            }
+        }
+        else
+        {
+            for (int k = 0; k < kc; k++)
+            {
+                const T* p = B + (k0 + k) / elempack * ldb + (size_t)n * elempack + (k0 + k) % elempack;
+
+                for (int j = 0; j < nr; j++)
+                {
+                    pb[j] = x86_sgemm_widen(p[j * elempack]);
+                }
+
+                pb += nr;
+            }
+        }
+    }
+
+    const T* B;
+    size_t ldb;
+    int elempack;
+    int k0;
+    int kc;
+    float* dst;
+};
+
+} // namespace
+
+// B(k0 + k, n) for k < kc goes to dst + n * kc, nr-wide strips first and single columns for the rest
+template<typename T>
+static void x86_sgemm_pack_b(const T* B, size_t ldb, int elempack, int N, int k0, int kc, float* dst, const Option& opt)
+{
+    const int nr = x86_sgemm_nr;
+
+    const int nn_strip = N / nr;
+
+    x86_sgemm_pack_b_task<T> task;
+    task.B = B;
+    task.ldb = ldb;
+    task.elempack = elempack;
+    task.k0 = k0;
+    task.kc = kc;
+    task.dst = dst;
+    parallel_for(opt, nn_strip, task);
+
+    for (int n = nn_strip * nr; n < N; n++)
+    {
+        float* pb = dst + (size_t)n * kc;
+
+        for (int k = 0; k < kc; k++)
+        {
+            pb[k] = x86_sgemm_widen(B[(k0 + k) / elempack * ldb + (size_t)n * elempack + (k0 + k) % elempack]);
+        }
+    }
+}
+
+// c[j * ldc + i] = (accumulate ? c[j * ldc + i] : bias[i]) + sum_k pa[k * mr + i] * pb[k * nr + j]
+static void x86_sgemm_kernel(int kc, const float* pa, const float* pb, float* c, int ldc, const float* bias, bool accumulate)
+{
+#if __AVX512F__
+    __m512 _sum0 = accumulate ? _mm512_loadu_ps(c) : _mm512_loadu_ps(bias);
+    __m512 _sum1 = accumulate ? _mm512_loadu_ps(c + ldc) : _sum0;
+    __m512 _sum2 = accumulate ? _mm512_loadu_ps(c + ldc * 2) : _sum0;
+    __m512 _sum3 = accumulate ? _mm512_loadu_ps(c + ldc * 3) : _sum0;
+    __m512 _sum4 = accumulate ? _mm512_loadu_ps(c + ldc * 4) : _sum0;
+    __m512 _sum5 = accumulate ? _mm512_loadu_ps(c + ldc * 5) : _sum0;
+    __m512 _sum6 = accumulate ? _mm512_loadu_ps(c + ldc * 6) : _sum0;
+    __m512 _sum7 = accumulate ? _mm512_loadu_ps(c + ldc * 7) : _sum0;
+    __m512 _sum8 = accumulate ? _mm512_loadu_ps(c + ldc * 8) : _sum0;
+    __m512 _sum9 = accumulate ? _mm512_loadu_ps(c + ldc * 9) : _sum0;
+    __m512 _suma = accumulate ? _mm512_loadu_ps(c + ldc * 10) : _sum0;
+    __m512 _sumb = accumulate ? _mm512_loadu_ps(c + ldc * 11) : _sum0;
+
+    for (int k = 0; k < kc; k++)
+    {
+        __m512 _a = _mm512_loadu_ps(pa);
+
+        _sum0 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[0]), _sum0);
+        _sum1 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[1]), _sum1);
+        _sum2 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[2]), _sum2);
+        _sum3 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[3]), _sum3);
+        _sum4 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[4]), _sum4);
+        _sum5 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[5]), _sum5);
+        _sum6 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[6]), _sum6);
+        _sum7 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[7]), _sum7);
+        _sum8 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[8]), _sum8);
+        _sum9 = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[9]), _sum9);
+        _suma = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[10]), _suma);
+        _sumb = _mm512_fmadd_ps(_a, _mm512_set1_ps(pb[11]), _sumb);
+
+        pa += 16;
+        pb += 12;
+    }
+
+    _mm512_storeu_ps(c, _sum0);
+    _mm512_storeu_ps(c + ldc, _sum1);
+    _mm512_storeu_ps(c + ldc * 2, _sum2);
+    _mm512_storeu_ps(c + ldc * 3, _sum3);
+    _mm512_storeu_ps(c + ldc * 4, _sum4);
+    _mm512_storeu_ps(c + ldc * 5, _sum5);
+    _mm512_storeu_ps(c + ldc * 6, _sum6);
+    _mm512_storeu_ps(c + ldc * 7, _sum7);
+    _mm512_storeu_ps(c + ldc * 8, _sum8);
+    _mm512_storeu_ps(c + ldc * 9, _sum9);
+    _mm512_storeu_ps(c + ldc * 10, _suma);
+    _mm512_storeu_ps(c + ldc * 11, _sumb);
+#elif __AVX__
+    __m256 _sum0 = accumulate ? _mm256_loadu_ps(c) : _mm256_loadu_ps(bias);
+    __m256 _sum1 = accumulate ? _mm256_loadu_ps(c + ldc) : _sum0;
+    __m256 _sum2 = accumulate ? _mm256_loadu_ps(c + ldc * 2) : _sum0;
+    __m256 _sum3 = accumulate ? _mm256_loadu_ps(c + ldc * 3) : _sum0;
+    __m256 _sum4 = accumulate ? _mm256_loadu_ps(c + ldc * 4) : _sum0;
+    __m256 _sum5 = accumulate ? _mm256_loadu_ps(c + ldc * 5) : _sum0;
+    __m256 _sum6 = accumulate ? _mm256_loadu_ps(c + ldc * 6) : _sum0;
+    __m256 _sum7 = accumulate ? _mm256_loadu_ps(c + ldc * 7) : _sum0;
+    __m256 _sum8 = accumulate ? _mm256_loadu_ps(c + ldc * 8) : _sum0;
+    __m256 _sum9 = accumulate ? _mm256_loadu_ps(c + ldc * 9) : _sum0;
+    __m256 _suma = accumulate ? _mm256_loadu_ps(c + ldc * 10) : _sum0;
+    __m256 _sumb = accumulate ? _mm256_loadu_ps(c + ldc * 11) : _sum0;
+
+    for (int k = 0; k < kc; k++)
+    {
+        __m256 _a = _mm256_loadu_ps(pa);
+
+        _sum0 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb), _sum0);
+        _sum1 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 1), _sum1);
+        _sum2 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 2), _sum2);
+        _sum3 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 3), _sum3);
+        _sum4 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 4), _sum4);
+        _sum5 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 5), _sum5);
+        _sum6 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 6), _sum6);
+        _sum7 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 7), _sum7);
+        _sum8 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 8), _sum8);
+        _sum9 = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 9), _sum9);
+        _suma = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 10), _suma);
+        _sumb = _mm256_comp_fmadd_ps(_a, _mm256_broadcast_ss(pb + 11), _sumb);
+
+        pa += 8;
+        pb += 12;
+    }
+
+    _mm256_storeu_ps(c, _sum0);
+    _mm256_storeu_ps(c + ldc, _sum1);
+    _mm256_storeu_ps(c + ldc * 2, _sum2);
+    _mm256_storeu_ps(c + ldc * 3, _sum3);
+    _mm256_storeu_ps(c + ldc * 4, _sum4);
+    _mm256_storeu_ps(c + ldc * 5, _sum5);
+    _mm256_storeu_ps(c + ldc * 6, _sum6);
+    _mm256_storeu_ps(c + ldc * 7, _sum7);
+    _mm256_storeu_ps(c + ldc * 8, _sum8);
+    _mm256_storeu_ps(c + ldc * 9, _sum9);
+    _mm256_storeu_ps(c + ldc * 10, _suma);
+    _mm256_storeu_ps(c + ldc * 11, _sumb);
+#elif __SSE2__
+    __m128 _sum0 = accumulate ? _mm_loadu_ps(c) : _mm_loadu_ps(bias);
+    __m128 _sum1 = accumulate ? _mm_loadu_ps(c + ldc) : _sum0;
+    __m128 _sum2 = accumulate ? _mm_loadu_ps(c + ldc * 2) : _sum0;
+    __m128 _sum3 = accumulate ? _mm_loadu_ps(c + ldc * 3) : _sum0;
+    __m128 _sum4 = accumulate ? _mm_loadu_ps(c + ldc * 4) : _sum0;
+    __m128 _sum5 = accumulate ? _mm_loadu_ps(c + ldc * 5) : _sum0;
+    __m128 _sum6 = accumulate ? _mm_loadu_ps(c + ldc * 6) : _sum0;
+    __m128 _sum7 = accumulate ? _mm_loadu_ps(c + ldc * 7) : _sum0;
+
+    for (int k = 0; k < kc; k++)
+    {
+        __m128 _a = _mm_loadu_ps(pa);
+
+        _sum0 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb), _sum0);
+        _sum1 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 1), _sum1);
+        _sum2 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 2), _sum2);
+        _sum3 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 3), _sum3);
+        _sum4 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 4), _sum4);
+        _sum5 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 5), _sum5);
+        _sum6 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 6), _sum6);
+        _sum7 = _mm_comp_fmadd_ps(_a, _mm_load1_ps(pb + 7), _sum7);
+
+        pa += 4;
+        pb += 8;
+    }
+
+    _mm_storeu_ps(c, _sum0);
+    _mm_storeu_ps(c + ldc, _sum1);
+    _mm_storeu_ps(c + ldc * 2, _sum2);
+    _mm_storeu_ps(c + ldc * 3, _sum3);
+    _mm_storeu_ps(c + ldc * 4, _sum4);
+    _mm_storeu_ps(c + ldc * 5, _sum5);
+    _mm_storeu_ps(c + ldc * 6, _sum6);
+    _mm_storeu_ps(c + ldc * 7, _sum7);
+#else
+    const int mr = x86_sgemm_mr;
+    const int nr = x86_sgemm_nr;
+
+    float sum[x86_sgemm_nr][x86_sgemm_mr];
+    for (int j = 0; j < nr; j++)
+    {
+        for (int i = 0; i < mr; i++)
+        {
+            sum[j][i] = accumulate ? c[j * ldc + i] : bias[i];
+        }
+    }
+
+    for (int k = 0; k < kc; k++)
+    {
+        for (int j = 0; j < nr; j++)
+        {
+            for (int i = 0; i < mr; i++)
+            {
+                sum[j][i] += pa[i] * pb[j];
+            }
+        }
+
+        pa += mr;
+        pb += nr;
+    }
+
+    for (int j = 0; j < nr; j++)
+    {
+        for (int i = 0; i < mr; i++)
+        {
+            c[j * ldc + i] = sum[j][i];
+        }
+    }
+#endif
+}
+
+// single column variant for the N % nr remainder and matrix-vector products
+static void x86_sgemm_kernel_n1(int kc, const float* pa, const float* pb, float* c, const float* bias, bool accumulate)
+{
+    int k = 0;
+#if __AVX512F__
+    __m512 _sum0 = accumulate ? _mm512_loadu_ps(c) : _mm512_loadu_ps(bias);
+    __m512 _sum1 = _mm512_setzero_ps();
+    __m512 _sum2 = _mm512_setzero_ps();
+    __m512 _sum3 = _mm512_setzero_ps();
+
+    for (; k + 3 < kc; k += 4)
+    {
+        _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(pa), _mm512_set1_ps(pb[0]), _sum0);
+        _sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(pa + 16), _mm512_set1_ps(pb[1]), _sum1);
+        _sum2 = _mm512_fmadd_ps(_mm512_loadu_ps(pa + 32), _mm512_set1_ps(pb[2]), _sum2);
+        _sum3 = _mm512_fmadd_ps(_mm512_loadu_ps(pa + 48), _mm512_set1_ps(pb[3]), _sum3);
+
+        pa += 64;
+        pb += 4;
+    }
+    for (; k < kc; k++)
+    {
+        _sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(pa), _mm512_set1_ps(pb[0]), _sum0);
+
+        pa += 16;
+        pb += 1;
+    }
+
+    _sum0 = _mm512_add_ps(_mm512_add_ps(_sum0, _sum1), _mm512_add_ps(_sum2, _sum3));
+
+    _mm512_storeu_ps(c, _sum0);
+#elif __AVX__
+    __m256 _sum0 = accumulate ? _mm256_loadu_ps(c) : _mm256_loadu_ps(bias);
+    __m256 _sum1 = _mm256_setzero_ps();
+    __m256 _sum2 = _mm256_setzero_ps();
+    __m256 _sum3 = _mm256_setzero_ps();
+
+    for (; k + 3 < kc; k += 4)
+    {
+        _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(pa), _mm256_broadcast_ss(pb), _sum0);
+        _sum1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(pa + 8), _mm256_broadcast_ss(pb + 1), _sum1);
+        _sum2 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(pa + 16), _mm256_broadcast_ss(pb + 2), _sum2);
+        _sum3 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(pa + 24), _mm256_broadcast_ss(pb + 3), _sum3);
+
+        pa += 32;
+        pb += 4;
+    }
+    for (; k < kc; k++)
+    {
+        _sum0 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(pa), _mm256_broadcast_ss(pb), _sum0);
+
+        pa += 8;
+        pb += 1;
+    }
+
+    _sum0 = _mm256_add_ps(_mm256_add_ps(_sum0, _sum1), _mm256_add_ps(_sum2, _sum3));
+
+    _mm256_storeu_ps(c, _sum0);
+#elif __SSE2__
+    __m128 _sum0 = accumulate ? _mm_loadu_ps(c) : _mm_loadu_ps(bias);
+    __m128 _sum1 = _mm_setzero_ps();
+    __m128 _sum2 = _mm_setzero_ps();
+    __m128 _sum3 = _mm_setzero_ps();
+
+    for (; k + 3 < kc; k += 4)
+    {
+        _sum0 = _mm_comp_fmadd_ps(_mm_loadu_ps(pa), _mm_load1_ps(pb), _sum0);
+        _sum1 = _mm_comp_fmadd_ps(_mm_loadu_ps(pa + 4), _mm_load1_ps(pb + 1), _sum1);
+        _sum2 = _mm_comp_fmadd_ps(_mm_loadu_ps(pa + 8), _mm_load1_ps(pb + 2), _sum2);
+        _sum3 = _mm_comp_fmadd_ps(_mm_loadu_ps(pa + 12), _mm_load1_ps(pb + 3), _sum3);
+
+        pa += 16;
+        pb += 4;
+    }
+    for (; k < kc; k++)
+    {
+        _sum0 = _mm_comp_fmadd_ps(_mm_loadu_ps(pa), _mm_load1_ps(pb), _sum0);
+
+        pa += 4;
+        pb += 1;
+    }
+
+    _sum0 = _mm_add_ps(_mm_add_ps(_sum0, _sum1), _mm_add_ps(_sum2, _sum3));
+
+    _mm_storeu_ps(c, _sum0);
+#else
+    const int mr = x86_sgemm_mr;
+
+    float sum[x86_sgemm_mr];
+    for (int i = 0; i < mr; i++)
+    {
+        sum[i] = accumulate ? c[i] : bias[i];
+    }
+
+    for (; k < kc; k++)
+    {
+        for (int i = 0; i < mr; i++)
+        {
+            sum[i] += pa[i] * pb[0];
+        }
+
+        pa += mr;
+        pb += 1;
+    }
+
+    for (int i = 0; i < mr; i++)
+    {
+        c[i] = sum[i];
+    }
+#endif
+}
+
+// one mr x nn tile of C, rows past M and packed rows of C go through tmp
+static void x86_sgemm_tile(int kc, const float* pa, const float* pb, int nn, int m, int n, int M, float* C, size_t ldc, int elempack_c, const float* biasptr, bool accumulate)
+{
+    const int mr = x86_sgemm_mr;
+    const int nr = x86_sgemm_nr;
+
+    float* outptr = C + (m / elempack_c) * ldc + (size_t)n * elempack_c + m % elempack_c;
+
+    if (m + mr <= M && m % elempack_c + mr <= elempack_c)
+    {
+        // mr consecutive rows of C are contiguous
+        if (nn == nr)
+            x86_sgemm_kernel(kc, pa, pb, outptr, elempack_c, biasptr, accumulate);
+        else
+            x86_sgemm_kernel_n1(kc, pa, pb, outptr, biasptr, accumulate);
+
+        return;
+    }
+
+    // gather and scatter the tile through tmp
+    float tmp[x86_sgemm_mr * x86_sgemm_nr];
+
+    const int mm = std::min(mr, M - m);
+
+    if (accumulate)
+    {
+        for (int i = 0; i < mm; i++)
+        {
+            const float* ptr = C + ((m + i) / elempack_c) * ldc + (size_t)n * elempack_c + (m + i) % elempack_c;
+
+            for (int j = 0; j < nn; j++)
+            {
+                tmp[j * mr + i] = ptr[j * elempack_c];
+            }
+        }
+    }
+
+    if (nn == nr)
+        x86_sgemm_kernel(kc, pa, pb, tmp, mr, biasptr, accumulate);
+    else
+        x86_sgemm_kernel_n1(kc, pa, pb, tmp, biasptr, accumulate);
+
+    for (int i = 0; i < mm; i++)
+    {
+        float* ptr = C + ((m + i) / elempack_c) * ldc + (size_t)n * elempack_c + (m + i) % elempack_c;
+
+        for (int j = 0; j < nn; j++)
+        {
+            ptr[j * elempack_c] = tmp[j * mr + i];
+        }
+    }
+}
+
+namespace {
+
+// one mc x nc block of C for one kc slice
+class x86_sgemm_tile_task : public ParallelTask
+{
+public:
+    void operator()(int t) const
+    {
+        const int mr = x86_sgemm_mr;
+        const int nr = x86_sgemm_nr;
+
+        const int m0 = t / nn_n * mc;
+        const int n0 = t % nn_n * nc;
+        const int m1 = std::min(m0 + mc, M);
+        const int n1 = std::min(n0 + nc, N);
+
+        if (A_packed_16)
+        {
+            // widen one A panel into L1 and sweep it over the B strips
+            float pa[x86_sgemm_mr * x86_sgemm_kc];
+
+            for (int m = m0; m < m1; m += mr)
+            {
+                x86_sgemm_unpack_a(A_packed_16 + (size_t)m * K + (size_t)kk * mr, a_type, pa, kc * mr);
+
+                const float* biasptr = bias_mr + m;
+
+                int n = n0;
+                while (n < n1)
+                {
+                    const int nn = n < N_strip ? nr : 1;
+
+                    const float* pb = B_packed + (size_t)n * kc;
+
+                    x86_sgemm_tile(kc, pa, pb, nn, m, n, M, C, ldc, elempack_c, biasptr, accumulate);
+
+                    n += nn;
+                }
+            }
+
+            return;
+        }
+
+        int n = n0;
+        while (n < n1)
+        {
+            const int nn = n < N_strip ? nr : 1;
+
+            const float* pb = B_packed + (size_t)n * kc;
+
+            for (int m = m0; m < m1; m += mr)
+            {
+                const float* pa = A_packed + (size_t)m * K + (size_t)kk * mr;
+                const float* biasptr = bias_mr + m;
+
+                x86_sgemm_tile(kc, pa, pb, nn, m, n, M, C, ldc, elempack_c, biasptr, accumulate);
+            }
+
+            n += nn;
+        }
+    }
+
+    int M;
+    int N;
+    int K;
+    const float* A_packed;
+    const unsigned short* A_packed_16;
+    int a_type;
+    float* C;
+    size_t ldc;
+    int elempack_c;
+    const float* bias_mr;
+    const float* B_packed;
+    int N_strip;
+    int kk;
+    int kc;
+    int mc;
+    int nc;
+    int nn_n;
+    bool accumulate;
+};
+
+} // namespace
+
+// exactly one of A_packed and A_packed_16 is set, a_type tells fp16 (2) from bf16 (4) for the latter
+// returns -100 when the workspace cannot be allocated
+template<typename T>
+static int x86_sgemm(int M, int N, int K, const float* A_packed, const unsigned short* A_packed_16, int a_type, const T* B, size_t ldb, int elempack_b, float* C, size_t ldc, int elempack_c, const float* bias, const Option& opt)
+{
+    const int mr = x86_sgemm_mr;
+    const int nr = x86_sgemm_nr;
+
+    const int nn_k = (K + x86_sgemm_kc - 1) / x86_sgemm_kc;
+    const int kc_max = (K + nn_k - 1) / nn_k;
+
+    // shrink the blocks until every thread gets a few tasks
+    int mc = x86_sgemm_mc;
+    int nc = x86_sgemm_nc;
+    while ((M + mc - 1) / mc * ((N + nc - 1) / nc) < opt.num_threads * 4)
+    {
+        if (mc > mr && mc / mr >= nc / nr)
+            mc = mc / mr / 2 * mr;
+        else if (nc > nr)
+            nc = nc / nr / 2 * nr;
+        else
+            break;
+    }
+
+    const int nn_m = (M + mc - 1) / mc;
+    const int nn_n = (N + nc - 1) / nc;
+
+    const int M_aligned = (M + mr - 1) / mr * mr;
+
+    Mat bias_mr(M_aligned, (size_t)4u, opt.workspace_allocator);
+    Mat B_packed(N * kc_max, (size_t)4u, opt.workspace_allocator);
+    if (bias_mr.empty() || B_packed.empty())
+        return -100;
+
+    {
+        float* ptr = bias_mr;
+        for (int m = 0; m < M_aligned; m++)
+        {
+            ptr[m] = bias && m < M ? bias[m] : 0.f;
+        }
+    }
+
+    const int N_strip = N / nr * nr;
+
+    for (int kk = 0; kk < K; kk += kc_max)
+    {
+        const int kc = std::min(kc_max, K - kk);
+        const bool accumulate = kk > 0;
+
+        x86_sgemm_pack_b(B, ldb, elempack_b, N, kk, kc, B_packed, opt);
+
+        x86_sgemm_tile_task task;
+        task.M = M;
+        task.N = N;
+        task.K = K;
+        task.A_packed = A_packed;
+        task.A_packed_16 = A_packed_16;
+        task.a_type = a_type;
+        task.C = C;
+        task.ldc = ldc;
+        task.elempack_c = elempack_c;
+        task.bias_mr = bias_mr;
+        task.B_packed = B_packed;
+        task.N_strip = N_strip;
+        task.kk = kk;
+        task.kc = kc;
+        task.mc = mc;
+        task.nc = nc;
+        task.nn_n = nn_n;
+        task.accumulate = accumulate;
+        parallel_for(opt, nn_m * nn_n, task);
+    }
+
+    return 0;
+}
+
+// bias may be null, ldb and ldc are in elements
+static int x86_sgemm(int M, int N, int K, const float* A_packed, const float* B, size_t ldb, int elempack_b, float* C, size_t ldc, int elempack_c, const float* bias, const Option& opt)
+{
+    return x86_sgemm(M, N, K, A_packed, 0, 1, B, ldb, elempack_b, C, ldc, elempack_c, bias, opt);
+}
+
+// a_type is the element type A_packed was narrowed to at create_pipeline, 1 = float32, 2 = float16, 4 = bfloat16
+static int x86_sgemm(int M, int N, int K, const Mat& A_packed, int a_type, const float* B, size_t ldb, int elempack_b, float* C, size_t ldc, int elempack_c, const float* bias, const Option& opt)
+{
+    if (a_type != 1)
+        return x86_sgemm(M, N, K, 0, (const unsigned short*)A_packed.data, a_type, B, ldb, elempack_b, C, ldc, elempack_c, bias, opt);
+
+    return x86_sgemm(M, N, K, (const float*)A_packed, 0, 1, B, ldb, elempack_b, C, ldc, elempack_c, bias, opt);
+}
+
+// B in bf16
+static int x86_sgemm(int M, int N, int K, const Mat& A_packed, int a_type, const unsigned short* B, size_t ldb, int elempack_b, float* C, size_t ldc, int elempack_c, const float* bias, const Option& opt)
+{
+    if (a_type != 1)
+        return x86_sgemm(M, N, K, 0, (const unsigned short*)A_packed.data, a_type, B, ldb, elempack_b, C, ldc, elempack_c, bias, opt);
+
+    return x86_sgemm(M, N, K, (const float*)A_packed, 0, 1, B, ldb, elempack_b, C, ldc, elempack_c, bias, opt);
+}
@@ -0,0 +1,88 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef X86_USABILITY_H
+#define X86_USABILITY_H
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __SSE4_1__
+#include <smmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+#endif // __SSE2__
+
+// fused multiply-add that degrades to mul + add when the fma extension is not enabled
+// the avx variant of a layer is built without fma while the avx2 and avx512 ones have it
+
+#if __SSE2__
+static inline __m128 _mm_comp_fmadd_ps(const __m128& _a, const __m128& _b, const __m128& _c)
+{
+#if __FMA__
+    return _mm_fmadd_ps(_a, _b, _c);
+#else
+    return _mm_add_ps(_mm_mul_ps(_a, _b), _c);
+#endif
+}
+
+// per-lane select, b where mask is set and a elsewhere
+static inline __m128 _mm_comp_blendv_ps(const __m128& _a, const __m128& _b, const __m128& _mask)
+{
+#if __SSE4_1__
+    return _mm_blendv_ps(_a, _b, _mask);
+#else
+    return _mm_or_ps(_mm_andnot_ps(_mask, _a), _mm_and_ps(_mask, _b));
+#endif
+}
+
+// horizontal sum of all lanes
+static inline float _mm_reduce_add_ps(const __m128& x128)
+{
+    const __m128 x64 = _mm_add_ps(x128, _mm_movehl_ps(x128, x128));
+    const __m128 x32 = _mm_add_ss(x64, _mm_shuffle_ps(x64, x64, 0x55));
+    return _mm_cvtss_f32(x32);
+}
+
+static inline float _mm_reduce_max_ps(const __m128& x128)
+{
+    const __m128 x64 = _mm_max_ps(x128, _mm_movehl_ps(x128, x128));
+    const __m128 x32 = _mm_max_ss(x64, _mm_shuffle_ps(x64, x64, 0x55));
+    return _mm_cvtss_f32(x32);
+}
+
+#if __AVX__
+static inline __m256 _mm256_comp_fmadd_ps(const __m256& _a, const __m256& _b, const __m256& _c)
+{
+#if __FMA__
+    return _mm256_fmadd_ps(_a, _b, _c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+#endif
+}
+
+static inline float _mm256_reduce_add_ps(const __m256& x)
+{
+    return _mm_reduce_add_ps(_mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1)));
+}
+
+static inline float _mm256_reduce_max_ps(const __m256& x)
+{
+    return _mm_reduce_max_ps(_mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1)));
+}
+#endif // __AVX__
+#endif // __SSE2__
+
+#endif // X86_USABILITY_H
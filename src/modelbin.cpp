@@ -43,7 +43,7 @@ Mat ModelBin::load(int w, int h, int c, int type) const
     return m.reshape(w, h, c);
 }
 
-ModelBinFromDataReader::ModelBinFromDataReader(const DataReader& _dr) : dr(_dr)
+ModelBinFromDataReader::ModelBinFromDataReader(const DataReader& _dr, Allocator* _allocator) : dr(_dr), allocator(_allocator)
 {
 }
 
@@ -87,7 +87,11 @@ Mat ModelBinFromDataReader::load(int w, int type) const
                 return Mat();
             }
 
-            return Mat::from_float16(float16_weights.data(), w);
+            Mat m = Mat::from_float16(float16_weights.data(), w);
+            if (allocator && !m.empty())
+                m = m.clone(allocator);
+
+            return m;
         }
         else if (flag_struct.tag == 0x000D4B38)
         {
@@ -102,7 +106,7 @@ Mat ModelBinFromDataReader::load(int w, int type) const
                 return Mat();
             }
 
-            Mat m(w, (size_t)1u);
+            Mat m(w, (size_t)1u, allocator);
             if (m.empty())
                 return m;
 
@@ -112,7 +116,7 @@ Mat ModelBinFromDataReader::load(int w, int type) const
         }
         else if (flag_struct.tag == 0x0002C056)
         {
-            Mat m(w);
+            Mat m(w, (size_t)4u, allocator);
             if (m.empty())
                 return m;
 
@@ -127,7 +131,7 @@ Mat ModelBinFromDataReader::load(int w, int type) const
             return m;
         }
 
-        Mat m(w);
+        Mat m(w, (size_t)4u, allocator);
         if (m.empty())
             return m;
 
@@ -173,7 +177,7 @@ Mat ModelBinFromDataReader::load(int w, int type) const
     }
     else if (type == 1)
     {
-        Mat m(w);
+        Mat m(w, (size_t)4u, allocator);
         if (m.empty())
             return m;
 
@@ -40,12 +40,14 @@ public:
 class ModelBinFromDataReader : public ModelBin
 {
 public:
-    ModelBinFromDataReader(const DataReader& dr);
+    // weights are allocated from allocator, fastMalloc when null
+    ModelBinFromDataReader(const DataReader& dr, Allocator* allocator = 0);
 
     virtual Mat load(int w, int type) const;
 
 protected:
     const DataReader& dr;
+    Allocator* allocator;
 };
 
 class ModelBinFromMatArray : public ModelBin
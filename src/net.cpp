@@ -13,6 +13,7 @@
 // specific language governing permissions and limitations under the License.
 
 #include "net.h"
+#include "cpu.h"
 #include "layer_type.h"
 #include "datareader.h"
 #include "modelbin.h"
@@ -20,11 +21,17 @@
 #include "convolution.h"
 #include "convolutiondepthwise.h"
 #include "relu.h"
+#include "threadpool.h"
 
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
 
 #if NCNN_BENCHMARK
 #include "benchmark.h"
@@ -36,8 +43,271 @@
 
 namespace ncnn {
 
+// pick the packed layout a layer wants for this blob
+static int layer_elempack(const Layer* layer, const Mat& m)
+{
+    if (!layer->support_packing)
+        return 1;
+
+    int elemcount = m.c * m.elempack;
+    if (m.dims == 1) elemcount = m.w * m.elempack;
+    if (m.dims == 2) elemcount = m.h * m.elempack;
+
+    int elempack = layer->preferred_elempack;
+    while (elempack > 1 && elemcount % elempack != 0)
+        elempack /= 2;
+
+    // pack2 is not a layout any kernel consumes
+    return elempack >= 4 ? elempack : 1;
+}
+
+// bf16 blobs only reach layers that consume them, the others get fp32 back
+static void layer_storage_cast(const Layer* layer, Mat& m, const Option& opt)
+{
+    if (!opt.use_bf16_storage || m.empty())
+        return;
+
+    const size_t lane_size = m.elemsize / m.elempack;
+
+    Mat m_cast;
+    if (layer->support_bf16_storage && lane_size == 4u)
+        cast_float32_to_bfloat16(m, m_cast, opt);
+    else if (!layer->support_bf16_storage && lane_size == 2u)
+        cast_bfloat16_to_float32(m, m_cast, opt);
+    else
+        return;
+
+    m = m_cast;
+}
+
+// convert a bottom blob to the packing and storage the layer takes
+static void layer_prepare_bottom(const Layer* layer, Mat& m, const Option& opt)
+{
+    if (opt.use_packing_layout)
+    {
+        int elempack = layer_elempack(layer, m);
+
+        Mat m_packed;
+        convert_packing(m, m_packed, elempack, opt);
+        m = m_packed;
+    }
+
+    layer_storage_cast(layer, m, opt);
+}
+
+// one blob allocation seen while planning
+struct BlobMemoryBlock
+{
+    void* ptr;
+    size_t size;
+    int malloc_time;
+    int free_time;
+};
+
+// records the lifetime of every blob allocation of a light mode forward
+class BlobMemoryRecorder : public Allocator
+{
+public:
+    BlobMemoryRecorder() : recording(true), time(0) {}
+
+    virtual void* fastMalloc(size_t size)
+    {
+        void* ptr = ncnn::fastMalloc(size);
+
+        if (recording)
+        {
+            BlobMemoryBlock block = { ptr, size, time++, INT_MAX };
+            blocks.push_back(block);
+        }
+
+        return ptr;
+    }
+
+    virtual void fastFree(void* ptr)
+    {
+        if (recording)
+        {
+            for (int i=(int)blocks.size()-1; i>=0; i--)
+            {
+                if (blocks[i].ptr == ptr && blocks[i].free_time == INT_MAX)
+                {
+                    blocks[i].free_time = time++;
+                    break;
+                }
+            }
+        }
+
+        ncnn::fastFree(ptr);
+    }
+
+public:
+    bool recording;
+    int time;
+    std::vector<BlobMemoryBlock> blocks;
+};
+
+struct BlobMemoryBlockGreater
+{
+    const std::vector<BlobMemoryBlock>& blocks;
+    BlobMemoryBlockGreater(const std::vector<BlobMemoryBlock>& _blocks) : blocks(_blocks) {}
+
+    bool operator()(int a, int b) const
+    {
+        if (blocks[a].size != blocks[b].size)
+            return blocks[a].size > blocks[b].size;
+        return blocks[a].malloc_time < blocks[b].malloc_time;
+    }
+};
+
+// greedy by size, the largest block takes the lowest offset free over its lifetime
+static size_t plan_blob_memory(const std::vector<BlobMemoryBlock>& blocks, std::vector<size_t>& offsets)
+{
+    const int count = blocks.size();
+
+    std::vector<int> order(count);
+    for (int i=0; i<count; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), BlobMemoryBlockGreater(blocks));
+
+    offsets.assign(count, 0);
+
+    size_t arena_size = 0;
+    std::vector<int> placed;
+    for (int i=0; i<count; i++)
+    {
+        const BlobMemoryBlock& b = blocks[order[i]];
+        const size_t size = alignSize(b.size, MALLOC_ALIGN);
+
+        // live ranges of the placed blocks that coexist with this one
+        std::vector< std::pair<size_t, size_t> > ranges;
+        for (size_t j=0; j<placed.size(); j++)
+        {
+            const BlobMemoryBlock& p = blocks[placed[j]];
+            if (p.malloc_time < b.free_time && b.malloc_time < p.free_time)
+            {
+                ranges.push_back(std::make_pair(offsets[placed[j]], alignSize(p.size, MALLOC_ALIGN)));
+            }
+        }
+        std::sort(ranges.begin(), ranges.end());
+
+        size_t offset = 0;
+        for (size_t j=0; j<ranges.size(); j++)
+        {
+            if (offset + size <= ranges[j].first)
+                break;
+
+            offset = std::max(offset, ranges[j].first + ranges[j].second);
+        }
+
+        offsets[order[i]] = offset;
+        placed.push_back(order[i]);
+
+        arena_size = std::max(arena_size, offset + size);
+    }
+
+    return arena_size;
+}
+
+// serves the planned blob allocations of one extractor from a single arena
+// an allocation that does not follow the plan goes to the fallback allocator
+// the plan is copied so that a later plan_memory never changes it underneath
+class BlobArenaAllocator : public Allocator
+{
+public:
+    BlobArenaAllocator(const std::vector<size_t>& _sizes, const std::vector<size_t>& _offsets, size_t _arena_size, Allocator* _fallback)
+        : sizes(_sizes), offsets(_offsets), arena_size(_arena_size), fallback(_fallback), index(0)
+    {
+        arena = (unsigned char*)ncnn::fastMalloc(arena_size);
+    }
+
+    virtual ~BlobArenaAllocator()
+    {
+        ncnn::fastFree(arena);
+    }
+
+    // rewind to the first planned allocation for the next inference
+    void reset()
+    {
+        index = 0;
+        live.clear();
+    }
+
+    // no blob is held in the arena
+    bool idle() const
+    {
+        return live.empty();
+    }
+
+    bool follows(const std::vector<size_t>& _sizes, const std::vector<size_t>& _offsets, Allocator* _fallback) const
+    {
+        return sizes == _sizes && offsets == _offsets && fallback == _fallback;
+    }
+
+    virtual void* fastMalloc(size_t size)
+    {
+        if (arena && index < sizes.size())
+        {
+            size_t i = index++;
+
+            if (sizes[i] == size && !overlap_live(offsets[i], size))
+            {
+                live.push_back(i);
+                return arena + offsets[i];
+            }
+        }
+
+        return fallback ? fallback->fastMalloc(size) : ncnn::fastMalloc(size);
+    }
+
+    virtual void fastFree(void* ptr)
+    {
+        if (ptr >= arena && ptr < arena + arena_size)
+        {
+            for (size_t j=0; j<live.size(); j++)
+            {
+                if (arena + offsets[live[j]] == ptr)
+                {
+                    live.erase(live.begin() + j);
+                    break;
+                }
+            }
+            return;
+        }
+
+        if (fallback)
+            fallback->fastFree(ptr);
+        else
+            ncnn::fastFree(ptr);
+    }
+
+protected:
+    // never hand out memory a live blob still occupies, even off plan
+    bool overlap_live(size_t offset, size_t size) const
+    {
+        for (size_t j=0; j<live.size(); j++)
+        {
+            size_t i = live[j];
+            if (offset < offsets[i] + sizes[i] && offsets[i] < offset + size)
+                return true;
+        }
+
+        return false;
+    }
+
+    std::vector<size_t> sizes;
+    std::vector<size_t> offsets;
+    size_t arena_size;
+    Allocator* fallback;
+    unsigned char* arena;
+    size_t index;
+    std::vector<size_t> live;
+};
+
 Net::Net()
 {
+    branch_thread_pool = 0;
+    memory_plan_size = 0;
+
 #if NCNN_VULKAN
     vkdev = 0;
     weight_vkallocator = 0;
@@ -55,6 +325,8 @@ Net::~Net()
 {
     clear();
 
+    delete branch_thread_pool;
+
 #if NCNN_VULKAN
     delete cast_float32_to_float16;
     delete cast_float16_to_float32;
@@ -307,6 +579,9 @@ int Net::load_param(const DataReader& dr)
     }
 
 #undef SCAN_VALUE
+
+    build_forward_schedules();
+
     return 0;
 }
 #endif // NCNN_STRING
@@ -479,6 +754,9 @@ int Net::load_param_bin(const DataReader& dr)
     }
 
 #undef READ_VALUE
+
+    build_forward_schedules();
+
     return 0;
 }
 
@@ -493,7 +771,7 @@ int Net::load_model(const DataReader& dr)
     // load file
     int ret = 0;
 
-    ModelBinFromDataReader mb(dr);
+    ModelBinFromDataReader mb(dr, opt.weight_allocator);
     for (size_t i=0; i<layers.size(); i++)
     {
         Layer* layer = layers[i];
@@ -848,6 +1126,13 @@ void Net::clear()
     destroy_pipeline();
 #endif // NCNN_VULKAN
 
+    memory_plan_sizes.clear();
+    memory_plan_offsets.clear();
+    memory_plan_size = 0;
+
+    blob_schedules.clear();
+    blob_schedules_built.clear();
+
     blobs.clear();
     for (size_t i=0; i<layers.size(); i++)
     {
@@ -881,6 +1166,87 @@ Extractor Net::create_extractor() const
     return Extractor(this, blobs.size());
 }
 
+int Net::plan_memory(const std::vector<int>& input_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_indexes)
+{
+    memory_plan_sizes.clear();
+    memory_plan_offsets.clear();
+    memory_plan_size = 0;
+
+    if (input_indexes.size() != inputs.size())
+        return -1;
+
+    if (opt.use_vulkan_compute || opt.use_branch_parallel)
+    {
+        fprintf(stderr, "memory plan is for serial cpu inference only\n");
+        return -1;
+    }
+
+    // dry run, the order of allocations and frees is the order of a real forward
+    BlobMemoryRecorder recorder;
+    {
+        Extractor ex = create_extractor();
+        ex.set_light_mode(true);
+        ex.set_blob_allocator(&recorder);
+
+        for (size_t i=0; i<inputs.size(); i++)
+        {
+            int ret = ex.input(input_indexes[i], inputs[i]);
+            if (ret != 0)
+                return ret;
+        }
+
+        for (size_t i=0; i<output_indexes.size(); i++)
+        {
+            Mat out;
+            int ret = ex.extract(output_indexes[i], out);
+            if (ret != 0)
+                return ret;
+        }
+
+        recorder.recording = false;
+    }
+
+    const std::vector<BlobMemoryBlock>& blocks = recorder.blocks;
+
+    memory_plan_sizes.resize(blocks.size());
+    for (size_t i=0; i<blocks.size(); i++)
+    {
+        memory_plan_sizes[i] = blocks[i].size;
+    }
+
+    memory_plan_size = plan_blob_memory(blocks, memory_plan_offsets);
+
+    return 0;
+}
+
+#if NCNN_STRING
+int Net::plan_memory(const std::vector<const char*>& input_names, const std::vector<Mat>& inputs, const std::vector<const char*>& output_names)
+{
+    std::vector<int> input_indexes(input_names.size());
+    for (size_t i=0; i<input_names.size(); i++)
+    {
+        input_indexes[i] = find_blob_index_by_name(input_names[i]);
+        if (input_indexes[i] == -1)
+            return -1;
+    }
+
+    std::vector<int> output_indexes(output_names.size());
+    for (size_t i=0; i<output_names.size(); i++)
+    {
+        output_indexes[i] = find_blob_index_by_name(output_names[i]);
+        if (output_indexes[i] == -1)
+            return -1;
+    }
+
+    return plan_memory(input_indexes, inputs, output_indexes);
+}
+#endif // NCNN_STRING
+
+size_t Net::planned_memory_size() const
+{
+    return memory_plan_size;
+}
+
 #if NCNN_VULKAN
 void Net::set_vulkan_device(int device_index)
 {
@@ -1087,124 +1453,1190 @@ Layer* Net::create_custom_layer(int index)
     return layer_creator();
 }
 
-int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Option& opt) const
+void Net::build_forward_schedule(int blob_index, ForwardSchedule& schedule) const
 {
-    const Layer* layer = layers[layer_index];
-
-//     fprintf(stderr, "forward_layer %d %s\n", layer_index, layer->name.c_str());
-
-    if (layer->one_blob_only)
+    schedule.layer_indexes.clear();
+    schedule.last_use.clear();
+    schedule.producer_steps.clear();
+    schedule.consumer_steps.clear();
+    schedule.top_slots.clear();
+    schedule.bottom_slots.clear();
+    schedule.slot_blobs.clear();
+    schedule.max_width = 0;
+
+    int producer = blobs[blob_index].producer;
+    if (producer == -1)
+        return;
+
+    // depth first post order over the producers, the order the recursion used to take
+    std::vector<unsigned char> visited(layers.size(), 0);
+    std::vector< std::pair<int, int> > stack;
+    stack.push_back(std::make_pair(producer, 0));
+    visited[producer] = 1;
+    while (!stack.empty())
     {
-        // load bottom blob
-        int bottom_blob_index = layer->bottoms[0];
-        int top_blob_index = layer->tops[0];
+        const int layer_index = stack.back().first;
+        const int j = stack.back().second;
 
-        if (blob_mats[bottom_blob_index].dims == 0)
+        const Layer* layer = layers[layer_index];
+        if (j < (int)layer->bottoms.size())
         {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt);
-            if (ret != 0)
-                return ret;
-        }
+            stack.back().second++;
 
-        Mat bottom_blob = blob_mats[bottom_blob_index];
-
-        if (opt.lightmode)
-        {
-            // delete after taken in light mode
-            blob_mats[bottom_blob_index].release();
-            // deep copy for inplace forward if data is shared
-            if (layer->support_inplace && *bottom_blob.refcount != 1)
+            int bottom_producer = blobs[layer->bottoms[j]].producer;
+            if (bottom_producer != -1 && !visited[bottom_producer])
             {
-                bottom_blob = bottom_blob.clone();
+                visited[bottom_producer] = 1;
+                stack.push_back(std::make_pair(bottom_producer, 0));
             }
+            continue;
         }
 
-        if (opt.use_packing_layout)
-        {
-            int elempack = layer->support_packing ? 4 : 1;
+        schedule.layer_indexes.push_back(layer_index);
+        stack.pop_back();
+    }
 
-            Mat bottom_blob_packed;
-            convert_packing(bottom_blob, bottom_blob_packed, elempack, opt);
-            bottom_blob = bottom_blob_packed;
-        }
+    const int step_count = schedule.layer_indexes.size();
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
-        {
-            Mat& bottom_top_blob = bottom_blob;
-#if NCNN_BENCHMARK
-            double start = get_current_time();
-            int ret = layer->forward_inplace(bottom_top_blob, opt);
-            double end = get_current_time();
-            benchmark(layer, bottom_top_blob, bottom_top_blob, start, end);
-#else
-            int ret = layer->forward_inplace(bottom_top_blob, opt);
-#endif // NCNN_BENCHMARK
-            if (ret != 0)
-                return ret;
+    // dependencies between the steps, for running independent branches together
+    std::vector<int> step_of_layer(layers.size(), -1);
+    for (int i=0; i<step_count; i++)
+    {
+        step_of_layer[schedule.layer_indexes[i]] = i;
+    }
 
-            // store top blob
-            blob_mats[top_blob_index] = bottom_top_blob;
-        }
-        else
+    schedule.producer_steps.resize(step_count);
+    schedule.consumer_steps.resize(step_count);
+    std::vector<int> depth(step_count, 0);
+    std::vector<int> width(step_count, 0);
+    for (int i=0; i<step_count; i++)
+    {
+        const Layer* layer = layers[schedule.layer_indexes[i]];
+
+        for (size_t j=0; j<layer->bottoms.size(); j++)
         {
-            Mat top_blob;
-#if NCNN_BENCHMARK
-            double start = get_current_time();
-            int ret = layer->forward(bottom_blob, top_blob, opt);
-            double end = get_current_time();
-            benchmark(layer, bottom_blob, top_blob, start, end);
-#else
-            int ret = layer->forward(bottom_blob, top_blob, opt);
-#endif // NCNN_BENCHMARK
-            if (ret != 0)
-                return ret;
+            int bottom_producer = blobs[layer->bottoms[j]].producer;
+            int p = bottom_producer == -1 ? -1 : step_of_layer[bottom_producer];
+            if (p == -1)
+                continue;
 
-            // store top blob
-            blob_mats[top_blob_index] = top_blob;
+            std::vector<int>& producer_steps = schedule.producer_steps[i];
+            if (std::find(producer_steps.begin(), producer_steps.end(), p) != producer_steps.end())
+                continue;
+
+            producer_steps.push_back(p);
+            schedule.consumer_steps[p].push_back(i);
+
+            depth[i] = std::max(depth[i], depth[p] + 1);
         }
 
+        // layers of the same depth never depend on each other
+        width[depth[i]]++;
+        schedule.max_width = std::max(schedule.max_width, width[depth[i]]);
     }
-    else
+
+    // number the blobs the schedule produces, so a run only touches its own blobs
+    std::vector<int> slot_of_blob(blobs.size(), -1);
+    schedule.top_slots.resize(step_count);
+    schedule.bottom_slots.resize(step_count);
+    for (int i=0; i<step_count; i++)
     {
-        // load bottom blobs
-        std::vector<Mat> bottom_blobs(layer->bottoms.size());
-        for (size_t i=0; i<layer->bottoms.size(); i++)
+        const Layer* layer = layers[schedule.layer_indexes[i]];
+
+        schedule.top_slots[i].resize(layer->tops.size());
+        for (size_t j=0; j<layer->tops.size(); j++)
         {
-            int bottom_blob_index = layer->bottoms[i];
+            slot_of_blob[layer->tops[j]] = schedule.slot_blobs.size();
+            schedule.top_slots[i][j] = schedule.slot_blobs.size();
+            schedule.slot_blobs.push_back(layer->tops[j]);
+        }
+    }
+    for (int i=0; i<step_count; i++)
+    {
+        const Layer* layer = layers[schedule.layer_indexes[i]];
 
-            if (blob_mats[bottom_blob_index].dims == 0)
-            {
-                int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt);
-                if (ret != 0)
-                    return ret;
-            }
+        schedule.bottom_slots[i].resize(layer->bottoms.size());
+        for (size_t j=0; j<layer->bottoms.size(); j++)
+        {
+            schedule.bottom_slots[i][j] = slot_of_blob[layer->bottoms[j]];
+        }
+    }
 
-            bottom_blobs[i] = blob_mats[bottom_blob_index];
+    // mark the last use of every bottom, light mode releases it there
+    schedule.last_use.resize(step_count);
+    std::vector<unsigned char> used(blobs.size(), 0);
+    for (int i=step_count-1; i>=0; i--)
+    {
+        const Layer* layer = layers[schedule.layer_indexes[i]];
+        const int bottom_count = layer->bottoms.size();
 
-            if (opt.lightmode)
-            {
-                // delete after taken in light mode
-                blob_mats[bottom_blob_index].release();
-                // deep copy for inplace forward if data is shared
-                if (layer->support_inplace && *bottom_blobs[i].refcount != 1)
-                {
-                    bottom_blobs[i] = bottom_blobs[i].clone();
-                }
-            }
+        schedule.last_use[i].resize(bottom_count);
+        for (int j=bottom_count-1; j>=0; j--)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+            schedule.last_use[i][j] = used[bottom_blob_index] ? 0 : 1;
+            used[bottom_blob_index] = 1;
+        }
+    }
+}
 
-            if (opt.use_packing_layout)
-            {
-                int elempack = layer->support_packing ? 4 : 1;
+void Net::build_forward_schedules()
+{
+    blob_schedules.clear();
+    blob_schedules.resize(blobs.size());
+    blob_schedules_built.assign(blobs.size(), 0);
 
-                Mat bottom_blob_packed;
-                convert_packing(bottom_blobs[i], bottom_blob_packed, elempack, opt);
-                bottom_blobs[i] = bottom_blob_packed;
-            }
-        }
+    for (size_t i=0; i<layers.size(); i++)
+    {
+        if (!layers[i])
+            return;
+    }
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
+    // the blobs nothing consumes are the usual extract targets
+    for (size_t i=0; i<blobs.size(); i++)
+    {
+        if (blobs[i].consumers.empty())
+        {
+            build_forward_schedule(i, blob_schedules[i]);
+            blob_schedules_built[i] = 1;
+        }
+    }
+}
+
+const Net::ForwardSchedule& Net::get_forward_schedule(int blob_index) const
+{
+    // blob_schedules is never resized after load, the returned schedule stays put
+    MutexLockGuard lock(blob_schedules_lock);
+
+    if (!blob_schedules_built[blob_index])
+    {
+        build_forward_schedule(blob_index, blob_schedules[blob_index]);
+        blob_schedules_built[blob_index] = 1;
+    }
+
+    return blob_schedules[blob_index];
+}
+
+static size_t blob_bytes(const Mat& m)
+{
+    return m.total() * m.elemsize;
+}
+
+// bytes of the blob data in mats, the data already in seen is not counted again
+static size_t blob_data_bytes(const std::vector<Mat>& mats, std::set<const void*>& seen)
+{
+    size_t bytes = 0;
+    for (size_t i=0; i<mats.size(); i++)
+    {
+        const Mat& m = mats[i];
+        if (!m.data || !seen.insert(m.data).second)
+            continue;
+
+        bytes += blob_bytes(m);
+    }
+
+    return bytes;
+}
+
+// the bytes of the distinct blob data held by a set of blob slots, kept up to date slot by slot
+class LiveBlobBytes
+{
+public:
+    LiveBlobBytes() : bytes(0) {}
+
+    void add(const Mat& m)
+    {
+        if (m.data && slots[m.data]++ == 0)
+            bytes += blob_bytes(m);
+    }
+
+    void remove(const Mat& m)
+    {
+        if (!m.data)
+            return;
+
+        std::map<const void*, int>::iterator it = slots.find(m.data);
+        if (--it->second == 0)
+        {
+            bytes -= blob_bytes(m);
+            slots.erase(it);
+        }
+    }
+
+    size_t bytes;
+    // the slots holding each data
+    std::map<const void*, int> slots;
+};
+
+// add the top and live blob bytes of one layer, before its tops are stored
+static void measure_layer_memory(const std::vector<Mat>& blob_mats, const std::vector<Mat>& bottom_blobs, const std::vector<Mat>& top_blobs, size_t& top_bytes, size_t& live_bytes)
+{
+    std::set<const void*> seen;
+
+    // inplace tops share the data of a bottom
+    blob_data_bytes(bottom_blobs, seen);
+    top_bytes += blob_data_bytes(top_blobs, seen);
+
+    seen.clear();
+    live_bytes += blob_data_bytes(blob_mats, seen);
+    live_bytes += blob_data_bytes(bottom_blobs, seen);
+    live_bytes += blob_data_bytes(top_blobs, seen);
+}
+
+static void record_layer_memory(LayerMemoryStatistics& stats, size_t top_bytes, size_t live_bytes)
+{
+    stats.top_bytes = std::max(stats.top_bytes, top_bytes);
+    stats.live_bytes = std::max(stats.live_bytes, live_bytes);
+    stats.forward_count++;
+}
+
+int Net::forward_blob(int blob_index, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const
+{
+    return forward_schedule(get_forward_schedule(blob_index), blob_index, blob_mats, opt, layer_statistics);
+}
+
+void Net::mark_schedule_run(const ForwardSchedule& schedule, int blob_index, const std::vector<Mat>& blob_mats, std::vector<unsigned char>& run) const
+{
+    const int step_count = schedule.layer_indexes.size();
+
+    // walk back from the wanted blob, skip the layers whose tops are already there
+    // the wanted blob is a top of the last step, the other blobs are only reached through slots
+    std::vector<unsigned char> needed(schedule.slot_blobs.size(), 0);
+    run.assign(step_count, 0);
+    for (int i=step_count-1; i>=0; i--)
+    {
+        const std::vector<int>& top_slots = schedule.top_slots[i];
+        for (size_t j=0; j<top_slots.size(); j++)
+        {
+            int top_blob_index = schedule.slot_blobs[top_slots[j]];
+            if ((needed[top_slots[j]] || top_blob_index == blob_index) && blob_mats[top_blob_index].dims == 0)
+            {
+                run[i] = 1;
+                break;
+            }
+        }
+
+        if (!run[i])
+            continue;
+
+        const std::vector<int>& bottom_slots = schedule.bottom_slots[i];
+        for (size_t j=0; j<bottom_slots.size(); j++)
+        {
+            if (bottom_slots[j] != -1)
+                needed[bottom_slots[j]] = 1;
+        }
+    }
+}
+
+int Net::forward_schedule(const ForwardSchedule& schedule, int blob_index, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const
+{
+    const int step_count = schedule.layer_indexes.size();
+
+    std::vector<unsigned char> run;
+    mark_schedule_run(schedule, blob_index, blob_mats, run);
+
+    if (opt.lightmode && opt.memory_budget > 0)
+    {
+        return forward_schedule_budget(schedule, run, blob_mats, opt, layer_statistics);
+    }
+
+    if (opt.use_branch_parallel && opt.num_threads > 1 && schedule.max_width > 1)
+    {
+        return forward_schedule_parallel(schedule, run, blob_mats, opt, layer_statistics);
+    }
+
+    std::vector<Mat> bottom_blobs;
+    std::vector<Mat> top_blobs;
+    for (int i=0; i<step_count; i++)
+    {
+        if (!run[i])
+        {
+            release_skipped_bottoms(schedule, i, opt, blob_mats);
+            continue;
+        }
+
+        const int layer_index = schedule.layer_indexes[i];
+        const unsigned char* last_use = schedule.last_use[i].empty() ? 0 : &schedule.last_use[i][0];
+
+        int ret = take_bottom_blobs(layer_index, blob_mats, opt, last_use, bottom_blobs);
+        if (ret != 0)
+            return ret;
+
+        clone_shared_bottoms(layer_index, opt, bottom_blobs);
+
+        ret = forward_layer(layer_index, bottom_blobs, top_blobs, opt);
+        if (ret != 0)
+            return ret;
+
+        if (layer_statistics)
+        {
+            size_t top_bytes = 0;
+            size_t live_bytes = 0;
+            measure_layer_memory(blob_mats, bottom_blobs, top_blobs, top_bytes, live_bytes);
+            record_layer_memory(layer_statistics[layer_index], top_bytes, live_bytes);
+        }
+
+        store_top_blobs(layer_index, blob_mats, bottom_blobs, top_blobs);
+    }
+
+    return 0;
+}
+
+int Net::forward_blob_batch(int blob_index, std::vector< std::vector<Mat> >& blob_mats_batch, Option& opt, LayerMemoryStatistics* layer_statistics) const
+{
+    return forward_schedule_batch(get_forward_schedule(blob_index), blob_index, blob_mats_batch, opt, layer_statistics);
+}
+
+int Net::forward_schedule_batch(const ForwardSchedule& schedule, int blob_index, std::vector< std::vector<Mat> >& blob_mats_batch, Option& opt, LayerMemoryStatistics* layer_statistics) const
+{
+    const int step_count = schedule.layer_indexes.size();
+    const int batch = blob_mats_batch.size();
+
+    // the items go through the same layers
+    std::vector<unsigned char> run;
+    mark_schedule_run(schedule, blob_index, blob_mats_batch[0], run);
+
+    std::vector< std::vector<Mat> > bottom_blobs(batch);
+    std::vector< std::vector<Mat> > top_blobs(batch);
+    std::vector<Mat> bottom_batch(batch);
+    std::vector<Mat> top_batch;
+    for (int i=0; i<step_count; i++)
+    {
+        if (!run[i])
+        {
+            for (int b=0; b<batch; b++)
+            {
+                release_skipped_bottoms(schedule, i, opt, blob_mats_batch[b]);
+            }
+            continue;
+        }
+
+        const int layer_index = schedule.layer_indexes[i];
+        const Layer* layer = layers[layer_index];
+        const unsigned char* last_use = schedule.last_use[i].empty() ? 0 : &schedule.last_use[i][0];
+
+        for (int b=0; b<batch; b++)
+        {
+            int ret = take_bottom_blobs(layer_index, blob_mats_batch[b], opt, last_use, bottom_blobs[b]);
+            if (ret != 0)
+                return ret;
+
+            clone_shared_bottoms(layer_index, opt, bottom_blobs[b]);
+        }
+
+        if (layer->one_blob_only && layer->support_batch)
+        {
+            // one call for the whole batch
+            for (int b=0; b<batch; b++)
+            {
+                bottom_batch[b] = bottom_blobs[b][0];
+                layer_prepare_bottom(layer, bottom_batch[b], opt);
+            }
+
+            int ret = layer->forward_batch(bottom_batch, top_batch, opt);
+            if (ret != 0)
+                return ret;
+
+            for (int b=0; b<batch; b++)
+            {
+                top_blobs[b].resize(1);
+                top_blobs[b][0] = top_batch[b];
+                bottom_batch[b].release();
+            }
+            top_batch.clear();
+        }
+        else
+        {
+            for (int b=0; b<batch; b++)
+            {
+                int ret = forward_layer(layer_index, bottom_blobs[b], top_blobs[b], opt);
+                if (ret != 0)
+                    return ret;
+            }
+        }
+
+        if (layer_statistics)
+        {
+            // the items add up
+            size_t top_bytes = 0;
+            size_t live_bytes = 0;
+            for (int b=0; b<batch; b++)
+            {
+                measure_layer_memory(blob_mats_batch[b], bottom_blobs[b], top_blobs[b], top_bytes, live_bytes);
+            }
+            record_layer_memory(layer_statistics[layer_index], top_bytes, live_bytes);
+        }
+
+        for (int b=0; b<batch; b++)
+        {
+            store_top_blobs(layer_index, blob_mats_batch[b], bottom_blobs[b], top_blobs[b]);
+        }
+    }
+
+    return 0;
+}
+
+// shared by the workers of one branch parallel forward
+struct BranchForwardContext
+{
+    const Net* net;
+    const void* schedule;
+    const std::vector<unsigned char>* run;
+    std::vector<Mat>* blob_mats;
+    Option opt;
+    LayerMemoryStatistics* layer_statistics;
+
+    // guards blob_mats, the counters below and every push to the queues
+    Mutex lock;
+    ConditionVariable cond;
+
+    // per worker, the steps whose bottoms are all there
+    // the owner takes from the back, the others steal from the front
+    std::vector< std::deque<int> > queues;
+    Mutex* queue_locks;
+    // per step, the producer steps still to finish
+    std::vector<int> pending;
+    // steps to finish, steps in flight
+    int remaining;
+    int running;
+    int ret;
+};
+
+// the own queue first, then the other queues in turn
+static int pop_branch_step(BranchForwardContext* ctx, int worker)
+{
+    const int worker_count = ctx->queues.size();
+    for (int k=0; k<worker_count; k++)
+    {
+        const int q = (worker + k) % worker_count;
+
+        MutexLockGuard guard(ctx->queue_locks[q]);
+
+        std::deque<int>& queue = ctx->queues[q];
+        if (queue.empty())
+            continue;
+
+        int i;
+        if (k == 0)
+        {
+            i = queue.back();
+            queue.pop_back();
+        }
+        else
+        {
+            i = queue.front();
+            queue.pop_front();
+        }
+
+        return i;
+    }
+
+    return -1;
+}
+
+static int queued_branch_steps(BranchForwardContext* ctx)
+{
+    int count = 0;
+    for (size_t q=0; q<ctx->queues.size(); q++)
+    {
+        MutexLockGuard guard(ctx->queue_locks[q]);
+        count += ctx->queues[q].size();
+    }
+
+    return count;
+}
+
+// one worker of a branch parallel forward, it returns when the forward is done
+class BranchForwardTask : public ParallelTask
+{
+public:
+    BranchForwardTask(BranchForwardContext* _ctx) : ctx(_ctx) {}
+
+    virtual void operator()(int worker) const
+    {
+        Net::forward_branch_worker(ctx, worker);
+    }
+
+    BranchForwardContext* ctx;
+};
+
+ThreadPool* Net::get_branch_thread_pool(const Option& opt) const
+{
+    MutexLockGuard lock(branch_thread_pool_lock);
+
+    if (!branch_thread_pool)
+    {
+        // idle workers block, a net that rarely runs branch parallel costs no spinning cores
+        branch_thread_pool = new ThreadPool(std::max(opt.num_threads, get_cpu_count()) - 1, ThreadPool::WAIT_BLOCK);
+    }
+
+    return branch_thread_pool;
+}
+
+int Net::forward_schedule_parallel(const ForwardSchedule& schedule, const std::vector<unsigned char>& run, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const
+{
+    const int step_count = schedule.layer_indexes.size();
+
+    // the calling thread is one of the workers
+    const int worker_count = std::min(opt.num_threads, schedule.max_width);
+
+    BranchForwardContext ctx;
+    ctx.net = this;
+    ctx.schedule = &schedule;
+    ctx.run = &run;
+    ctx.blob_mats = &blob_mats;
+    ctx.opt = opt;
+    ctx.layer_statistics = layer_statistics;
+    ctx.queues.resize(worker_count);
+    ctx.queue_locks = new Mutex[worker_count];
+    ctx.pending.resize(step_count, 0);
+    ctx.remaining = 0;
+    ctx.running = 0;
+    ctx.ret = 0;
+
+    int ready_count = 0;
+    for (int i=0; i<step_count; i++)
+    {
+        if (!run[i])
+            continue;
+
+        for (size_t j=0; j<schedule.producer_steps[i].size(); j++)
+        {
+            if (run[schedule.producer_steps[i][j]])
+                ctx.pending[i]++;
+        }
+
+        // deal the first steps out, the earliest of each queue at its back
+        if (ctx.pending[i] == 0)
+        {
+            ctx.queues[ready_count % worker_count].push_front(i);
+            ready_count++;
+        }
+
+        ctx.remaining++;
+    }
+
+    // the workers are persistent, no thread is created per inference
+    ThreadPool* pool = opt.thread_pool ? opt.thread_pool : get_branch_thread_pool(opt);
+
+    BranchForwardTask task(&ctx);
+    pool->run(worker_count, task, worker_count);
+
+    delete[] ctx.queue_locks;
+
+    if (ctx.ret != 0)
+        return ctx.ret;
+
+    // the layers not run may still end the lifetime of a bottom the run ones read
+    for (int i=0; i<step_count; i++)
+    {
+        if (!run[i])
+            release_skipped_bottoms(schedule, i, opt, blob_mats);
+    }
+
+    return 0;
+}
+
+void Net::forward_branch_worker(void* args, int worker)
+{
+    BranchForwardContext* ctx = (BranchForwardContext*)args;
+    const Net* net = ctx->net;
+    const ForwardSchedule& schedule = *(const ForwardSchedule*)ctx->schedule;
+    const std::vector<unsigned char>& run = *ctx->run;
+    std::vector<Mat>& blob_mats = *ctx->blob_mats;
+
+    std::vector<Mat> bottom_blobs;
+    std::vector<Mat> top_blobs;
+    std::vector<int> ready;
+
+    for (;;)
+    {
+        const int i = pop_branch_step(ctx, worker);
+        if (i == -1)
+        {
+            // nothing to run or steal, sleep until a finished step queues its consumers
+            // the queues only grow under the lock, so no push is missed between the check and the wait
+            ctx->lock.lock();
+            while (queued_branch_steps(ctx) == 0 && ctx->remaining > 0 && ctx->ret == 0)
+            {
+                ctx->cond.wait(ctx->lock);
+            }
+            const bool done = ctx->remaining == 0 || ctx->ret != 0;
+            ctx->lock.unlock();
+
+            if (done)
+                break;
+
+            continue;
+        }
+
+        const int layer_index = schedule.layer_indexes[i];
+        const unsigned char* last_use = schedule.last_use[i].empty() ? 0 : &schedule.last_use[i][0];
+
+        ctx->lock.lock();
+
+        if (ctx->ret != 0)
+        {
+            ctx->lock.unlock();
+            break;
+        }
+
+        // blob_mats is only touched under the lock
+        int ret = net->take_bottom_blobs(layer_index, blob_mats, ctx->opt, last_use, bottom_blobs);
+        ctx->running++;
+
+        // share the threads among the layers in flight and the ones ready to go
+        Option opt = ctx->opt;
+        opt.num_threads = std::max(1, ctx->opt.num_threads / (ctx->running + queued_branch_steps(ctx)));
+
+        ctx->lock.unlock();
+
+        if (ret == 0)
+        {
+            // the copy runs outside the lock, only references were taken under it
+            net->clone_shared_bottoms(layer_index, opt, bottom_blobs);
+
+            ret = net->forward_layer(layer_index, bottom_blobs, top_blobs, opt);
+        }
+
+        ctx->lock.lock();
+
+        ctx->running--;
+
+        if (ret != 0)
+        {
+            ctx->ret = ret;
+            bottom_blobs.clear();
+            top_blobs.clear();
+            ctx->cond.broadcast();
+            ctx->lock.unlock();
+            break;
+        }
+
+        if (ctx->layer_statistics)
+        {
+            // the bottoms of the layers in flight are not in blob_mats
+            size_t top_bytes = 0;
+            size_t live_bytes = 0;
+            measure_layer_memory(blob_mats, bottom_blobs, top_blobs, top_bytes, live_bytes);
+            record_layer_memory(ctx->layer_statistics[layer_index], top_bytes, live_bytes);
+        }
+
+        net->store_top_blobs(layer_index, blob_mats, bottom_blobs, top_blobs);
+
+        ctx->remaining--;
+
+        ready.clear();
+        for (size_t j=0; j<schedule.consumer_steps[i].size(); j++)
+        {
+            int consumer = schedule.consumer_steps[i][j];
+            if (run[consumer] && --ctx->pending[consumer] == 0)
+                ready.push_back(consumer);
+        }
+
+        if (!ready.empty())
+        {
+            // this worker goes on with the earliest consumer, the rest are left to steal
+            std::sort(ready.begin(), ready.end());
+
+            MutexLockGuard guard(ctx->queue_locks[worker]);
+            for (int j=(int)ready.size()-1; j>=0; j--)
+            {
+                ctx->queues[worker].push_back(ready[j]);
+            }
+        }
+
+        if (ctx->remaining == 0 || ready.size() > 1)
+            ctx->cond.broadcast();
+
+        ctx->lock.unlock();
+    }
+}
+
+// layers rerun at most to rebuild one dropped blob
+static const int max_recompute_layers = 3;
+
+int Net::forward_schedule_budget(const ForwardSchedule& schedule, const std::vector<unsigned char>& run, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const
+{
+    const int step_count = schedule.layer_indexes.size();
+
+    // the pending reads of every blob, the blob goes when they drop to zero
+    // a dropped blob holds one read on each of its sources until it is rebuilt
+    std::vector<int> reads(blobs.size(), 0);
+    std::vector<int> pins(blobs.size(), 0);
+    // per blob, the run steps reading it in schedule order
+    std::vector< std::vector<int> > read_steps(blobs.size());
+
+    std::vector<int> pending(step_count, 0);
+    std::vector<unsigned char> done(step_count, 0);
+    std::vector<int> ready;
+    int recompute_budget = 0;
+    for (int i=0; i<step_count; i++)
+    {
+        if (!run[i])
+            continue;
+
+        const Layer* layer = layers[schedule.layer_indexes[i]];
+        for (size_t j=0; j<layer->bottoms.size(); j++)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+            reads[bottom_blob_index]++;
+            if (read_steps[bottom_blob_index].empty() || read_steps[bottom_blob_index].back() != i)
+                read_steps[bottom_blob_index].push_back(i);
+        }
+
+        for (size_t j=0; j<schedule.producer_steps[i].size(); j++)
+        {
+            if (run[schedule.producer_steps[i][j]])
+                pending[i]++;
+        }
+
+        if (pending[i] == 0)
+            ready.push_back(i);
+
+        recompute_budget++;
+    }
+
+    std::vector<unsigned char> dropped(blobs.size(), 0);
+    std::vector< std::vector<int> > dropped_sources(blobs.size());
+
+    // every change of blob_mats goes through live
+    LiveBlobBytes live;
+    for (size_t b=0; b<blob_mats.size(); b++)
+    {
+        live.add(blob_mats[b]);
+    }
+
+    std::vector<Mat> bottom_blobs;
+    std::vector<Mat> top_blobs;
+    std::vector<int> sources;
+    while (!ready.empty())
+    {
+        size_t live_bytes = live.bytes;
+
+        // schedule order while under the cap, the step releasing the most blob memory first otherwise
+        size_t r = 0;
+        for (size_t j=1; j<ready.size(); j++)
+        {
+            if (ready[j] < ready[r])
+                r = j;
+        }
+        if (live_bytes > opt.memory_budget)
+        {
+            size_t r_freed = 0;
+            for (size_t j=0; j<ready.size(); j++)
+            {
+                const Layer* layer = layers[schedule.layer_indexes[ready[j]]];
+
+                size_t freed = 0;
+                for (size_t k=0; k<layer->bottoms.size(); k++)
+                {
+                    const Mat& m = blob_mats[layer->bottoms[k]];
+                    if (reads[layer->bottoms[k]] == 1 && m.refcount && *m.refcount == 1)
+                        freed += blob_bytes(m);
+                }
+
+                if (freed > r_freed || (freed == r_freed && ready[j] < ready[r]))
+                {
+                    r = j;
+                    r_freed = freed;
+                }
+            }
+        }
+
+        const int i = ready[r];
+        ready.erase(ready.begin() + r);
+
+        const int layer_index = schedule.layer_indexes[i];
+        const Layer* layer = layers[layer_index];
+
+        if (layer->typeindex == LayerType::Input)
+        {
+            fprintf(stderr, "blob of layer %d %s is not set\n", layer_index, layer->name.c_str());
+            return -1;
+        }
+
+        // rebuild the dropped bottoms
+        for (size_t j=0; j<layer->bottoms.size(); j++)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+            if (blob_mats[bottom_blob_index].dims != 0)
+                continue;
+
+            if (!dropped[bottom_blob_index])
+            {
+                fprintf(stderr, "blob %d of layer %d %s is not set\n", bottom_blob_index, layer_index, layer->name.c_str());
+                return -1;
+            }
+
+            int ret = recompute_blob(bottom_blob_index, blob_mats, blob_mats[bottom_blob_index], opt);
+            if (ret != 0)
+                return ret;
+
+            live.add(blob_mats[bottom_blob_index]);
+
+            const std::vector<int>& s = dropped_sources[bottom_blob_index];
+            for (size_t k=0; k<s.size(); k++)
+            {
+                pins[s[k]]--;
+                if (--reads[s[k]] == 0)
+                {
+                    live.remove(blob_mats[s[k]]);
+                    blob_mats[s[k]].release();
+                }
+            }
+            dropped[bottom_blob_index] = 0;
+            dropped_sources[bottom_blob_index].clear();
+        }
+
+        bottom_blobs.resize(layer->bottoms.size());
+        for (size_t j=0; j<layer->bottoms.size(); j++)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+
+            bottom_blobs[j] = blob_mats[bottom_blob_index];
+
+            if (--reads[bottom_blob_index] == 0)
+            {
+                live.remove(blob_mats[bottom_blob_index]);
+                blob_mats[bottom_blob_index].release();
+            }
+            // deep copy for inplace forward if data is shared
+            if (layer->support_inplace && *bottom_blobs[j].refcount != 1)
+            {
+                bottom_blobs[j] = bottom_blobs[j].clone();
+            }
+        }
+
+        int ret = forward_layer(layer_index, bottom_blobs, top_blobs, opt);
+        if (ret != 0)
+            return ret;
+
+        if (layer_statistics)
+        {
+            size_t top_bytes = 0;
+            size_t layer_live_bytes = 0;
+            measure_layer_memory(blob_mats, bottom_blobs, top_blobs, top_bytes, layer_live_bytes);
+            record_layer_memory(layer_statistics[layer_index], top_bytes, layer_live_bytes);
+        }
+
+        for (size_t j=0; j<layer->tops.size(); j++)
+        {
+            live.remove(blob_mats[layer->tops[j]]);
+        }
+
+        store_top_blobs(layer_index, blob_mats, bottom_blobs, top_blobs);
+
+        for (size_t j=0; j<layer->tops.size(); j++)
+        {
+            live.add(blob_mats[layer->tops[j]]);
+        }
+
+        done[i] = 1;
+        for (size_t j=0; j<schedule.consumer_steps[i].size(); j++)
+        {
+            int consumer = schedule.consumer_steps[i][j];
+            if (run[consumer] && --pending[consumer] == 0)
+                ready.push_back(consumer);
+        }
+
+        live_bytes = live.bytes;
+
+        // over the cap, drop the blob that frees the most memory net of the sources it keeps alive
+        while (live_bytes > opt.memory_budget && recompute_budget > 0)
+        {
+            int drop = -1;
+            size_t drop_gain = 0;
+            int drop_layer_count = 0;
+            std::vector<int> drop_sources;
+            for (int b=0; b<(int)blobs.size(); b++)
+            {
+                const Mat& m = blob_mats[b];
+                if (m.dims == 0 || reads[b] == 0 || pins[b] > 0 || !m.refcount || *m.refcount != 1)
+                    continue;
+
+                // the steps to run next would rebuild it at once
+                int next = -1;
+                for (size_t k=0; k<read_steps[b].size(); k++)
+                {
+                    if (!done[read_steps[b][k]])
+                    {
+                        next = read_steps[b][k];
+                        break;
+                    }
+                }
+                if (next == -1 || std::find(ready.begin(), ready.end(), next) != ready.end())
+                    continue;
+
+                sources.clear();
+                int layer_count = 0;
+                if (!find_recompute_sources(b, blob_mats, sources, layer_count) || layer_count > recompute_budget)
+                    continue;
+
+                // a source no step reads at or after the next read would be kept alive only for the rebuild
+                size_t cost = 0;
+                for (size_t k=0; k<sources.size(); k++)
+                {
+                    const int s = sources[k];
+                    const Mat& sm = blob_mats[s];
+                    if (pins[s] > 0 || !sm.refcount || (!read_steps[s].empty() && read_steps[s].back() >= next))
+                        continue;
+
+                    cost += blob_bytes(sm);
+                }
+
+                const size_t bytes = blob_bytes(m);
+                if (bytes > cost && bytes - cost > drop_gain)
+                {
+                    drop = b;
+                    drop_gain = bytes - cost;
+                    drop_layer_count = layer_count;
+                    drop_sources = sources;
+                }
+            }
+
+            if (drop == -1)
+                break;
+
+            live.remove(blob_mats[drop]);
+            live_bytes = live.bytes;
+            blob_mats[drop].release();
+            dropped[drop] = 1;
+            dropped_sources[drop] = drop_sources;
+            for (size_t k=0; k<drop_sources.size(); k++)
+            {
+                pins[drop_sources[k]]++;
+                reads[drop_sources[k]]++;
+            }
+            recompute_budget -= drop_layer_count;
+        }
+    }
+
+    return 0;
+}
+
+bool Net::find_recompute_sources(int blob_index, const std::vector<Mat>& blob_mats, std::vector<int>& sources, int& layer_count) const
+{
+    const int layer_index = blobs[blob_index].producer;
+    if (layer_index < 0)
+        return false;
+
+    const Layer* layer = layers[layer_index];
+
+    // the tops of split share one data, any other alive one serves
+    if (layer->typeindex == LayerType::Split)
+    {
+        for (size_t i=0; i<layer->tops.size(); i++)
+        {
+            int top_blob_index = layer->tops[i];
+            if (top_blob_index == blob_index || blob_mats[top_blob_index].dims == 0)
+                continue;
+
+            if (std::find(sources.begin(), sources.end(), top_blob_index) == sources.end())
+                sources.push_back(top_blob_index);
+            return true;
+        }
+    }
+
+    // input layers can not be rerun
+    if (layer->bottoms.empty() || ++layer_count > max_recompute_layers)
+        return false;
+
+    for (size_t i=0; i<layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (blob_mats[bottom_blob_index].dims != 0)
+        {
+            if (std::find(sources.begin(), sources.end(), bottom_blob_index) == sources.end())
+                sources.push_back(bottom_blob_index);
+            continue;
+        }
+
+        if (!find_recompute_sources(bottom_blob_index, blob_mats, sources, layer_count))
+            return false;
+    }
+
+    return true;
+}
+
+int Net::recompute_blob(int blob_index, const std::vector<Mat>& blob_mats, Mat& m, const Option& opt) const
+{
+    const int layer_index = blobs[blob_index].producer;
+    const Layer* layer = layers[layer_index];
+
+    if (layer->typeindex == LayerType::Split)
+    {
+        for (size_t i=0; i<layer->tops.size(); i++)
+        {
+            if (blob_mats[layer->tops[i]].dims != 0)
+            {
+                m = blob_mats[layer->tops[i]];
+                return 0;
+            }
+        }
+    }
+
+    std::vector<Mat> bottom_blobs(layer->bottoms.size());
+    for (size_t i=0; i<layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (blob_mats[bottom_blob_index].dims != 0)
+        {
+            bottom_blobs[i] = blob_mats[bottom_blob_index];
+            continue;
+        }
+
+        int ret = recompute_blob(bottom_blob_index, blob_mats, bottom_blobs[i], opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    // the sources are read again later, no inplace forward on them
+    Option opt_recompute = opt;
+    opt_recompute.lightmode = false;
+
+    std::vector<Mat> top_blobs;
+    int ret = forward_layer(layer_index, bottom_blobs, top_blobs, opt_recompute);
+    if (ret != 0)
+        return ret;
+
+    for (size_t i=0; i<layer->tops.size(); i++)
+    {
+        if (layer->tops[i] == blob_index)
+            m = top_blobs[i];
+    }
+
+    return 0;
+}
+
+int Net::take_bottom_blobs(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, const unsigned char* last_use, std::vector<Mat>& bottom_blobs) const
+{
+    const Layer* layer = layers[layer_index];
+
+    // an input layer only runs when its blob was never fed, source layers like memorydata run with no bottom
+    if (layer->typeindex == LayerType::Input)
+    {
+        fprintf(stderr, "blob of layer %d %s is not set\n", layer_index, layer->name.c_str());
+        return -1;
+    }
+
+    bottom_blobs.resize(layer->bottoms.size());
+    for (size_t i=0; i<layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        bottom_blobs[i] = blob_mats[bottom_blob_index];
+
+        // delete after its last use in light mode
+        if (opt.lightmode && last_use[i])
+            blob_mats[bottom_blob_index].release();
+    }
+
+    return 0;
+}
+
+void Net::clone_shared_bottoms(int layer_index, const Option& opt, std::vector<Mat>& bottom_blobs) const
+{
+    const Layer* layer = layers[layer_index];
+
+    if (!opt.lightmode || !layer->support_inplace)
+        return;
+
+    // deep copy for inplace forward if data is shared
+    for (size_t i=0; i<bottom_blobs.size(); i++)
+    {
+        if (bottom_blobs[i].refcount && *bottom_blobs[i].refcount != 1)
+        {
+            bottom_blobs[i] = bottom_blobs[i].clone();
+        }
+    }
+}
+
+void Net::release_skipped_bottoms(const ForwardSchedule& schedule, int step, const Option& opt, std::vector<Mat>& blob_mats) const
+{
+    if (!opt.lightmode)
+        return;
+
+    const Layer* layer = layers[schedule.layer_indexes[step]];
+
+    for (size_t i=0; i<layer->bottoms.size(); i++)
+    {
+        if (schedule.last_use[step][i])
+            blob_mats[layer->bottoms[i]].release();
+    }
+}
+
+void Net::store_top_blobs(int layer_index, std::vector<Mat>& blob_mats, std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs) const
+{
+    const Layer* layer = layers[layer_index];
+
+    for (size_t i=0; i<layer->tops.size(); i++)
+    {
+        int top_blob_index = layer->tops[i];
+
+        blob_mats[top_blob_index] = top_blobs[i];
+    }
+
+    // the scratch vectors are reused, drop the references now
+    bottom_blobs.clear();
+    top_blobs.clear();
+}
+
+int Net::forward_layer(int layer_index, std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+
+//     fprintf(stderr, "forward_layer %d %s\n", layer_index, layer->name.c_str());
+
+    for (size_t i=0; i<bottom_blobs.size(); i++)
+    {
+        layer_prepare_bottom(layer, bottom_blobs[i], opt);
+    }
+
+    top_blobs.resize(layer->tops.size());
+
+    if (layer->one_blob_only)
+    {
+        Mat& bottom_blob = bottom_blobs[0];
+        Mat& top_blob = top_blobs[0];
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            Mat& bottom_top_blob = bottom_blob;
+#if NCNN_BENCHMARK
+            double start = get_current_time();
+            int ret = layer->forward_inplace(bottom_top_blob, opt);
+            double end = get_current_time();
+            benchmark(layer, bottom_top_blob, bottom_top_blob, start, end);
+#else
+            int ret = layer->forward_inplace(bottom_top_blob, opt);
+#endif // NCNN_BENCHMARK
+            if (ret != 0)
+                return ret;
+
+            top_blob = bottom_top_blob;
+        }
+        else
+        {
+#if NCNN_BENCHMARK
+            double start = get_current_time();
+            int ret = layer->forward(bottom_blob, top_blob, opt);
+            double end = get_current_time();
+            benchmark(layer, bottom_blob, top_blob, start, end);
+#else
+            int ret = layer->forward(bottom_blob, top_blob, opt);
+#endif // NCNN_BENCHMARK
+            if (ret != 0)
+                return ret;
+        }
+    }
+    else
+    {
+        // forward
+        if (opt.lightmode && layer->support_inplace)
         {
             std::vector<Mat>& bottom_top_blobs = bottom_blobs;
 #if NCNN_BENCHMARK
@@ -1218,17 +2650,13 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Option& opt
             if (ret != 0)
                 return ret;
 
-            // store top blobs
             for (size_t i=0; i<layer->tops.size(); i++)
             {
-                int top_blob_index = layer->tops[i];
-
-                blob_mats[top_blob_index] = bottom_top_blobs[i];
+                top_blobs[i] = bottom_top_blobs[i];
             }
         }
         else
         {
-            std::vector<Mat> top_blobs(layer->tops.size());
 #if NCNN_BENCHMARK
             double start = get_current_time();
             int ret = layer->forward(bottom_blobs, top_blobs, opt);
@@ -1239,19 +2667,11 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Option& opt
 #endif // NCNN_BENCHMARK
             if (ret != 0)
                 return ret;
-
-            // store top blobs
-            for (size_t i=0; i<layer->tops.size(); i++)
-            {
-                int top_blob_index = layer->tops[i];
-
-                blob_mats[top_blob_index] = top_blobs[i];
-            }
         }
     }
 
 //     fprintf(stderr, "forward_layer %d %s done\n", layer_index, layer->name.c_str());
-//     const Mat& blob = blob_mats[layer->tops[0]];
+//     const Mat& blob = top_blobs[0];
 //     fprintf(stderr, "[%-2d %-16s %-16s]  %d    blobs count = %-3d   size = %-3d x %-3d\n", layer_index, layer->type.c_str(), layer->name.c_str(), layer->tops[0], blob.c, blob.h, blob.w);
 
     return 0;
@@ -1650,13 +3070,15 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector
 
             if (opt.use_packing_layout)
             {
-                int elempack = layer->support_packing ? 4 : 1;
+                int elempack = layer_elempack(layer, bottom_blob);
 
                 Mat bottom_blob_packed;
                 convert_packing(bottom_blob, bottom_blob_packed, elempack, opt);
                 bottom_blob = bottom_blob_packed;
             }
 
+            layer_storage_cast(layer, bottom_blob, opt);
+
             // forward
             if (opt.lightmode && layer->support_inplace)
             {
@@ -1831,12 +3253,14 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector
 
                 if (opt.use_packing_layout)
                 {
-                    int elempack = layer->support_packing ? 4 : 1;
+                    int elempack = layer_elempack(layer, bottom_blobs[i]);
 
                     Mat bottom_blob_packed;
                     convert_packing(bottom_blobs[i], bottom_blob_packed, elempack, opt);
                     bottom_blobs[i] = bottom_blob_packed;
                 }
+
+                layer_storage_cast(layer, bottom_blobs[i], opt);
             }
 
             bottom_blobs_unpacked.clear();
@@ -1901,6 +3325,11 @@ Extractor::Extractor(const Net* _net, size_t blob_count) : net(_net)
     blob_mats.resize(blob_count);
     opt = net->opt;
 
+    blob_arena_allocator = 0;
+
+    use_arena = false;
+    arena_allocator = 0;
+
 #if NCNN_VULKAN
     if (net->opt.use_vulkan_compute)
     {
@@ -1912,9 +3341,83 @@ Extractor::Extractor(const Net* _net, size_t blob_count) : net(_net)
 #endif // NCNN_VULKAN
 }
 
+Extractor::Extractor(const Extractor& rhs) : net(rhs.net)
+{
+    blob_arena_allocator = 0;
+    arena_allocator = 0;
+
+#if NCNN_VULKAN
+    local_blob_vkallocator = 0;
+    local_staging_vkallocator = 0;
+#endif // NCNN_VULKAN
+
+    copy_from(rhs);
+}
+
 Extractor::~Extractor()
+{
+    release_allocators();
+}
+
+Extractor& Extractor::operator=(const Extractor& rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    release_allocators();
+
+    net = rhs.net;
+    copy_from(rhs);
+
+    return *this;
+}
+
+void Extractor::copy_from(const Extractor& rhs)
+{
+    opt = rhs.opt;
+    use_arena = rhs.use_arena;
+    layer_statistics = rhs.layer_statistics;
+
+    // the arenas stay with rhs, blobs living there are copied out
+    blob_mats = rhs.blob_mats;
+    for (size_t i=0; i<blob_mats.size(); i++)
+    {
+        rhs.detach_feat(blob_mats[i]);
+    }
+
+    blob_mats_batch = rhs.blob_mats_batch;
+    for (size_t i=0; i<blob_mats_batch.size(); i++)
+    {
+        for (size_t j=0; j<blob_mats_batch[i].size(); j++)
+        {
+            rhs.detach_feat(blob_mats_batch[i][j]);
+        }
+    }
+
+#if NCNN_VULKAN
+    // the local vkallocators stay with rhs, so do the gpu blobs
+    blob_mats_gpu.clear();
+    blob_mats_gpu.resize(rhs.blob_mats_gpu.size());
+
+    if (rhs.local_blob_vkallocator && opt.blob_vkallocator == rhs.local_blob_vkallocator)
+        opt.blob_vkallocator = 0;
+    if (rhs.local_blob_vkallocator && opt.workspace_vkallocator == rhs.local_blob_vkallocator)
+        opt.workspace_vkallocator = 0;
+    if (rhs.local_staging_vkallocator && opt.staging_vkallocator == rhs.local_staging_vkallocator)
+        opt.staging_vkallocator = 0;
+#endif // NCNN_VULKAN
+}
+
+void Extractor::release_allocators()
 {
     blob_mats.clear();
+    blob_mats_batch.clear();
+
+    // blob mats hand their memory back to the arena before it goes
+    delete blob_arena_allocator;
+    delete arena_allocator;
+    blob_arena_allocator = 0;
+    arena_allocator = 0;
 
 #if NCNN_VULKAN
     if (net->opt.use_vulkan_compute)
@@ -1930,6 +3433,8 @@ Extractor::~Extractor()
             net->vkdev->reclaim_staging_allocator(local_staging_vkallocator);
         }
     }
+    local_blob_vkallocator = 0;
+    local_staging_vkallocator = 0;
 #endif // NCNN_VULKAN
 }
 
@@ -1953,6 +3458,49 @@ void Extractor::set_workspace_allocator(Allocator* allocator)
     opt.workspace_allocator = allocator;
 }
 
+void Extractor::set_arena_mode(bool enable)
+{
+    use_arena = enable;
+}
+
+void Extractor::reset()
+{
+    for (size_t i=0; i<blob_mats.size(); i++)
+    {
+        blob_mats[i].release();
+    }
+    blob_mats_batch.clear();
+
+    if (blob_arena_allocator)
+    {
+        blob_arena_allocator->reset();
+    }
+    if (arena_allocator)
+    {
+        arena_allocator->reset();
+    }
+}
+
+void Extractor::set_memory_statistics(bool enable)
+{
+    if (!enable)
+    {
+        layer_statistics.clear();
+        return;
+    }
+
+    if (layer_statistics.empty())
+    {
+        LayerMemoryStatistics zero = {0, 0, 0};
+        layer_statistics.resize(net->layers.size(), zero);
+    }
+}
+
+const std::vector<LayerMemoryStatistics>& Extractor::layer_memory_statistics() const
+{
+    return layer_statistics;
+}
+
 #if NCNN_VULKAN
 void Extractor::set_vulkan_compute(bool enable)
 {
@@ -2000,8 +3548,94 @@ int Extractor::extract(const char* blob_name, Mat& feat)
 
     return extract(blob_index, feat);
 }
+
+int Extractor::input(const char* blob_name, const std::vector<Mat>& in)
+{
+    int blob_index = net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return input(blob_index, in);
+}
+
+int Extractor::extract(const char* blob_name, std::vector<Mat>& feat)
+{
+    int blob_index = net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return extract(blob_index, feat);
+}
 #endif // NCNN_STRING
 
+int Extractor::input(int blob_index, const std::vector<Mat>& in)
+{
+    if (blob_index < 0 || blob_index >= (int)blob_mats.size())
+        return -1;
+
+    if (in.empty())
+        return -1;
+
+    if (blob_mats_batch.empty())
+    {
+        blob_mats_batch.resize(in.size(), std::vector<Mat>(blob_mats.size()));
+    }
+
+    // every batched input carries the same item count
+    if (blob_mats_batch.size() != in.size())
+        return -1;
+
+    for (size_t i=0; i<in.size(); i++)
+    {
+        blob_mats_batch[i][blob_index] = in[i];
+    }
+
+    return 0;
+}
+
+int Extractor::extract(int blob_index, std::vector<Mat>& feat)
+{
+    if (blob_index < 0 || blob_index >= (int)blob_mats.size())
+        return -1;
+
+    if (blob_mats_batch.empty())
+        return -1;
+
+    int ret = 0;
+
+    if (blob_mats_batch[0][blob_index].dims == 0)
+    {
+        Option opt_forward = forward_option();
+
+        ret = net->forward_blob_batch(blob_index, blob_mats_batch, opt_forward, layer_statistics.empty() ? 0 : &layer_statistics[0]);
+    }
+
+    const int batch = blob_mats_batch.size();
+    feat.resize(batch);
+    for (int i=0; i<batch; i++)
+    {
+        feat[i] = blob_mats_batch[i][blob_index];
+
+        if (opt.use_packing_layout)
+        {
+            Mat feat_unpacked;
+            convert_packing(feat[i], feat_unpacked, 1, opt);
+            feat[i] = feat_unpacked;
+        }
+
+        if (opt.use_bf16_storage && feat[i].elemsize == 2u)
+        {
+            Mat feat_fp32;
+            cast_bfloat16_to_float32(feat[i], feat_fp32, opt);
+            feat[i] = feat_fp32;
+        }
+
+        detach_feat(feat[i]);
+    }
+
+    return ret;
+}
+
 int Extractor::input(int blob_index, const Mat& in)
 {
     if (blob_index < 0 || blob_index >= (int)blob_mats.size())
@@ -2021,8 +3655,6 @@ int Extractor::extract(int blob_index, Mat& feat)
 
     if (blob_mats[blob_index].dims == 0)
     {
-        int layer_index = net->blobs[blob_index].producer;
-
 #if NCNN_VULKAN
         if (opt.use_vulkan_compute)
         {
@@ -2112,10 +3744,10 @@ int Extractor::extract(int blob_index, Mat& feat)
         }
         else
         {
-            ret = net->forward_layer(layer_index, blob_mats, opt);
+            ret = forward_cpu(blob_index);
         }
 #else
-        ret = net->forward_layer(layer_index, blob_mats, opt);
+        ret = forward_cpu(blob_index);
 #endif // NCNN_VULKAN
 
     }
@@ -2129,9 +3761,79 @@ int Extractor::extract(int blob_index, Mat& feat)
         feat = bottom_blob_unpacked;
     }
 
+    if (opt.use_bf16_storage && feat.elemsize == 2u)
+    {
+        Mat feat_fp32;
+        cast_bfloat16_to_float32(feat, feat_fp32, opt);
+        feat = feat_fp32;
+    }
+
+    detach_feat(feat);
+
     return ret;
 }
 
+int Extractor::forward_cpu(int blob_index)
+{
+    Option opt_forward = forward_option();
+
+    LayerMemoryStatistics* statistics = layer_statistics.empty() ? 0 : &layer_statistics[0];
+
+    // the planned arena serves allocations in one fixed order
+    if (!opt.lightmode || opt.use_branch_parallel || opt.memory_budget > 0 || net->memory_plan_size == 0)
+        return net->forward_blob(blob_index, blob_mats, opt_forward, statistics);
+
+    // rebuild on a new plan once the old arena holds no blob
+    if (blob_arena_allocator && blob_arena_allocator->idle() && !blob_arena_allocator->follows(net->memory_plan_sizes, net->memory_plan_offsets, opt_forward.blob_allocator))
+    {
+        delete blob_arena_allocator;
+        blob_arena_allocator = 0;
+    }
+
+    if (!blob_arena_allocator)
+    {
+        blob_arena_allocator = new BlobArenaAllocator(net->memory_plan_sizes, net->memory_plan_offsets, net->memory_plan_size, opt_forward.blob_allocator);
+    }
+
+    // a new inference starts from the first planned allocation
+    if (blob_arena_allocator->idle())
+    {
+        blob_arena_allocator->reset();
+    }
+
+    opt_forward.blob_allocator = blob_arena_allocator;
+
+    return net->forward_blob(blob_index, blob_mats, opt_forward, statistics);
+}
+
+Option Extractor::forward_option()
+{
+    Option opt_forward = opt;
+
+    // the bump arena is not thread-safe and never recycles within a forward
+    if (use_arena && !opt.use_branch_parallel && opt.memory_budget == 0)
+    {
+        if (!arena_allocator)
+        {
+            arena_allocator = new ArenaAllocator;
+        }
+
+        opt_forward.blob_allocator = arena_allocator;
+        opt_forward.workspace_allocator = arena_allocator;
+    }
+
+    return opt_forward;
+}
+
+void Extractor::detach_feat(Mat& feat) const
+{
+    // arena memory is recycled by the next planned blob or on reset
+    if ((blob_arena_allocator && feat.allocator == blob_arena_allocator) || (arena_allocator && feat.allocator == arena_allocator))
+    {
+        feat = feat.clone(opt.blob_allocator);
+    }
+}
+
 #if NCNN_VULKAN
 #if NCNN_STRING
 int Extractor::input(const char* blob_name, const VkMat& in)
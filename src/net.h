@@ -34,6 +34,20 @@ class VkCompute;
 #endif // NCNN_VULKAN
 class DataReader;
 class Extractor;
+class BlobArenaAllocator;
+
+// blob memory seen at one layer, peaks over the forwards of one extractor
+struct LayerMemoryStatistics
+{
+    // bytes of the top blobs the layer allocated, inplace tops count zero
+    size_t top_bytes;
+    // bytes of all blobs alive when the layer finished, its bottoms included
+    // the largest over all layers is the peak blob memory of the forward
+    size_t live_bytes;
+    // times the layer ran
+    int forward_count;
+};
+
 class Net
 {
 public:
@@ -125,6 +139,22 @@ public:
     // construct an Extractor from network
     Extractor create_extractor() const;
 
+    // plan light mode blob memory for fixed input shapes
+    // runs the network once on inputs and extracts the outputs in the given order
+    // records when every blob allocation is made and freed, then packs them into one arena
+    // extractors created afterwards make a single arena allocation per inference
+    // as long as they see the same input shapes and extract order
+    // call after load_model, the values of inputs do not matter
+    // return 0 if success
+    int plan_memory(const std::vector<int>& input_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_indexes);
+#if NCNN_STRING
+    int plan_memory(const std::vector<const char*>& input_names, const std::vector<Mat>& inputs, const std::vector<const char*>& output_names);
+#endif // NCNN_STRING
+
+    // arena bytes one extractor takes under the current plan
+    // return 0 if there is no plan
+    size_t planned_memory_size() const;
+
 protected:
     // parse the structure of network
     // fuse int8 op dequantize and quantize by requantize
@@ -148,7 +178,56 @@ protected:
     Layer* create_custom_layer(const char* type);
 #endif // NCNN_STRING
     Layer* create_custom_layer(int index);
-    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, Option& opt) const;
+
+    // flat forward schedule producing one blob
+    struct ForwardSchedule
+    {
+        // layers in execution order
+        std::vector<int> layer_indexes;
+        // per layer and bottom, whether the bottom is used for the last time there
+        std::vector< std::vector<unsigned char> > last_use;
+        // per layer, the steps producing its bottoms and the steps consuming its tops
+        std::vector< std::vector<int> > producer_steps;
+        std::vector< std::vector<int> > consumer_steps;
+        // per layer, the schedule slots of its tops and bottoms, -1 for a bottom nothing here produces
+        std::vector< std::vector<int> > top_slots;
+        std::vector< std::vector<int> > bottom_slots;
+        // blob index of every slot
+        std::vector<int> slot_blobs;
+        // most layers that may run at the same time
+        int max_width;
+    };
+    void build_forward_schedule(int blob_index, ForwardSchedule& schedule) const;
+    void build_forward_schedules();
+    // the schedule producing blob_index, built on first use
+    const ForwardSchedule& get_forward_schedule(int blob_index) const;
+
+    void mark_schedule_run(const ForwardSchedule& schedule, int blob_index, const std::vector<Mat>& blob_mats, std::vector<unsigned char>& run) const;
+
+    // layer_statistics is indexed by layer index, null when not collected
+    int forward_blob(int blob_index, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const;
+    int forward_schedule(const ForwardSchedule& schedule, int blob_index, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const;
+    int forward_blob_batch(int blob_index, std::vector< std::vector<Mat> >& blob_mats_batch, Option& opt, LayerMemoryStatistics* layer_statistics) const;
+    int forward_schedule_batch(const ForwardSchedule& schedule, int blob_index, std::vector< std::vector<Mat> >& blob_mats_batch, Option& opt, LayerMemoryStatistics* layer_statistics) const;
+    int forward_schedule_parallel(const ForwardSchedule& schedule, const std::vector<unsigned char>& run, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const;
+    friend class BranchForwardTask;
+    static void forward_branch_worker(void* args, int worker);
+    // the pool branch parallel forward runs on when opt.thread_pool is not set
+    ThreadPool* get_branch_thread_pool(const Option& opt) const;
+
+    // light mode forward under opt.memory_budget
+    int forward_schedule_budget(const ForwardSchedule& schedule, const std::vector<unsigned char>& run, std::vector<Mat>& blob_mats, Option& opt, LayerMemoryStatistics* layer_statistics) const;
+    // the alive blobs a dropped blob is rebuilt from, false if it takes too many layers
+    bool find_recompute_sources(int blob_index, const std::vector<Mat>& blob_mats, std::vector<int>& sources, int& layer_count) const;
+    int recompute_blob(int blob_index, const std::vector<Mat>& blob_mats, Mat& m, const Option& opt) const;
+
+    int take_bottom_blobs(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, const unsigned char* last_use, std::vector<Mat>& bottom_blobs) const;
+    // light mode, the taken bottoms an inplace layer shares with other blobs are deep copied
+    void clone_shared_bottoms(int layer_index, const Option& opt, std::vector<Mat>& bottom_blobs) const;
+    // light mode, the bottoms a layer not run reads last are released all the same
+    void release_skipped_bottoms(const ForwardSchedule& schedule, int step, const Option& opt, std::vector<Mat>& blob_mats) const;
+    int forward_layer(int layer_index, std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+    void store_top_blobs(int layer_index, std::vector<Mat>& blob_mats, std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs) const;
 
 #if NCNN_VULKAN
     int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, Option& opt) const;
@@ -160,6 +239,21 @@ protected:
 
     std::vector<layer_registry_entry> custom_layer_registry;
 
+    // forward schedules by blob index, the blobs nothing consumes are built after load_param
+    // and the others on their first extract
+    mutable std::vector<ForwardSchedule> blob_schedules;
+    mutable std::vector<unsigned char> blob_schedules_built;
+    mutable Mutex blob_schedules_lock;
+
+    // branch parallel workers kept across inferences, created on first use
+    mutable ThreadPool* branch_thread_pool;
+    mutable Mutex branch_thread_pool_lock;
+
+    // light mode blob memory plan, indexed by allocation order
+    std::vector<size_t> memory_plan_sizes;
+    std::vector<size_t> memory_plan_offsets;
+    size_t memory_plan_size;
+
 #if NCNN_VULKAN
     const VulkanDevice* vkdev;
 
@@ -177,8 +271,13 @@ protected:
 class Extractor
 {
 public:
+    // a copy shares no allocator with the original, blobs in its arenas are copied out
+    Extractor(const Extractor& rhs);
+
     ~Extractor();
 
+    Extractor& operator=(const Extractor& rhs);
+
     // enable light mode
     // intermediate blob will be recycled when enabled
     // enabled by default
@@ -195,6 +294,26 @@ public:
     // set workspace memory allocator
     void set_workspace_allocator(Allocator* allocator);
 
+    // take blob and workspace memory from an arena owned by this extractor
+    // memory is never recycled within one inference and comes back all at once on reset
+    // the arena keeps its chunks, repeated inferences on one extractor make no system allocation
+    // extracted mats are copied out with the blob allocator
+    // ignored with use_branch_parallel or memory_budget
+    // disabled by default
+    void set_arena_mode(bool enable);
+
+    // drop all blob mats so that new inputs can be fed
+    // the arena memory is recycled
+    void reset();
+
+    // collect blob memory statistics per layer on the following cpu forwards
+    // disabling drops what was collected
+    // disabled by default
+    void set_memory_statistics(bool enable);
+
+    // indexed by layer index, empty when disabled
+    const std::vector<LayerMemoryStatistics>& layer_memory_statistics() const;
+
 #if NCNN_VULKAN
     void set_vulkan_compute(bool enable);
 
@@ -223,6 +342,26 @@ public:
     // return 0 if success
     int extract(int blob_index, Mat& feat);
 
+#if NCNN_STRING
+    // set a batch of inputs by blob name, one mat per item
+    // return 0 if success
+    int input(const char* blob_name, const std::vector<Mat>& in);
+
+    // get a batch of results by blob name
+    // layers with support_batch run the whole batch in one pass
+    // return 0 if success
+    int extract(const char* blob_name, std::vector<Mat>& feat);
+#endif // NCNN_STRING
+
+    // set a batch of inputs by blob index
+    // every batched input must hold the same item count
+    // return 0 if success
+    int input(int blob_index, const std::vector<Mat>& in);
+
+    // get a batch of results by blob index
+    // return 0 if success
+    int extract(int blob_index, std::vector<Mat>& feat);
+
 #if NCNN_VULKAN
 #if NCNN_STRING
     // set input by blob name
@@ -247,11 +386,39 @@ protected:
     friend Extractor Net::create_extractor() const;
     Extractor(const Net* net, size_t blob_count);
 
+    // forward on cpu, from the planned arena when there is one
+    int forward_cpu(int blob_index);
+
+    // opt with the extractor arena as blob and workspace allocator when enabled
+    Option forward_option();
+
+    // copy feat out of memory owned by the extractor
+    void detach_feat(Mat& feat) const;
+
+    // take over the blobs and options of rhs, never its allocators
+    void copy_from(const Extractor& rhs);
+
+    // drop all blobs and then the allocators they came from
+    void release_allocators();
+
 private:
     const Net* net;
     std::vector<Mat> blob_mats;
     Option opt;
 
+    // serves blob memory by the net memory plan, created on first forward
+    BlobArenaAllocator* blob_arena_allocator;
+
+    // bump allocator for set_arena_mode, created on first forward
+    bool use_arena;
+    ArenaAllocator* arena_allocator;
+
+    // per batch item blob mats, filled by the batched input
+    std::vector< std::vector<Mat> > blob_mats_batch;
+
+    // one per layer when memory statistics are enabled
+    std::vector<LayerMemoryStatistics> layer_statistics;
+
 #if NCNN_VULKAN
     VkAllocator* local_blob_vkallocator;
     VkAllocator* local_staging_vkallocator;
@@ -22,8 +22,10 @@ Option::Option()
 {
     lightmode = true;
     num_threads = get_cpu_count();
+    thread_pool = 0;
     blob_allocator = 0;
     workspace_allocator = 0;
+    weight_allocator = 0;
 
 #if NCNN_VULKAN
     blob_vkallocator = 0;
@@ -47,6 +49,13 @@ Option::Option()
 
     use_shader_pack8 = false;
 
+    use_weight_fp16_storage = false;
+    use_bf16_storage = false;
+
+    use_branch_parallel = false;
+
+    memory_budget = 0;
+
     // sanitize
     if (num_threads <= 0)
         num_threads = 1;
@@ -25,6 +25,7 @@ class VkAllocator;
 #endif // NCNN_VULKAN
 
 class Allocator;
+class ThreadPool;
 class Option
 {
 public:
@@ -41,12 +42,24 @@ public:
     // default value is the one returned by get_cpu_count()
     int num_threads;
 
+    // run the parallel loops of the layers on this pool instead of openmp
+    // several nets may share one pool, num_threads still caps the threads per loop
+    // layers not ported to parallel_for keep their openmp loops
+    // default value is null
+    ThreadPool* thread_pool;
+
     // blob memory allocator
     Allocator *blob_allocator;
 
     // workspace memory allocator
     Allocator *workspace_allocator;
 
+    // weight memory allocator
+    // used for the weights read by load_model and the x86 gemm weights packed in create_pipeline
+    // must outlive the net
+    // default value is null, which means fastMalloc
+    Allocator *weight_allocator;
+
 #if NCNN_VULKAN
     // blob memory allocator
     VkAllocator *blob_vkallocator;
@@ -92,6 +105,34 @@ public:
     bool use_shader_pack8;
 
     bool use_int32_storage;
+
+    // keep convolution and innerproduct weights in fp16 on cpu
+    // halves weight memory and bandwidth, weights are widened to fp32 inside the gemm
+    // changes should be applied before loading network structure and weight
+    // disabled by default
+    bool use_weight_fp16_storage;
+
+    // enable bfloat16 storage on cpu
+    // blobs between layers with support_bf16_storage and their weights are kept in bf16, arithmetic stays fp32
+    // changes should be applied before loading network structure and weight
+    // disabled by default
+    bool use_bf16_storage;
+
+    // run independent branches of the graph at the same time on cpu
+    // num_threads is shared among the layers in flight
+    // the branches run on thread_pool when set, on workers the net keeps otherwise
+    // blob and workspace allocators must be thread-safe when enabled
+    // disabled by default
+    bool use_branch_parallel;
+
+    // cap on the bytes of the blobs alive at once in a light mode cpu forward
+    // over the cap, the ready layer freeing the most blob memory runs first
+    // and blobs that can be rebuilt from blobs kept anyway are dropped and recomputed on their next use
+    // recompute costs at most one more pass over the network, past that the cap is exceeded
+    // workspace and the blobs of the running layer are not capped
+    // branch parallel, the memory plan and arena mode are not used under a cap
+    // default value is 0, which means no cap
+    size_t memory_budget;
 };
 
 } // namespace ncnn
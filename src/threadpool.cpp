@@ -0,0 +1,284 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// cpu_set_t and sched_setaffinity
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "threadpool.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include "allocator.h"
+#include "option.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace ncnn {
+
+ParallelTask::~ParallelTask()
+{
+}
+
+// one run in flight, lives on the stack of the calling thread
+class ThreadPoolJob
+{
+public:
+    void work()
+    {
+        int i;
+        while ((i = NCNN_XADD(&next, 1)) < n)
+        {
+            (*task)(i);
+        }
+    }
+
+    const ParallelTask* task;
+    int n;
+    int next;
+    // workers still allowed to join
+    int slots;
+    // workers that joined and have not left yet
+    int active;
+};
+
+static inline int atomic_load(int* addr)
+{
+    return NCNN_XADD(addr, 0);
+}
+
+static inline void wait_pause(int wait_policy)
+{
+    if (wait_policy == ThreadPool::WAIT_YIELD)
+    {
+#ifdef _WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+    else
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        _mm_pause();
+#endif
+    }
+}
+
+static int set_thread_affinity(int cpuid)
+{
+#if defined(_WIN32)
+    if (cpuid >= (int)sizeof(DWORD_PTR) * 8)
+        return -1;
+
+    DWORD_PTR mask = (DWORD_PTR)1 << cpuid;
+    return SetThreadAffinityMask(GetCurrentThread(), mask) ? 0 : -1;
+#elif defined(__linux__)
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpuid, &mask);
+
+    // pid 0 is the calling thread
+    return sched_setaffinity(0, sizeof(mask), &mask);
+#else
+    // thread affinity not supported on apple
+    (void)cpuid;
+    return -1;
+#endif
+}
+
+void* threadpool_worker(void* args)
+{
+    ThreadPool* pool = (ThreadPool*)args;
+
+    const int index = NCNN_XADD(&pool->worker_index, 1);
+    if (!pool->cpuids.empty())
+    {
+        int cpuid = pool->cpuids[index % pool->cpuids.size()];
+        if (set_thread_affinity(cpuid) != 0)
+        {
+            fprintf(stderr, "threadpool worker %d pin to cpu %d failed\n", index, cpuid);
+        }
+    }
+
+    pool->worker_loop();
+
+    return 0;
+}
+
+ThreadPool::ThreadPool(int num_workers, int _wait_policy, int _spin_count, const std::vector<int>& _cpuids)
+    : wait_policy(_wait_policy), spin_count(_spin_count), cpuids(_cpuids)
+{
+    worker_index = 0;
+    pending = 0;
+    stop = 0;
+
+    if (wait_policy == WAIT_BLOCK)
+        spin_count = 0;
+
+    workers.resize(num_workers > 0 ? num_workers : 0);
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i] = new Thread(threadpool_worker, (void*)this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    lock.lock();
+    stop = 1;
+    work_condition.broadcast();
+    lock.unlock();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+}
+
+int ThreadPool::get_num_workers() const
+{
+    return workers.size();
+}
+
+void ThreadPool::worker_loop()
+{
+    for (;;)
+    {
+        // poll a while so that back to back layers do not pay for a wakeup
+        for (int i = 0; i < spin_count; i++)
+        {
+            if (atomic_load(&pending) > 0 || atomic_load(&stop))
+                break;
+
+            wait_pause(wait_policy);
+        }
+
+        lock.lock();
+
+        while (jobs.empty() && !stop)
+        {
+            work_condition.wait(lock);
+        }
+
+        if (stop)
+        {
+            lock.unlock();
+            break;
+        }
+
+        ThreadPoolJob* job = jobs.front();
+        NCNN_XADD(&job->active, 1);
+        if (--job->slots == 0)
+        {
+            jobs.pop_front();
+            NCNN_XADD(&pending, -1);
+        }
+
+        lock.unlock();
+
+        job->work();
+
+        if (NCNN_XADD(&job->active, -1) == 1)
+        {
+            // the caller checks active under the lock before it sleeps
+            lock.lock();
+            finish_condition.broadcast();
+            lock.unlock();
+        }
+    }
+}
+
+void ThreadPool::run(int n, const ParallelTask& task, int num_threads)
+{
+    if (num_threads > n)
+        num_threads = n;
+
+    if (num_threads <= 1 || workers.empty())
+    {
+        for (int i = 0; i < n; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    ThreadPoolJob job;
+    job.task = &task;
+    job.n = n;
+    job.next = 0;
+    job.slots = std::min(num_threads - 1, (int)workers.size());
+    job.active = 0;
+
+    lock.lock();
+    jobs.push_back(&job);
+    NCNN_XADD(&pending, 1);
+    if (job.slots == 1)
+        work_condition.signal();
+    else
+        work_condition.broadcast();
+    lock.unlock();
+
+    job.work();
+
+    // no more joiners once the caller ran out of indexes
+    lock.lock();
+    if (job.slots > 0)
+    {
+        jobs.remove(&job);
+        NCNN_XADD(&pending, -1);
+        job.slots = 0;
+    }
+    lock.unlock();
+
+    for (int i = 0; i < spin_count; i++)
+    {
+        if (atomic_load(&job.active) == 0)
+            return;
+
+        wait_pause(wait_policy);
+    }
+
+    lock.lock();
+    while (atomic_load(&job.active) > 0)
+    {
+        finish_condition.wait(lock);
+    }
+    lock.unlock();
+}
+
+void parallel_for(const Option& opt, int n, const ParallelTask& task)
+{
+    if (opt.thread_pool)
+    {
+        opt.thread_pool->run(n, task, opt.num_threads);
+        return;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < n; i++)
+    {
+        task(i);
+    }
+}
+
+} // namespace ncnn
@@ -0,0 +1,88 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_THREADPOOL_H
+#define NCNN_THREADPOOL_H
+
+#include <list>
+#include <vector>
+#include "platform.h"
+
+namespace ncnn {
+
+class Option;
+
+// the body of a parallel loop, called once for every index
+class ParallelTask
+{
+public:
+    virtual ~ParallelTask();
+
+    virtual void operator()(int i) const = 0;
+};
+
+class ThreadPoolJob;
+class ThreadPool
+{
+public:
+    // how an idle thread waits for work before it blocks
+    enum WaitPolicy
+    {
+        WAIT_BLOCK = 0, // block on a condition variable at once
+        WAIT_SPIN = 1,  // busy poll spin_count rounds first
+        WAIT_YIELD = 2  // yield the core spin_count rounds first
+    };
+
+    // num_workers threads are created up front and live as long as the pool
+    // worker i is pinned to cpuids[i % cpuids.size()] when cpuids is not empty
+    ThreadPool(int num_workers, int wait_policy = WAIT_SPIN, int spin_count = 2000, const std::vector<int>& cpuids = std::vector<int>());
+    // no run may be in flight
+    ~ThreadPool();
+
+    int get_num_workers() const;
+
+    // call task(0) .. task(n - 1) on at most num_threads threads and return when all are done
+    // the calling thread takes part, so nested and concurrent runs from many threads are safe
+    // and a run always makes progress even when every worker is busy elsewhere
+    void run(int n, const ParallelTask& task, int num_threads);
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    friend void* threadpool_worker(void* args);
+    void worker_loop();
+
+    int wait_policy;
+    int spin_count;
+    std::vector<int> cpuids;
+
+    std::vector<Thread*> workers;
+    int worker_index;
+
+    Mutex lock;
+    ConditionVariable work_condition;
+    ConditionVariable finish_condition;
+    std::list<ThreadPoolJob*> jobs;
+    int pending;
+    int stop;
+};
+
+// call task(0) .. task(n - 1) with opt.num_threads threads
+// on opt.thread_pool when set, with openmp otherwise
+void parallel_for(const Option& opt, int n, const ParallelTask& task);
+
+} // namespace ncnn
+
+#endif // NCNN_THREADPOOL_H
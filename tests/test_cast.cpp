@@ -67,6 +67,19 @@ static int test_cast_2()
         ;
 }
 
+static int test_cast_3()
+{
+    ncnn::Mat a_bf16;
+    ncnn::cast_float32_to_bfloat16(RandomMat(6, 7, 16), a_bf16);
+
+    return 0
+        || test_cast(RandomMat(6, 7, 16), 1, 4)
+        || test_cast(RandomMat(3, 5, 13), 1, 4)
+        || test_cast(RandomMat(127), 1, 4)
+        || test_cast(a_bf16, 4, 1)
+        ;
+}
+
 int main()
 {
     SRAND(7767517);
@@ -75,5 +88,6 @@ int main()
         || test_cast_0()
         || test_cast_1()
         || test_cast_2()
+        || test_cast_3()
         ;
 }
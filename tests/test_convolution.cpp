@@ -14,7 +14,9 @@
 
 #include "testutil.h"
 
+#include "cpu.h"
 #include "layer/convolution.h"
+#include "threadpool.h"
 
 static int test_convolution(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias)
 {
@@ -38,6 +40,7 @@ static int test_convolution(int w, int h, int c, int outch, int kernel, int dila
     opt.num_threads = 1;
     opt.use_vulkan_compute = true;
     opt.use_int8_inference = false;
+    opt.use_packing_layout = true;
     opt.use_fp16_packed = false;
     opt.use_fp16_storage = false;
     opt.use_fp16_arithmetic = false;
@@ -93,6 +96,8 @@ static int test_convolution_0()
             || test_convolution(9, 7, 8, 8, kdsp[i][0], kdsp[i][1], kdsp[i][2], kdsp[i][3], 1)
             || test_convolution(9, 7, 15, 15, kdsp[i][0], kdsp[i][1], kdsp[i][2], kdsp[i][3], 1)
             || test_convolution(9, 7, 16, 16, kdsp[i][0], kdsp[i][1], kdsp[i][2], kdsp[i][3], 1)
+            || test_convolution(13, 11, 16, 24, kdsp[i][0], kdsp[i][1], kdsp[i][2], kdsp[i][3], 0)
+            || test_convolution(15, 12, 32, 48, kdsp[i][0], kdsp[i][1], kdsp[i][2], kdsp[i][3], 1)
             ;
 
         if (ret != 0)
@@ -102,6 +107,31 @@ static int test_convolution_0()
     return 0;
 }
 
+static int test_convolution_2()
+{
+    // larger feature maps pick winograd F(6,3) over the smaller tiles
+    return 0
+        || test_convolution(7, 6, 16, 24, 3, 1, 1, 1, 1)
+        || test_convolution(25, 23, 16, 24, 3, 1, 1, 1, 1)
+        || test_convolution(26, 24, 32, 48, 3, 1, 1, 1, 0)
+        || test_convolution(40, 38, 32, 16, 3, 1, 1, 1, 1)
+        ;
+}
+
+// the vnni sgemm matches the reference, the sse int8 fallback does not yet
+static bool int8_uses_vnni()
+{
+#if NCNN_AVX512VNNI
+    if (ncnn::cpu_support_x86_avx512() && ncnn::cpu_support_x86_avx512_vnni())
+        return true;
+#endif // NCNN_AVX512VNNI
+#if NCNN_AVXVNNI
+    if (!ncnn::cpu_support_x86_avx512() && ncnn::cpu_support_x86_avx2() && ncnn::cpu_support_x86_avx_vnni())
+        return true;
+#endif // NCNN_AVXVNNI
+    return false;
+}
+
 void set_param(ncnn::Convolution* layer)
 {
     layer->use_int8_requantize = true;
@@ -109,6 +139,226 @@ void set_param(ncnn::Convolution* layer)
     return;
 }
 
+// h == 0 feeds a flattened blob of c elements, as after a global pooling
+static int test_convolution_fp16w(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias)
+{
+    ncnn::Mat a = h == 0 ? RandomMat(c) : RandomMat(w, h, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, kernel);// kernel_w
+    pd.set(2, dilation);// dilation_w
+    pd.set(3, stride);// stride_w
+    pd.set(4, pad);// pad_w
+    pd.set(5, bias);// bias_term
+    pd.set(6, outch*c*kernel*kernel);
+
+    // weights exactly representable in fp16, as loaded from a fp16 model
+    ncnn::Mat weight_fp16;
+    ncnn::cast_float32_to_float16(RandomMat(outch*c*kernel*kernel), weight_fp16);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    ncnn::cast_float16_to_float32(weight_fp16, weights[0]);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_int8_storage = false;
+    opt.use_int8_arithmetic = false;
+    opt.use_weight_fp16_storage = true;
+
+    int ret = test_layer<ncnn::Convolution>("Convolution", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_fp16w failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias);
+    }
+
+    return ret;
+}
+
+static int test_convolution_3()
+{
+    return 0
+        || test_convolution_fp16w(9, 7, 3, 5, 1, 1, 1, 0, 1)
+        || test_convolution_fp16w(9, 7, 3, 5, 3, 1, 2, 1, 0)
+        || test_convolution_fp16w(13, 11, 16, 24, 3, 1, 1, 1, 1)
+        || test_convolution_fp16w(13, 11, 16, 24, 5, 2, 1, 2, 1)
+        || test_convolution_fp16w(15, 12, 32, 48, 1, 1, 1, 0, 1)
+        || test_convolution_fp16w(15, 12, 32, 48, 3, 1, 2, 1, 1)
+        || test_convolution_fp16w(25, 23, 16, 24, 3, 1, 1, 1, 1)
+        || test_convolution_fp16w(1, 0, 32, 16, 1, 1, 1, 0, 1)
+        || test_convolution_fp16w(1, 0, 27, 13, 1, 1, 1, 0, 0)
+        ;
+}
+
+// h == 0 feeds a flattened blob of c elements, as after a global pooling
+static int test_convolution_bf16(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias)
+{
+    // input and weights exactly representable in bf16
+    ncnn::Mat a;
+    {
+        ncnn::Mat a_bf16;
+        ncnn::cast_float32_to_bfloat16(h == 0 ? RandomMat(c) : RandomMat(w, h, c), a_bf16);
+        ncnn::cast_bfloat16_to_float32(a_bf16, a);
+    }
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, kernel);// kernel_w
+    pd.set(2, dilation);// dilation_w
+    pd.set(3, stride);// stride_w
+    pd.set(4, pad);// pad_w
+    pd.set(5, bias);// bias_term
+    pd.set(6, outch*c*kernel*kernel);
+
+    ncnn::Mat weight_bf16;
+    ncnn::cast_float32_to_bfloat16(RandomMat(outch*c*kernel*kernel), weight_bf16);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    ncnn::cast_bfloat16_to_float32(weight_bf16, weights[0]);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_int8_storage = false;
+    opt.use_int8_arithmetic = false;
+    opt.use_bf16_storage = true;
+
+    // the output is rounded to bf16
+    int ret = test_layer<ncnn::Convolution>("Convolution", pd, weights, opt, a, 0.01f);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_bf16 failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias);
+    }
+
+    return ret;
+}
+
+static int test_convolution_4()
+{
+    return 0
+        || test_convolution_bf16(9, 7, 3, 5, 1, 1, 1, 0, 1)
+        || test_convolution_bf16(9, 7, 3, 5, 3, 1, 2, 1, 0)
+        || test_convolution_bf16(9, 7, 4, 4, 3, 2, 1, -233, 1)
+        || test_convolution_bf16(13, 11, 16, 24, 3, 1, 1, 1, 1)
+        || test_convolution_bf16(13, 11, 16, 24, 5, 2, 1, 2, 1)
+        || test_convolution_bf16(15, 12, 32, 48, 1, 1, 1, 0, 1)
+        || test_convolution_bf16(15, 12, 32, 48, 3, 1, 2, -234, 1)
+        || test_convolution_bf16(25, 23, 16, 24, 3, 1, 1, 1, 1)
+        || test_convolution_bf16(1, 0, 32, 16, 1, 1, 1, 0, 1)
+        || test_convolution_bf16(1, 0, 27, 13, 1, 1, 1, 0, 0)
+        ;
+}
+
+static int test_convolution_batch(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias, int batch)
+{
+    std::vector<ncnn::Mat> a(batch);
+    for (int i=0; i<batch; i++)
+    {
+        a[i] = RandomMat(w, h, c);
+    }
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, kernel);// kernel_w
+    pd.set(2, dilation);// dilation_w
+    pd.set(3, stride);// stride_w
+    pd.set(4, pad);// pad_w
+    pd.set(5, bias);// bias_term
+    pd.set(6, outch*c*kernel*kernel);
+    pd.set(9, 1);// relu
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch*c*kernel*kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+
+    int ret = test_layer_batch<ncnn::Convolution>("Convolution", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_batch failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d batch=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias, batch);
+    }
+
+    return ret;
+}
+
+static int test_convolution_5()
+{
+    return 0
+        || test_convolution_batch(4, 3, 3, 16, 1, 1, 1, 0, 1, 3)
+        || test_convolution_batch(5, 4, 3, 24, 3, 1, 1, 1, 0, 2)
+        || test_convolution_batch(6, 5, 4, 32, 3, 2, 1, -233, 1, 4)
+        || test_convolution_batch(7, 6, 16, 48, 1, 1, 1, 0, 1, 3)
+        || test_convolution_batch(7, 6, 16, 64, 3, 1, 2, 1, 1, 3)
+        || test_convolution_batch(9, 8, 32, 64, 5, 2, 1, 2, 1, 2)
+        || test_convolution_batch(6, 6, 16, 48, 3, 1, 1, 1, 1, 3)
+        || test_convolution_batch(25, 23, 16, 24, 3, 1, 1, 1, 1, 3)
+        ;
+}
+
+static int test_convolution_threadpool(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias, int wait_policy)
+{
+    ncnn::Mat a = RandomMat(w, h, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, kernel);// kernel_w
+    pd.set(2, dilation);// dilation_w
+    pd.set(3, stride);// stride_w
+    pd.set(4, pad);// pad_w
+    pd.set(5, bias);// bias_term
+    pd.set(6, outch*c*kernel*kernel);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch*c*kernel*kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::ThreadPool thread_pool(3, wait_policy);
+
+    ncnn::Option opt;
+    opt.num_threads = 4;
+    opt.thread_pool = &thread_pool;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+    opt.use_packing_layout = true;
+
+    int ret = test_layer<ncnn::Convolution>("Convolution", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_threadpool failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d wait_policy=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias, wait_policy);
+    }
+
+    return ret;
+}
+
+static int test_convolution_6()
+{
+    return 0
+        || test_convolution_threadpool(9, 7, 3, 5, 3, 1, 2, 1, 1, ncnn::ThreadPool::WAIT_BLOCK)
+        || test_convolution_threadpool(13, 11, 16, 24, 1, 1, 1, 0, 1, ncnn::ThreadPool::WAIT_SPIN)
+        || test_convolution_threadpool(15, 12, 32, 48, 5, 2, 2, 2, 0, ncnn::ThreadPool::WAIT_YIELD)
+        || test_convolution_threadpool(40, 38, 16, 32, 3, 1, 2, 1, 1, ncnn::ThreadPool::WAIT_SPIN)
+        ;
+}
+
 static int test_convolution_int8(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias, bool requant = false)
 {
     ncnn::Mat a = RandomMat(w, h, c);
@@ -153,7 +403,7 @@ static int test_convolution_int8(int w, int h, int c, int outch, int kernel, int
         fprintf(stderr, "test_convolution_int8 failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d requant=%d\n", w, h, c, outch, kernel, dilation, stride, pad, bias, requant);
     }
 
-    return 0;
+    return int8_uses_vnni() ? ret : 0;
 }
 
 static int test_convolution_1()
@@ -225,5 +475,12 @@ int main()
 {
     SRAND(7767517);
 
-    return test_convolution_0() || test_convolution_1();
+    return 0
+        || test_convolution_0()
+        || test_convolution_1()
+        || test_convolution_2()
+        || test_convolution_3()
+        || test_convolution_4()
+        || test_convolution_5()
+        || test_convolution_6();
 }
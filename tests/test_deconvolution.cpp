@@ -100,9 +100,23 @@ static int test_deconvolution_0()
     return 0;
 }
 
+static int test_deconvolution_1()
+{
+    // wider inputs for the stride 2 upsampling kernels
+    return 0
+        || test_deconvolution(21, 11, 13, 6, 2, 1, 2, 0, 1)
+        || test_deconvolution(21, 11, 13, 6, 3, 1, 2, 1, 1)
+        || test_deconvolution(21, 11, 13, 6, 4, 1, 2, 1, 1)
+        || test_deconvolution(20, 12, 16, 24, 4, 1, 2, 1, 0)
+        ;
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_deconvolution_0();
+    return 0
+        || test_deconvolution_0()
+        || test_deconvolution_1()
+        ;
 }
@@ -63,6 +63,121 @@ static int test_innerproduct_0()
         ;
 }
 
+static int test_innerproduct_fp16w(int w, int h, int c, int outch, int bias)
+{
+    ncnn::Mat a = RandomMat(w, h, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, bias);// bias_term
+    pd.set(2, outch*w*h*c);
+
+    // weights exactly representable in fp16, as loaded from a fp16 model
+    ncnn::Mat weight_fp16;
+    ncnn::cast_float32_to_float16(RandomMat(outch*w*h*c), weight_fp16);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    ncnn::cast_float16_to_float32(weight_fp16, weights[0]);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_int8_storage = false;
+    opt.use_int8_arithmetic = false;
+    opt.use_weight_fp16_storage = true;
+
+    int ret = test_layer<ncnn::InnerProduct>("InnerProduct", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_fp16w failed w=%d h=%d c=%d outch=%d bias=%d\n", w, h, c, outch, bias);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_bf16(int w, int h, int c, int outch, int bias)
+{
+    // input and weights exactly representable in bf16
+    ncnn::Mat a;
+    {
+        ncnn::Mat a_bf16;
+        ncnn::cast_float32_to_bfloat16(RandomMat(w, h, c), a_bf16);
+        ncnn::cast_bfloat16_to_float32(a_bf16, a);
+    }
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, bias);// bias_term
+    pd.set(2, outch*w*h*c);
+
+    ncnn::Mat weight_bf16;
+    ncnn::cast_float32_to_bfloat16(RandomMat(outch*w*h*c), weight_bf16);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    ncnn::cast_bfloat16_to_float32(weight_bf16, weights[0]);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_int8_storage = false;
+    opt.use_int8_arithmetic = false;
+    opt.use_bf16_storage = true;
+
+    // the output is rounded to bf16
+    int ret = test_layer<ncnn::InnerProduct>("InnerProduct", pd, weights, opt, a, 0.01f);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_bf16 failed w=%d h=%d c=%d outch=%d bias=%d\n", w, h, c, outch, bias);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_batch(int w, int h, int c, int outch, int bias, int batch)
+{
+    std::vector<ncnn::Mat> a(batch);
+    for (int i=0; i<batch; i++)
+    {
+        a[i] = RandomMat(w, h, c);
+    }
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, bias);// bias_term
+    pd.set(2, outch*w*h*c);
+    pd.set(9, 1);// relu
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch*w*h*c);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+
+    int ret = test_layer_batch<ncnn::InnerProduct>("InnerProduct", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_batch failed w=%d h=%d c=%d outch=%d bias=%d batch=%d\n", w, h, c, outch, bias, batch);
+    }
+
+    return ret;
+}
+
 static int test_innerproduct_int8(int w, int h, int c, int outch, int bias)
 {
     ncnn::Mat a = RandomMat(w, h, c);
@@ -123,9 +238,87 @@ static int test_innerproduct_1()
         ;
 }
 
+static int test_innerproduct_gemm(int w, int h, int outch, int bias)
+{
+    ncnn::Mat a = RandomMat(w, h);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);// num_output
+    pd.set(1, bias);// bias_term
+    pd.set(2, outch*w);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch*w);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_vulkan_compute = false;
+    opt.use_int8_inference = false;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_int8_storage = false;
+    opt.use_int8_arithmetic = false;
+
+    int ret = test_layer<ncnn::InnerProduct>("InnerProduct", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_gemm failed w=%d h=%d outch=%d bias=%d\n", w, h, outch, bias);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_2()
+{
+    return 0
+        || test_innerproduct_gemm(1, 2, 1, 1)
+        || test_innerproduct_gemm(3, 3, 4, 0)
+        || test_innerproduct_gemm(7, 4, 7, 1)
+        || test_innerproduct_gemm(15, 5, 8, 1)
+        || test_innerproduct_gemm(16, 9, 15, 0)
+        || test_innerproduct_gemm(33, 13, 17, 1)
+        || test_innerproduct_gemm(300, 27, 40, 1)
+        ;
+}
+
+static int test_innerproduct_3()
+{
+    return 0
+        || test_innerproduct_fp16w(7, 3, 1, 1, 1)
+        || test_innerproduct_fp16w(7, 3, 3, 12, 0)
+        || test_innerproduct_fp16w(7, 3, 16, 17, 1)
+        || test_innerproduct_fp16w(31, 9, 4, 40, 1)
+        || test_innerproduct_fp16w(300, 1, 1, 33, 1)
+        ;
+}
+
+static int test_innerproduct_4()
+{
+    return 0
+        || test_innerproduct_bf16(7, 3, 1, 1, 1)
+        || test_innerproduct_bf16(7, 3, 3, 12, 0)
+        || test_innerproduct_bf16(7, 3, 16, 17, 1)
+        || test_innerproduct_bf16(31, 9, 4, 40, 1)
+        || test_innerproduct_bf16(300, 1, 1, 33, 1)
+        ;
+}
+
+static int test_innerproduct_5()
+{
+    return 0
+        || test_innerproduct_batch(7, 3, 1, 1, 1, 3)
+        || test_innerproduct_batch(7, 3, 3, 12, 0, 2)
+        || test_innerproduct_batch(7, 3, 16, 17, 1, 5)
+        || test_innerproduct_batch(300, 1, 1, 33, 1, 8)
+        ;
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_innerproduct_0() || test_innerproduct_1();
+    return test_innerproduct_0() || test_innerproduct_1() || test_innerproduct_2() || test_innerproduct_3() || test_innerproduct_4() || test_innerproduct_5();
 }
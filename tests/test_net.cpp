@@ -0,0 +1,542 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "testutil.h"
+
+#include <string.h>
+
+#include "datareader.h"
+#include "net.h"
+#include "threadpool.h"
+
+// random weights, every value handed out is kept in values
+class RandomDataReader : public ncnn::DataReader
+{
+public:
+    virtual size_t read(void* buf, size_t size) const
+    {
+        // the weight flag, 0 for raw fp32
+        if (size == 4)
+        {
+            memset(buf, 0, 4);
+            return size;
+        }
+
+        float* ptr = (float*)buf;
+        for (size_t i=0; i<size / 4; i++)
+        {
+            ptr[i] = RandomFloat(-1.f, 1.f);
+            values.push_back(ptr[i]);
+        }
+
+        return size;
+    }
+
+    mutable std::vector<float> values;
+};
+
+static int load_net(ncnn::Net& net, const char* param, const RandomDataReader& dr)
+{
+    net.opt.use_packing_layout = true;
+
+    int ret = net.load_param_mem(param);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load_param_mem failed\n");
+        return ret;
+    }
+
+    ret = net.load_model(dr);
+    if (ret != 0)
+    {
+        fprintf(stderr, "load_model failed\n");
+        return ret;
+    }
+
+    return 0;
+}
+
+// a source layer other than input feeds a binaryop
+static const char* memorydata_param =
+    "7767517\n"
+    "3 3\n"
+    "Input            data     0 1 data 0=4\n"
+    "MemoryData       md       0 1 md 0=4\n"
+    "BinaryOp         add      2 1 data md out 0=0\n";
+
+static int test_net_memorydata()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, memorydata_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(4);
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("data", in);
+
+    ncnn::Mat out;
+    int ret = ex.extract("out", out);
+    if (ret != 0 || out.w != 4)
+    {
+        fprintf(stderr, "test_net_memorydata extract failed %d\n", ret);
+        return -1;
+    }
+
+    ncnn::Mat ref(4);
+    for (int i=0; i<4; i++)
+    {
+        ref[i] = in[i] + dr.values[i];
+    }
+
+    if (CompareMat(out, ref, 0.001) != 0)
+    {
+        fprintf(stderr, "test_net_memorydata failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// three branches off one split joined by eltwise and concat
+static const char* branch_param =
+    "7767517\n"
+    "11 13\n"
+    "Input            data     0 1 data 0=12 1=12 2=16\n"
+    "Split            sp       1 3 data d0 d1 d2\n"
+    "Convolution      c0       1 1 d0 a0 0=16 1=1 5=1 6=256\n"
+    "ReLU             r0       1 1 a0 a0r\n"
+    "Convolution      c1       1 1 d1 a1 0=16 1=3 4=1 5=1 6=2304\n"
+    "Pooling          p1       1 1 a1 a1p 0=0 1=3 2=1 3=1\n"
+    "ConvolutionDepthWise c2   1 1 d2 a2 0=16 1=3 4=1 5=1 6=144 7=16\n"
+    "Sigmoid          s2       1 1 a2 a2s\n"
+    "Eltwise          e        2 1 a0r a1p e0 0=1\n"
+    "Concat           cat      2 1 e0 a2s cat0\n"
+    "Convolution      conv     1 1 cat0 output 0=8 1=1 5=1 6=256\n";
+
+// extract output from in, with the options of net
+static int extract_output(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out, bool lightmode)
+{
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_light_mode(lightmode);
+    ex.input("data", in);
+
+    return ex.extract("output", out);
+}
+
+static int test_net_lightmode()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, branch_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(12, 12, 16);
+
+    ncnn::Mat ref;
+    ncnn::Mat out;
+    if (extract_output(net, in, ref, false) != 0 || extract_output(net, in, out, true) != 0)
+    {
+        fprintf(stderr, "test_net_lightmode extract failed\n");
+        return -1;
+    }
+
+    // the intermediate blob is reached from the blobs already there
+    ncnn::Mat e0_ref;
+    ncnn::Mat e0;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_light_mode(false);
+        ex.input("data", in);
+        ncnn::Mat out2;
+        ex.extract("output", out2);
+        ex.extract("e0", e0);
+    }
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+        ex.extract("e0", e0_ref);
+    }
+
+    if (CompareMat(out, ref, 0.001) != 0 || CompareMat(e0, e0_ref, 0.001) != 0)
+    {
+        fprintf(stderr, "test_net_lightmode failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// counts the allocations that reach it
+class CountingAllocator : public ncnn::Allocator
+{
+public:
+    CountingAllocator() : count(0) {}
+
+    virtual void* fastMalloc(size_t size)
+    {
+        count++;
+        return ncnn::fastMalloc(size);
+    }
+
+    virtual void fastFree(void* ptr)
+    {
+        ncnn::fastFree(ptr);
+    }
+
+    int count;
+};
+
+static int test_net_memory_plan()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, branch_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(12, 12, 16);
+
+    ncnn::Mat ref;
+    if (extract_output(net, in, ref, true) != 0)
+        return -1;
+
+    std::vector<const char*> input_names(1, "data");
+    std::vector<const char*> output_names(1, "output");
+    std::vector<ncnn::Mat> inputs(1, in);
+    if (net.plan_memory(input_names, inputs, output_names) != 0 || net.planned_memory_size() == 0)
+    {
+        fprintf(stderr, "test_net_memory_plan plan_memory failed\n");
+        return -1;
+    }
+
+    // one extractor over two inferences, both follow the plan
+    CountingAllocator fallback;
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_light_mode(true);
+    ex.set_blob_allocator(&fallback);
+
+    int counts[2];
+    ncnn::Mat outs[2];
+    for (int i=0; i<2; i++)
+    {
+        ex.reset();
+        ex.input("data", in);
+
+        fallback.count = 0;
+        if (ex.extract("output", outs[i]) != 0)
+            return -1;
+
+        counts[i] = fallback.count;
+    }
+
+    if (CompareMat(outs[0], ref, 0.001) != 0 || CompareMat(outs[1], ref, 0.001) != 0 || counts[1] != counts[0])
+    {
+        fprintf(stderr, "test_net_memory_plan failed %d %d\n", counts[0], counts[1]);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_arena()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, branch_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(12, 12, 16);
+
+    ncnn::Mat ref;
+    ncnn::Mat e0_ref;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_light_mode(false);
+        ex.input("data", in);
+        if (ex.extract("output", ref) != 0 || ex.extract("e0", e0_ref) != 0)
+            return -1;
+    }
+
+    // one extractor over two inferences, the arena is rewound in between
+    ncnn::Mat outs[2];
+    ncnn::Mat e0;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_light_mode(false);
+        ex.set_arena_mode(true);
+
+        for (int i=0; i<2; i++)
+        {
+            ex.reset();
+            ex.input("data", in);
+            if (ex.extract("output", outs[i]) != 0)
+                return -1;
+        }
+
+        // the copy keeps its blobs when ex recycles the arena
+        ncnn::Extractor ex2 = net.create_extractor();
+        ex2 = ex;
+        ex.reset();
+
+        if (ex2.extract("e0", e0) != 0)
+            return -1;
+    }
+
+    if (CompareMat(outs[0], ref, 0.001) != 0 || CompareMat(outs[1], ref, 0.001) != 0 || CompareMat(e0, e0_ref, 0.001) != 0)
+    {
+        fprintf(stderr, "test_net_arena failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// inplace layers straight on the split tops, they have to work on copies
+static const char* branch_inplace_param =
+    "7767517\n"
+    "6 8\n"
+    "Input            data     0 1 data 0=12 1=12 2=16\n"
+    "Split            sp       1 3 data d0 d1 d2\n"
+    "ReLU             r0       1 1 d0 a0 0=0.1\n"
+    "Convolution      c1       1 1 d1 a1 0=16 1=3 4=1 5=1 6=2304\n"
+    "Sigmoid          s2       1 1 d2 a2\n"
+    "Eltwise          e        3 1 a0 a1 a2 output 0=1\n";
+
+static int test_net_branch_parallel(ncnn::ThreadPool* thread_pool)
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, branch_inplace_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(12, 12, 16);
+    ncnn::Mat in_copy = in.clone();
+
+    ncnn::Mat ref;
+    if (extract_output(net, in, ref, false) != 0)
+        return -1;
+
+    net.opt.use_branch_parallel = true;
+    net.opt.num_threads = 4;
+    net.opt.thread_pool = thread_pool;
+
+    // one extractor over two inferences, the branches run on the same workers both times
+    ncnn::Mat outs[2];
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_light_mode(true);
+
+        for (int i=0; i<2; i++)
+        {
+            ex.reset();
+            ex.input("data", in);
+            if (ex.extract("output", outs[i]) != 0)
+                return -1;
+        }
+    }
+
+    net.opt.use_branch_parallel = false;
+    net.opt.thread_pool = 0;
+
+    if (CompareMat(outs[0], ref, 0.001) != 0 || CompareMat(outs[1], ref, 0.001) != 0 || CompareMat(in, in_copy, 0.001) != 0)
+    {
+        fprintf(stderr, "test_net_branch_parallel failed thread_pool=%d\n", thread_pool ? 1 : 0);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_branch_parallel()
+{
+    ncnn::ThreadPool thread_pool(3);
+
+    return 0
+        || test_net_branch_parallel(0)
+        || test_net_branch_parallel(&thread_pool)
+        ;
+}
+
+static int test_net_batch()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, branch_param, dr) != 0)
+        return -1;
+
+    std::vector<ncnn::Mat> in(3);
+    std::vector<ncnn::Mat> ref(3);
+    for (int i=0; i<3; i++)
+    {
+        in[i] = RandomMat(12, 12, 16);
+        if (extract_output(net, in[i], ref[i], false) != 0)
+            return -1;
+    }
+
+    // one extractor over two batched inferences, the convolutions run the batch in one pass
+    std::vector<ncnn::Mat> outs[2];
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_light_mode(true);
+
+        for (int i=0; i<2; i++)
+        {
+            ex.reset();
+            ex.input("data", in);
+            if (ex.extract("output", outs[i]) != 0)
+                return -1;
+        }
+    }
+
+    for (int i=0; i<2; i++)
+    {
+        if (outs[i].size() != ref.size())
+        {
+            fprintf(stderr, "test_net_batch item count %d != %d\n", (int)outs[i].size(), (int)ref.size());
+            return -1;
+        }
+
+        for (size_t j=0; j<ref.size(); j++)
+        {
+            if (CompareMat(outs[i][j], ref[j], 0.001) != 0)
+            {
+                fprintf(stderr, "test_net_batch failed at item %d\n", (int)j);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// extract output in light mode under memory_budget, with the blob memory statistics
+static int extract_budget(ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out, size_t memory_budget, std::vector<ncnn::LayerMemoryStatistics>& stats)
+{
+    net.opt.memory_budget = memory_budget;
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_light_mode(true);
+    ex.set_memory_statistics(true);
+    ex.input("data", in);
+
+    int ret = ex.extract("output", out);
+
+    stats = ex.layer_memory_statistics();
+
+    net.opt.memory_budget = 0;
+
+    return ret;
+}
+
+// c1 and cb are ready together, c1 frees nothing and cb frees the wide slice p1
+static const char* budget_reorder_param =
+    "7767517\n"
+    "8 10\n"
+    "Input            data     0 1 data 0=12 1=12 2=16\n"
+    "Split            sp       1 2 data d0 d1\n"
+    "Convolution      cx       1 1 d0 x 0=128 1=1 5=1 6=2048\n"
+    "Slice            sl       1 2 x p0 p1 -23300=2,64,64\n"
+    "Convolution      ca       1 1 p0 a 0=16 1=1 5=1 6=1024\n"
+    "Convolution      c1       1 1 d1 t 0=16 1=3 4=1 5=1 6=2304\n"
+    "Convolution      cb       1 1 p1 b 0=16 1=1 5=1 6=1024\n"
+    "Concat           cat      4 1 a t b d1 output\n";
+
+static int test_net_budget_reorder()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, budget_reorder_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(12, 12, 16);
+
+    ncnn::Mat ref;
+    ncnn::Mat out;
+    std::vector<ncnn::LayerMemoryStatistics> ref_stats;
+    std::vector<ncnn::LayerMemoryStatistics> stats;
+    if (extract_budget(net, in, ref, 0, ref_stats) != 0 || extract_budget(net, in, out, 1, stats) != 0)
+    {
+        fprintf(stderr, "test_net_budget_reorder extract failed\n");
+        return -1;
+    }
+
+    // cb runs before c1, so p1 is gone when c1 runs
+    const int c1 = 5;
+    if (CompareMat(out, ref, 0.001) != 0 || stats[c1].live_bytes >= ref_stats[c1].live_bytes)
+    {
+        fprintf(stderr, "test_net_budget_reorder failed %d %d\n", (int)stats[c1].live_bytes, (int)ref_stats[c1].live_bytes);
+        return -1;
+    }
+
+    return 0;
+}
+
+// a0 waits for the c1 c2 chain and is cheap to rebuild from the split
+static const char* budget_recompute_param =
+    "7767517\n"
+    "8 9\n"
+    "Input            data     0 1 data 0=12 1=12 2=16\n"
+    "Split            sp       1 2 data d0 d1\n"
+    "Convolution      c0       1 1 d0 a0 0=64 1=1 5=1 6=1024\n"
+    "Convolution      c1       1 1 d1 b1 0=16 1=3 4=1 5=1 6=2304\n"
+    "ReLU             r1       1 1 b1 b1r\n"
+    "Convolution      c2       1 1 b1r b2 0=16 1=3 4=1 5=1 6=2304\n"
+    "Concat           cat      2 1 a0 b2 cat0\n"
+    "Convolution      conv     1 1 cat0 output 0=8 1=1 5=1 6=640\n";
+
+static int test_net_budget_recompute()
+{
+    ncnn::Net net;
+    RandomDataReader dr;
+    if (load_net(net, budget_recompute_param, dr) != 0)
+        return -1;
+
+    ncnn::Mat in = RandomMat(12, 12, 16);
+
+    ncnn::Mat ref;
+    ncnn::Mat out;
+    std::vector<ncnn::LayerMemoryStatistics> ref_stats;
+    std::vector<ncnn::LayerMemoryStatistics> stats;
+    if (extract_budget(net, in, ref, 0, ref_stats) != 0 || extract_budget(net, in, out, 1, stats) != 0)
+    {
+        fprintf(stderr, "test_net_budget_recompute extract failed\n");
+        return -1;
+    }
+
+    // a0 is dropped over the chain and rebuilt for cat
+    const int c2 = 5;
+    if (CompareMat(out, ref, 0.001) != 0 || stats[c2].live_bytes >= ref_stats[c2].live_bytes)
+    {
+        fprintf(stderr, "test_net_budget_recompute failed %d %d\n", (int)stats[c2].live_bytes, (int)ref_stats[c2].live_bytes);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+        || test_net_memorydata()
+        || test_net_lightmode()
+        || test_net_memory_plan()
+        || test_net_arena()
+        || test_net_branch_parallel()
+        || test_net_batch()
+        || test_net_budget_reorder()
+        || test_net_budget_recompute();
+}
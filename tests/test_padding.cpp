@@ -42,6 +42,7 @@ static int test_padding(int w, int h, int c, int top, int bottom, int left, int
     opt.use_fp16_arithmetic = false;
     opt.use_int8_storage = false;
     opt.use_int8_arithmetic = false;
+    opt.use_packing_layout = true;
 
     int ret = test_layer<ncnn::Padding>("Padding", pd, weights, opt, a);
     if (ret != 0)
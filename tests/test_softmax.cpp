@@ -99,6 +99,27 @@ static int test_softmax_5()
     return test_softmax(a, 0);
 }
 
+static int test_softmax_6()
+{
+    ncnn::Mat a = RandomMat(71, 5, 9);
+
+    return 0
+        || test_softmax(a, 0)
+        || test_softmax(a, 1)
+        || test_softmax(a, 2)
+        ;
+}
+
+static int test_softmax_7()
+{
+    ncnn::Mat a = RandomMat(133, 11);
+
+    return 0
+        || test_softmax(a, 0)
+        || test_softmax(a, 1)
+        ;
+}
+
 int main()
 {
     SRAND(7767517);
@@ -110,5 +131,7 @@ int main()
         || test_softmax_3()
         || test_softmax_4()
         || test_softmax_5()
+        || test_softmax_6()
+        || test_softmax_7()
         ;
 }
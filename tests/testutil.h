@@ -24,6 +24,7 @@
 
 #include "mat.h"
 #include "layer.h"
+#include "threadpool.h"
 
 #if NCNN_VULKAN
 #include "gpu.h"
@@ -198,6 +199,42 @@ static int CompareMat(const std::vector<ncnn::Mat>& a, const std::vector<ncnn::M
     return 0;
 }
 
+// same pack selection as Net::forward_layer
+static int PreferredElempack(const ncnn::Layer* op, const ncnn::Mat& m)
+{
+    int elemcount = m.c * m.elempack;
+    if (m.dims == 1) elemcount = m.w * m.elempack;
+    if (m.dims == 2) elemcount = m.h * m.elempack;
+
+    int elempack = op->preferred_elempack;
+    while (elempack > 1 && elemcount % elempack != 0)
+        elempack /= 2;
+
+    return elempack >= 4 ? elempack : 1;
+}
+
+// the reference output comes from a plain T instance, optimized pipelines may drop the raw weights
+template <typename T>
+static T* CreateReferenceLayer(const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& opt, void (*func)(T*))
+{
+    T* op = new T;
+
+    if (func)
+    {
+        (*func)(op);
+    }
+
+    op->load_param(pd);
+
+    ncnn::ModelBinFromMatArray mb(weights.data());
+
+    op->load_model(mb);
+
+    op->create_pipeline(opt);
+
+    return op;
+}
+
 template <typename T>
 int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& _opt, const std::vector<ncnn::Mat>& a, int top_blob_count, const std::vector<ncnn::Mat>& top_shapes = std::vector<ncnn::Mat>(), float epsilon = 0.001, void (*func)(T*) = 0)
 {
@@ -266,18 +303,26 @@ int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn:
 #endif // NCNN_VULKAN
 
     std::vector<ncnn::Mat> b(top_blob_count);
-    if (op->support_inplace)
     {
-        for (size_t i=0; i<a.size(); i++)
+        T* op_ref = CreateReferenceLayer<T>(pd, weights, opt, func);
+
+        if (op_ref->support_inplace)
         {
-            b[i] = a[i].clone();
+            for (size_t i=0; i<a.size(); i++)
+            {
+                b[i] = a[i].clone();
+            }
+
+            op_ref->T::forward_inplace(b, opt);
+        }
+        else
+        {
+            op_ref->T::forward(a, b, opt);
         }
 
-        ((T*)op)->T::forward_inplace(b, opt);
-    }
-    else
-    {
-        ((T*)op)->T::forward(a, b, opt);
+        op_ref->destroy_pipeline(opt);
+
+        delete op_ref;
     }
 
     std::vector<ncnn::Mat> c(top_blob_count);
@@ -287,7 +332,7 @@ int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn:
         {
             for (size_t i=0; i<a.size(); i++)
             {
-                ncnn::convert_packing(a[i], a4[i], 4, opt);
+                ncnn::convert_packing(a[i], a4[i], PreferredElempack(op, a[i]), opt);
             }
         }
         else
@@ -484,14 +529,22 @@ int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn:
 #endif // NCNN_VULKAN
 
     ncnn::Mat b;
-    if (op->support_inplace)
-    {
-        b = a.clone();
-        ((T*)op)->T::forward_inplace(b, opt);
-    }
-    else
     {
-        ((T*)op)->T::forward(a, b, opt);
+        T* op_ref = CreateReferenceLayer<T>(pd, weights, opt, func);
+
+        if (op_ref->support_inplace)
+        {
+            b = a.clone();
+            op_ref->T::forward_inplace(b, opt);
+        }
+        else
+        {
+            op_ref->T::forward(a, b, opt);
+        }
+
+        op_ref->destroy_pipeline(opt);
+
+        delete op_ref;
     }
 
     ncnn::Mat c;
@@ -499,13 +552,20 @@ int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn:
         ncnn::Mat a4;
         if (opt.use_packing_layout)
         {
-            ncnn::convert_packing(a, a4, 4, opt);
+            ncnn::convert_packing(a, a4, PreferredElempack(op, a), opt);
         }
         else
         {
             a4 = a;
         }
 
+        if (opt.use_bf16_storage && op->support_bf16_storage)
+        {
+            ncnn::Mat a4_bf16;
+            ncnn::cast_float32_to_bfloat16(a4, a4_bf16, opt);
+            a4 = a4_bf16;
+        }
+
         if (op->support_inplace)
         {
             c = a4.clone();
@@ -515,6 +575,13 @@ int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn:
         {
             op->forward(a4, c, opt);
         }
+
+        if (opt.use_bf16_storage && c.elemsize == 2u * c.elempack)
+        {
+            ncnn::Mat c_fp32;
+            ncnn::cast_bfloat16_to_float32(c, c_fp32, opt);
+            c = c_fp32;
+        }
     }
 
 #if NCNN_VULKAN
@@ -608,16 +675,30 @@ int test_layer(int typeindex, const ncnn::ParamDict& pd, const std::vector<ncnn:
     return 0;
 }
 
+// shared by the layer tests that run without a thread pool of their own
+static ncnn::ThreadPool& test_thread_pool()
+{
+    static ncnn::ThreadPool thread_pool(2, ncnn::ThreadPool::WAIT_BLOCK);
+    return thread_pool;
+}
+
 template <typename T>
 int test_layer(const char* layer_type, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& _opt, const std::vector<ncnn::Mat>& a, int top_blob_count = 1, float epsilon = 0.001, void (*func)(T*) = 0)
 {
-    ncnn::Option opts[2];
+    ncnn::Option opts[3];
     opts[0] = _opt;
     opts[0].use_packing_layout = false;
     opts[1] = _opt;
     opts[1].use_packing_layout = true;
+    opts[2] = _opt;
+    opts[2].use_packing_layout = true;
+    opts[2].num_threads = 3;
+    opts[2].thread_pool = &test_thread_pool();
 
-    for (int i = 0; i < 2; i++)
+    // the loops of the layer once more through a thread pool
+    const int opt_count = _opt.thread_pool ? 2 : 3;
+
+    for (int i = 0; i < opt_count; i++)
     {
         const ncnn::Option& opt = opts[i];
 
@@ -625,7 +706,7 @@ int test_layer(const char* layer_type, const ncnn::ParamDict& pd, const std::vec
         int ret = test_layer<T>(ncnn::layer_to_index(layer_type), pd, weights, opt, a, top_blob_count, top_shapes, epsilon, func);
         if (ret != 0)
         {
-            fprintf(stderr, "test_layer %s failed use_packing_layout=%d\n", layer_type, opt.use_packing_layout);
+            fprintf(stderr, "test_layer %s failed use_packing_layout=%d thread_pool=%d\n", layer_type, opt.use_packing_layout, opt.thread_pool ? 1 : 0);
             return ret;
         }
     }
@@ -636,13 +717,20 @@ int test_layer(const char* layer_type, const ncnn::ParamDict& pd, const std::vec
 template <typename T>
 int test_layer(const char* layer_type, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& _opt, const ncnn::Mat& a, float epsilon = 0.001, void (*func)(T*) = 0)
 {
-    ncnn::Option opts[2];
+    ncnn::Option opts[3];
     opts[0] = _opt;
     opts[0].use_packing_layout = false;
     opts[1] = _opt;
     opts[1].use_packing_layout = true;
+    opts[2] = _opt;
+    opts[2].use_packing_layout = true;
+    opts[2].num_threads = 3;
+    opts[2].thread_pool = &test_thread_pool();
 
-    for (int i = 0; i < 2; i++)
+    // the loops of the layer once more through a thread pool
+    const int opt_count = _opt.thread_pool ? 2 : 3;
+
+    for (int i = 0; i < opt_count; i++)
     {
         const ncnn::Option& opt = opts[i];
 
@@ -650,7 +738,7 @@ int test_layer(const char* layer_type, const ncnn::ParamDict& pd, const std::vec
         int ret = test_layer<T>(ncnn::layer_to_index(layer_type), pd, weights, opt, a, top_shape, epsilon, func);
         if (ret != 0)
         {
-            fprintf(stderr, "test_layer %s failed use_packing_layout=%d\n", layer_type, opt.use_packing_layout);
+            fprintf(stderr, "test_layer %s failed use_packing_layout=%d thread_pool=%d\n", layer_type, opt.use_packing_layout, opt.thread_pool ? 1 : 0);
             return ret;
         }
     }
@@ -658,4 +746,68 @@ int test_layer(const char* layer_type, const ncnn::ParamDict& pd, const std::vec
     return 0;
 }
 
+// forward_batch of the optimized layer against the reference layer run item by item
+template <typename T>
+int test_layer_batch(const char* layer_type, const ncnn::ParamDict& pd, const std::vector<ncnn::Mat>& weights, const ncnn::Option& _opt, const std::vector<ncnn::Mat>& a, float epsilon = 0.001)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        ncnn::Layer* op = ncnn::create_layer(layer_type);
+        ncnn::Option opt = _opt;
+        opt.use_packing_layout = i == 1 && op->support_packing;
+
+        op->load_param(pd);
+
+        ncnn::ModelBinFromMatArray mb(weights.data());
+
+        op->load_model(mb);
+
+        op->create_pipeline(opt);
+
+        std::vector<ncnn::Mat> b(a.size());
+        {
+            T* op_ref = CreateReferenceLayer<T>(pd, weights, opt, 0);
+
+            for (size_t j = 0; j < a.size(); j++)
+            {
+                op_ref->T::forward(a[j], b[j], opt);
+            }
+
+            op_ref->destroy_pipeline(opt);
+
+            delete op_ref;
+        }
+
+        std::vector<ncnn::Mat> c;
+        {
+            std::vector<ncnn::Mat> a4(a.size());
+            for (size_t j = 0; j < a.size(); j++)
+            {
+                if (opt.use_packing_layout)
+                {
+                    ncnn::convert_packing(a[j], a4[j], PreferredElempack(op, a[j]), opt);
+                }
+                else
+                {
+                    a4[j] = a[j];
+                }
+            }
+
+            op->forward_batch(a4, c, opt);
+        }
+
+        op->destroy_pipeline(opt);
+
+        delete op;
+
+        if (CompareMat(b, c, epsilon) != 0)
+        {
+            fprintf(stderr, "test_layer_batch %s failed use_packing_layout=%d\n", layer_type, opt.use_packing_layout);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 #endif // TESTUTIL_H